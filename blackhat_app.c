@@ -22,16 +22,59 @@ static void blackhat_app_tick_event_callback(void* context)
 {
     furi_assert(context);
     BlackhatApp* app = context;
+    blackhat_profile_sample(app->profile, blackhat_scene_get_current());
     scene_manager_handle_tick_event(app->scene_manager);
 }
 
+// Runs on the baud negotiation thread once the link speed is settled
+static void blackhat_app_link_ready_callback(bool alive, void* context)
+{
+    BlackhatApp* app = context;
+    if (alive) {
+        blackhat_rpc_negotiate(app->rpc);
+        app->link_ready = true;
+        view_dispatcher_send_custom_event(
+            app->view_dispatcher, BlackhatEventLinkReady
+        );
+    }
+}
+
+void blackhat_app_relink(BlackhatApp* app)
+{
+    app->link_ready = false;
+    blackhat_rpc_reset(app->rpc);
+    blackhat_baud_stop(app->baud);
+
+    // The device boots at the default rate whatever was negotiated before
+    blackhat_uart_set_baud(app->uart, BLACKHAT_UART_BAUD);
+    app->baud = blackhat_baud_start(
+        app->uart, blackhat_app_link_ready_callback, app
+    );
+}
+
+// Runs on the UART worker for every console byte
+static void blackhat_app_rx_tap_callback(
+    const uint8_t* buf, size_t len, void* context
+)
+{
+    BlackhatApp* app = context;
+    blackhat_log_write(app->log, buf, len);
+}
+
 BlackhatApp* blackhat_app_alloc()
 {
     BlackhatApp* app = malloc(sizeof(BlackhatApp));
 
-    app->dialogs = furi_record_open(RECORD_DIALOGS);
+    // First, so the heap the app takes for itself shows up as used
+    app->profile = blackhat_profile_alloc();
+    blackhat_profile_watch(
+        app->profile,
+        "App",
+        furi_thread_get_current_id(),
+        BLACKHAT_APP_STACK_SIZE
+    );
 
-    memset(app->cmd, 0x00, sizeof(app->cmd));
+    app->dialogs = furi_record_open(RECORD_DIALOGS);
 
     app->gui = furi_record_open(RECORD_GUI);
 
@@ -77,6 +120,21 @@ BlackhatApp* blackhat_app_alloc()
         text_input_get_view(app->text_input)
     );
 
+    app->loading = loading_alloc();
+    view_dispatcher_add_view(
+        app->view_dispatcher,
+        BlackhatAppViewLoading,
+        loading_get_view(app->loading)
+    );
+
+    app->log = blackhat_log_alloc();
+    app->bench = NULL;
+
+    app->response = blackhat_response_alloc(
+        app->view_dispatcher, BlackhatEventResponseDone
+    );
+    app->cache = blackhat_cache_alloc();
+
     app->tui_view = view_alloc();
     view_allocate_model(
         app->tui_view, ViewModelTypeLockFree, sizeof(bool)
@@ -84,8 +142,53 @@ BlackhatApp* blackhat_app_alloc()
     view_dispatcher_add_view(
         app->view_dispatcher, BlackhatAppViewTui, app->tui_view
     );
+    app->mirror = blackhat_mirror_alloc();
+    app->tui_mirror = false;
+    view_dispatcher_add_view(
+        app->view_dispatcher,
+        BlackhatAppViewMirror,
+        blackhat_mirror_get_view(app->mirror)
+    );
+    app->tui_a_hold =
+        blackhat_deadline_alloc(app->view_dispatcher, BlackhatEventTuiAHold);
+    app->tui_back_hold = blackhat_deadline_alloc(
+        app->view_dispatcher, BlackhatEventTuiBackHold
+    );
+
+    app->diag_view = view_alloc();
+    view_allocate_model(
+        app->diag_view, ViewModelTypeLocking, sizeof(BlackhatDiagModel)
+    );
+    view_dispatcher_add_view(
+        app->view_dispatcher, BlackhatAppViewDiagnostics, app->diag_view
+    );
+
+    app->telemetry = blackhat_telemetry_alloc();
+    app->dash_view = view_alloc();
+    view_allocate_model(
+        app->dash_view, ViewModelTypeLocking, sizeof(BlackhatDashModel)
+    );
+    view_dispatcher_add_view(
+        app->view_dispatcher, BlackhatAppViewDashboard, app->dash_view
+    );
+
+    app->profile_view = view_alloc();
+    view_allocate_model(
+        app->profile_view, ViewModelTypeLocking, sizeof(BlackhatProfileModel)
+    );
+    view_dispatcher_add_view(
+        app->view_dispatcher, BlackhatAppViewProfile, app->profile_view
+    );
+
+    app->xfer_view = view_alloc();
+    view_allocate_model(
+        app->xfer_view, ViewModelTypeLocking, sizeof(BlackhatXferModel)
+    );
+    view_dispatcher_add_view(
+        app->view_dispatcher, BlackhatAppViewXfer, app->xfer_view
+    );
 
-    for (int i = 0; i < NUM_MENU_ITEMS; ++i) {
+    for (int i = 0; i < BLACKHAT_MENU_MAX_ITEMS; ++i) {
         app->selected_option_index[i] = 0;
     }
 
@@ -97,11 +200,32 @@ BlackhatApp* blackhat_app_alloc()
         text_box_get_view(app->text_box)
     );
 
-    app->script_text = malloc(BLACKHAT_TEXT_BOX_STORE_SIZE);
-    app->script_text_ptr = 0;
+    blackhat_line_list_init(&app->script_list);
+    blackhat_line_list_init(&app->param_lines);
+    blackhat_line_list_init(&app->script_update);
+    blackhat_line_list_init(&app->schema);
+    blackhat_line_list_init(&app->schema_update);
+    app->rx_lines = NULL;
+
+    // Last known scripts and params, so menus work before the device is up
+    app->params.num_params = 0;
+    app->scripts_validated = false;
+    app->scanned = blackhat_store_load(
+        &app->script_list, &app->params, &app->schema
+    );
+    app->schema_validated = false;
+    app->link_ready = false;
+    blackhat_menu_init(&app->menu);
+    blackhat_menu_build(&app->menu, &app->schema);
 
-    app->text_box_store = furi_string_alloc();
-    furi_string_reserve(app->text_box_store, BLACKHAT_TEXT_BOX_STORE_SIZE);
+    app->term = blackhat_term_alloc(BLACKHAT_TERM_COLS, BLACKHAT_TERM_ROWS);
+    view_dispatcher_add_view(
+        app->view_dispatcher,
+        BlackhatAppViewTerminal,
+        blackhat_term_get_view(app->term)
+    );
+    app->console_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    app->console_frame_ms = BLACKHAT_CONSOLE_FRAME_MS;
 
     scene_manager_next_scene(app->scene_manager, BlackhatSceneStart);
 
@@ -112,10 +236,12 @@ void blackhat_app_free(BlackhatApp* app)
 {
     furi_assert(app);
 
-    for(int i = 0 ; i < app->num_scripts ; i++) {
-        if(app->cmd[i])
-            free(app->cmd[i]);
-    }
+    blackhat_line_list_free(&app->script_list);
+    blackhat_line_list_free(&app->param_lines);
+    blackhat_line_list_free(&app->script_update);
+    blackhat_line_list_free(&app->schema);
+    blackhat_line_list_free(&app->schema_update);
+    blackhat_menu_free(&app->menu);
 
     // Views
     view_dispatcher_remove_view(
@@ -131,20 +257,54 @@ void blackhat_app_free(BlackhatApp* app)
 
     view_dispatcher_remove_view(app->view_dispatcher, BlackhatAppViewTextInput);
     text_input_free(app->text_input);
+    view_dispatcher_remove_view(app->view_dispatcher, BlackhatAppViewLoading);
+    loading_free(app->loading);
+    blackhat_response_free(app->response);
+    blackhat_cache_free(app->cache);
     view_dispatcher_remove_view(app->view_dispatcher, BlackhatAppViewTui);
+    blackhat_deadline_free(app->tui_a_hold);
+    blackhat_deadline_free(app->tui_back_hold);
     view_free_model(app->tui_view);
     view_free(app->tui_view);
+    view_dispatcher_remove_view(app->view_dispatcher, BlackhatAppViewMirror);
+    blackhat_mirror_free(app->mirror);
+    view_dispatcher_remove_view(
+        app->view_dispatcher, BlackhatAppViewFramebuffer
+    );
+    blackhat_fb_free(app->fb);
+    view_dispatcher_remove_view(
+        app->view_dispatcher, BlackhatAppViewDiagnostics
+    );
+    view_free_model(app->diag_view);
+    view_free(app->diag_view);
+    view_dispatcher_remove_view(app->view_dispatcher, BlackhatAppViewDashboard);
+    view_free_model(app->dash_view);
+    view_free(app->dash_view);
+    blackhat_telemetry_free(app->telemetry);
+    view_dispatcher_remove_view(app->view_dispatcher, BlackhatAppViewProfile);
+    view_free_model(app->profile_view);
+    view_free(app->profile_view);
+    view_dispatcher_remove_view(app->view_dispatcher, BlackhatAppViewXfer);
+    view_free_model(app->xfer_view);
+    view_free(app->xfer_view);
+    blackhat_xfer_free(app->xfer);
     view_dispatcher_remove_view(
         app->view_dispatcher, BlackhatAppViewConsoleOutput
     );
     text_box_free(app->text_box);
-    furi_string_free(app->text_box_store);
+    view_dispatcher_remove_view(app->view_dispatcher, BlackhatAppViewTerminal);
+    blackhat_term_free(app->term);
+    furi_mutex_free(app->console_mutex);
 
     // View dispatcher
     view_dispatcher_free(app->view_dispatcher);
     scene_manager_free(app->scene_manager);
 
+    blackhat_baud_stop(app->baud);
+    blackhat_rpc_free(app->rpc);
     blackhat_uart_free(app->uart);
+    blackhat_log_free(app->log);
+    blackhat_profile_free(app->profile);
 
     // Close records
     furi_record_close(RECORD_GUI);
@@ -163,7 +323,6 @@ int32_t blackhat_app(void* p)
     expansion_disable(expansion);
 
     BlackhatApp* blackhat_app = blackhat_app_alloc();
-    blackhat_app->scanned = false;
 
     bool otg_was_enabled = furi_hal_power_is_otg_enabled();
     // turn off 5v, so it gets reset on startup
@@ -178,6 +337,34 @@ int32_t blackhat_app(void* p)
     furi_delay_ms(200);
 
     blackhat_app->uart = blackhat_uart_init(blackhat_app);
+    blackhat_app->rpc = blackhat_rpc_alloc(blackhat_app->uart);
+    blackhat_profile_watch(
+        blackhat_app->profile,
+        "UART RX",
+        blackhat_uart_get_rx_thread_id(blackhat_app->uart),
+        BLACKHAT_UART_STACK_SIZE
+    );
+    blackhat_profile_watch(
+        blackhat_app->profile,
+        "UART TX",
+        blackhat_uart_get_tx_thread_id(blackhat_app->uart),
+        BLACKHAT_UART_STACK_SIZE
+    );
+    blackhat_app->fb =
+        blackhat_fb_alloc(blackhat_app->rpc, blackhat_app->uart);
+    blackhat_app->xfer =
+        blackhat_xfer_alloc(blackhat_app->rpc, blackhat_app->uart);
+    view_dispatcher_add_view(
+        blackhat_app->view_dispatcher,
+        BlackhatAppViewFramebuffer,
+        blackhat_fb_get_view(blackhat_app->fb)
+    );
+    blackhat_uart_set_rx_tap(
+        blackhat_app->uart, blackhat_app_rx_tap_callback, blackhat_app
+    );
+    blackhat_app->baud = blackhat_baud_start(
+        blackhat_app->uart, blackhat_app_link_ready_callback, blackhat_app
+    );
     view_dispatcher_run(blackhat_app->view_dispatcher);
     blackhat_app_free(blackhat_app);
 
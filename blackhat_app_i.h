@@ -16,16 +16,37 @@
 #include <notification/notification.h>
 #include <notification/notification_messages.h>
 #include <stdio.h>
+#include <storage/storage.h>
 
 #include "blackhat_app.h"
+#include "blackhat_baud.h"
+#include "blackhat_bench.h"
+#include "blackhat_cache.h"
 #include "blackhat_custom_event.h"
+#include "blackhat_deadline.h"
+#include "blackhat_fb.h"
+#include "blackhat_line_list.h"
+#include "blackhat_log.h"
+#include "blackhat_menu.h"
+#include "blackhat_mirror.h"
+#include "blackhat_profile.h"
+#include "blackhat_response.h"
+#include "blackhat_rpc.h"
+#include "blackhat_store.h"
+#include "blackhat_telemetry.h"
+#include "blackhat_term.h"
+#include "blackhat_trace.h"
 #include "blackhat_uart.h"
+#include "blackhat_xfer.h"
 #include "scenes/blackhat_scene.h"
 
-#define NUM_MENU_ITEMS (20)
-
-#define BLACKHAT_TEXT_BOX_STORE_SIZE (4096)
+// Console redraw pacing, the frame interval backs off under heavy RX load
+#define BLACKHAT_CONSOLE_FRAME_MS (100)
+#define BLACKHAT_CONSOLE_FRAME_MAX_MS (800)
+#define BLACKHAT_CONSOLE_HEAVY_RX_BYTES (1024)
 #define UART_CH FuriHalSerialIdUsart
+// Same as stack_size in application.fam
+#define BLACKHAT_APP_STACK_SIZE (2 * 1024)
 
 #define SHELL_CMD "whoami"
 #define SCAN_CMD "bh script scan"
@@ -35,6 +56,7 @@
 #define SET_INET_SSID_CMD "bh set SSID"
 #define SET_INET_PWD_CMD "bh set PASS"
 #define SET_AP_SSID_CMD "bh set AP_SSID"
+#define SET_CMD_PREFIX "bh set "
 #define LIST_AP_CMD "bh wifi list"
 #define DEV_CMD "bh wifi dev"
 #define DEAUTH_CMD "bh deauth_broadcast"
@@ -46,8 +68,15 @@
 #define ST_EVIL_PORT_CMD "bh evil_portal"
 #define TEST_INET "bh test_inet"
 #define GET_CMD "bh get"
+#define SUMMARY_CMD GET_CMD "; " GET_IP_CMD "; " DEV_CMD
 #define REBOOT_CMD "reboot"
+#define LOG_TOGGLE_CMD "log"
+#define DIAG_CMD "diag"
+#define DASH_CMD "dash"
+#define PROFILE_CMD "profile"
+#define XFER_CMD "xfer"
 #define BHTUI_CMD "TERM=linux bhtui > /dev/tty1 2>&1"
+#define BHTUI_MIRROR_CMD "TERM=linux bhtui --mirror > /dev/tty1 2>&1"
 
 typedef enum { NO_ARGS = 0, INPUT_ARGS, TOGGLE_ARGS } InputArgs;
 
@@ -57,52 +86,114 @@ typedef enum {
     FOCUS_CONSOLE_TOGGLE
 } FocusConsole;
 
-#define MAX_OPTIONS (9)
+#define ENTER_NAME_LENGTH 25
+
+// Snapshot drawn by the link diagnostics scene
 typedef struct {
-    const char* item_string;
-    char* options_menu[MAX_OPTIONS];
-    int num_options_menu;
-    char* selected_option;
-    char* actual_command;
-    bool text_input_req;
-} BlackhatItem;
+    BlackhatUartStats uart;
+    uint32_t baud;
+    bool framed;
+    bool logging;
+    uint32_t log_written;
+    uint32_t log_dropped;
+} BlackhatDiagModel;
 
-#define ENTER_NAME_LENGTH 25
+typedef enum {
+    BlackhatDashStateWaiting,
+    BlackhatDashStateLive,
+    BlackhatDashStateNoLink,
+} BlackhatDashState;
+
+// Last telemetry values drawn by the device dashboard scene
+typedef struct {
+    BlackhatTelemetryFields fields;
+    BlackhatDashState state;
+} BlackhatDashModel;
+
+typedef enum {
+    BlackhatProfilePageHeap,
+    BlackhatProfilePageScenes,
+    BlackhatProfilePageHistory,
+    BlackhatProfilePageCount,
+} BlackhatProfilePage;
+
+// Snapshot drawn by the memory profiler scene
+typedef struct {
+    BlackhatProfileStats stats;
+    BlackhatProfilePage page;
+} BlackhatProfileModel;
+
+// Progress drawn by the file transfer scene
+typedef struct {
+    BlackhatXferStatus status;
+    char name[32];
+} BlackhatXferModel;
 
 struct BlackhatApp {
     Gui* gui;
     ViewDispatcher* view_dispatcher;
     SceneManager* scene_manager;
 
-    FuriString* text_box_store;
-
-    // For custom scripts
-    char* script_text;
-    size_t script_text_ptr;
-    int num_scripts;
-    char* cmd[64];
+    BlackhatTerm* term;
+    FuriMutex* console_mutex;
+    size_t console_pending;
+    bool console_refresh_queued;
+    uint32_t console_frame_ms;
+    uint32_t console_last_frame;
+
+    // For custom scripts, lines are parsed as the scan streams in
+    BlackhatLineList script_list;
+    BlackhatLineList param_lines;
+    BlackhatLineList* rx_lines;
     bool scanned;
+
+    // Loaded from SD on launch, the device is asked again lazily
+    BlackhatStoreParams params;
+    BlackhatLineList script_update;
+    bool scripts_validated;
+
+    // Start menu, rebuilt when the device advertises a new schema
+    BlackhatMenu menu;
+    BlackhatLineList schema;
+    BlackhatLineList schema_update;
+    bool schema_validated;
+    volatile bool link_ready;
     VariableItemList* script_item_list;
 
-    size_t text_box_store_strlen;
     TextBox* text_box;
 
     VariableItemList* var_item_list;
     BlackhatUart* uart;
+    BlackhatBaud* baud;
+    BlackhatRpc* rpc;
+    BlackhatLog* log;
+    BlackhatBench* bench;
     TextInput* text_input;
+    Loading* loading;
+    BlackhatResponse* response;
+    BlackhatCache* cache;
     View* tui_view;
+    BlackhatMirror* mirror;
+    BlackhatFb* fb;
+    View* diag_view;
+    BlackhatTelemetry* telemetry;
+    View* dash_view;
+    BlackhatProfile* profile;
+    View* profile_view;
+    BlackhatXfer* xfer;
+    View* xfer_view;
     DialogsApp* dialogs;
 
     int selected_menu_index;
-    int selected_option_index[NUM_MENU_ITEMS];
+    int selected_option_index[BLACKHAT_MENU_MAX_ITEMS];
     char* selected_tx_string;
     const char* selected_option_item_text;
     char text_store[128];
     char text_input_ch[ENTER_NAME_LENGTH];
     bool text_input_req;
-    bool is_script_scan;
 
     bool tui_game_mode;
+    bool tui_mirror;
     bool tui_ok_held;
     bool tui_a_pressed;
     bool tui_ok_chord_used;
@@ -110,8 +201,13 @@ struct BlackhatApp {
     bool tui_right_chord;
     bool tui_back_held;
     bool tui_back_exit_sent;
-    uint32_t tui_ok_pressed_at;
-    uint32_t tui_back_pressed_at;
+    bool tui_state_frames;
+    uint8_t tui_buttons;
+    uint8_t tui_buttons_sent;
+    uint8_t tui_seq;
+    uint32_t tui_frame_at;
+    BlackhatDeadline* tui_a_hold;
+    BlackhatDeadline* tui_back_hold;
 };
 
 typedef enum {
@@ -121,4 +217,16 @@ typedef enum {
     BlackhatAppViewStartPortal,
     BlackhatAppViewTextInput,
     BlackhatAppViewTui,
+    BlackhatAppViewLoading,
+    BlackhatAppViewDiagnostics,
+    BlackhatAppViewTerminal,
+    BlackhatAppViewMirror,
+    BlackhatAppViewFramebuffer,
+    BlackhatAppViewDashboard,
+    BlackhatAppViewProfile,
+    BlackhatAppViewXfer,
 } BlackhatAppView;
+
+// Drops back to BLACKHAT_UART_BAUD and negotiates the link again, for when
+// the device restarts
+void blackhat_app_relink(BlackhatApp* app);
@@ -0,0 +1,81 @@
+#include "blackhat_arena.h"
+
+#include <stdlib.h>
+
+#define BLACKHAT_ARENA_ALIGN (sizeof(void*))
+
+struct BlackhatArenaBlock {
+    BlackhatArenaBlock* next;
+    size_t size;
+    size_t used;
+    uint8_t data[];
+};
+
+void blackhat_arena_init(BlackhatArena* arena)
+{
+    arena->first = NULL;
+    arena->current = NULL;
+}
+
+void blackhat_arena_reset(BlackhatArena* arena)
+{
+    for (BlackhatArenaBlock* b = arena->first; b; b = b->next) {
+        b->used = 0;
+    }
+    arena->current = arena->first;
+}
+
+void blackhat_arena_free(BlackhatArena* arena)
+{
+    BlackhatArenaBlock* b = arena->first;
+    while (b) {
+        BlackhatArenaBlock* next = b->next;
+        free(b);
+        b = next;
+    }
+    blackhat_arena_init(arena);
+}
+
+void* blackhat_arena_alloc(BlackhatArena* arena, size_t size)
+{
+    size = (size + BLACKHAT_ARENA_ALIGN - 1) & ~(BLACKHAT_ARENA_ALIGN - 1);
+
+    // Move on through blocks kept from before the last reset, then grow
+    while (arena->current &&
+           arena->current->used + size > arena->current->size) {
+        arena->current = arena->current->next;
+    }
+
+    if (!arena->current) {
+        size_t block_size = size > BLACKHAT_ARENA_BLOCK_SIZE ?
+                                size :
+                                BLACKHAT_ARENA_BLOCK_SIZE;
+        BlackhatArenaBlock* b =
+            malloc(sizeof(BlackhatArenaBlock) + block_size);
+        b->next = NULL;
+        b->size = block_size;
+        b->used = 0;
+
+        if (!arena->first) {
+            arena->first = b;
+        } else {
+            BlackhatArenaBlock* last = arena->first;
+            while (last->next) last = last->next;
+            last->next = b;
+        }
+        arena->current = b;
+    }
+
+    void* ptr = &arena->current->data[arena->current->used];
+    arena->current->used += size;
+    return ptr;
+}
+
+size_t blackhat_arena_capacity(BlackhatArena* arena)
+{
+    size_t capacity = 0;
+    for (BlackhatArenaBlock* b = arena->first; b; b = b->next) {
+        capacity += b->size;
+    }
+    return capacity;
+}
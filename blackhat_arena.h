@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bump allocator made of chained blocks. Reset rewinds every block for
+// reuse, so a workload that is rebuilt over and over stops touching the
+// heap once it has reached its high-water mark.
+
+#define BLACKHAT_ARENA_BLOCK_SIZE (512)
+
+typedef struct BlackhatArenaBlock BlackhatArenaBlock;
+
+typedef struct {
+    BlackhatArenaBlock* first;
+    BlackhatArenaBlock* current;
+} BlackhatArena;
+
+void blackhat_arena_init(BlackhatArena* arena);
+void blackhat_arena_reset(BlackhatArena* arena);
+void blackhat_arena_free(BlackhatArena* arena);
+void* blackhat_arena_alloc(BlackhatArena* arena, size_t size);
+size_t blackhat_arena_capacity(BlackhatArena* arena);
@@ -0,0 +1,337 @@
+#include "blackhat_baud.h"
+
+#include <storage/storage.h>
+
+#include "blackhat_app_i.h"
+#include "blackhat_crc.h"
+
+#define TAG "BlackhatBaud"
+
+#define BAUD_CMD "bh baud"
+#define BAUD_REPLY "BHBAUD "
+#define BAUD_CACHE_PATH APP_DATA_PATH("baud.txt")
+
+#define BAUD_PAYLOAD_SIZE (16)
+#define BAUD_LINE_SIZE (96)
+#define BAUD_REPLY_TIMEOUT_MS (500)
+#define BAUD_BOOT_TIMEOUT_MS (60000)
+#define BAUD_BOOT_POLL_MS (250)
+#define BAUD_BOOT_QUIET_MS (1500)
+#define BAUD_SWITCH_DELAY_MS (20)
+#define BAUD_REVERT_DELAY_MS (1200)
+
+// Fastest first, anything the HAL can't generate is skipped
+static const uint32_t blackhat_baud_rates[] = {
+    2000000,
+    1500000,
+    921600,
+    460800,
+};
+
+typedef enum {
+    BaudEvtStop = (1 << 0),
+    BaudEvtOk = (1 << 1),
+    BaudEvtBad = (1 << 2),
+} BaudEvtFlags;
+
+#define BAUD_ALL_EVENTS (BaudEvtStop | BaudEvtOk | BaudEvtBad)
+
+typedef enum {
+    BaudCheckOk,
+    BaudCheckBad,
+    BaudCheckNoReply,
+    BaudCheckUnsupported,
+} BaudCheckResult;
+
+struct BlackhatBaud {
+    BlackhatUart* uart;
+    FuriThread* thread;
+    volatile bool stop;
+    bool alive;
+    void (*done_cb)(bool alive, void* context);
+    void* done_context;
+
+    // Filled by the RX hook on the UART worker thread
+    char line[BAUD_LINE_SIZE];
+    size_t line_len;
+    volatile bool rx_seen;
+    volatile uint32_t last_rx;
+    char expected[BAUD_PAYLOAD_SIZE * 2 + 1];
+};
+
+static void blackhat_baud_parse_line(BlackhatBaud* baud)
+{
+    if (strncmp(baud->line, BAUD_REPLY, strlen(BAUD_REPLY))) return;
+
+    char* payload = &baud->line[strlen(BAUD_REPLY)];
+    char* crc_str = strchr(payload, ' ');
+    if (!crc_str) return;
+    *crc_str++ = '\0';
+
+    uint32_t crc = strtoul(crc_str, NULL, 16);
+    bool ok = !strcmp(payload, baud->expected) &&
+              crc == blackhat_crc32(0, payload, strlen(payload));
+
+    furi_thread_flags_set(
+        furi_thread_get_id(baud->thread), ok ? BaudEvtOk : BaudEvtBad
+    );
+}
+
+static void blackhat_baud_rx_hook(
+    const uint8_t* buf, size_t len, void* context
+)
+{
+    BlackhatBaud* baud = context;
+
+    baud->rx_seen = true;
+    baud->last_rx = furi_get_tick();
+    for (size_t i = 0; i < len; i++) {
+        char c = buf[i];
+        if (c == '\r') continue;
+        if (c == '\n') {
+            baud->line[baud->line_len] = '\0';
+            blackhat_baud_parse_line(baud);
+            baud->line_len = 0;
+        } else if (baud->line_len < BAUD_LINE_SIZE - 1) {
+            baud->line[baud->line_len++] = c;
+        }
+    }
+}
+
+static BaudCheckResult blackhat_baud_check(BlackhatBaud* baud)
+{
+    static const char hex[] = "0123456789abcdef";
+    char cmd[BAUD_LINE_SIZE];
+
+    for (size_t i = 0; i < BAUD_PAYLOAD_SIZE; i++) {
+        uint8_t b = furi_hal_random_get();
+        baud->expected[i * 2] = hex[b >> 4];
+        baud->expected[i * 2 + 1] = hex[b & 0x0f];
+    }
+    baud->expected[BAUD_PAYLOAD_SIZE * 2] = '\0';
+
+    snprintf(
+        cmd,
+        sizeof(cmd),
+        "%s check %s %08lx\n",
+        BAUD_CMD,
+        baud->expected,
+        (unsigned long)blackhat_crc32(
+            0, baud->expected, BAUD_PAYLOAD_SIZE * 2
+        )
+    );
+
+    baud->line_len = 0;
+    baud->rx_seen = false;
+    furi_thread_flags_clear(BaudEvtOk | BaudEvtBad);
+    blackhat_uart_tx(baud->uart, cmd, strlen(cmd));
+
+    uint32_t events = furi_thread_flags_wait(
+        BAUD_ALL_EVENTS, FuriFlagWaitAny, BAUD_REPLY_TIMEOUT_MS
+    );
+    if (events & FuriFlagError) {
+        // Something answered, just not our handshake: old device image
+        return baud->rx_seen ? BaudCheckUnsupported : BaudCheckNoReply;
+    }
+    if (events & BaudEvtStop) {
+        baud->stop = true;
+        return BaudCheckNoReply;
+    }
+
+    return (events & BaudEvtOk) ? BaudCheckOk : BaudCheckBad;
+}
+
+static bool blackhat_baud_try(BlackhatBaud* baud, uint32_t rate)
+{
+    char cmd[32];
+    bool ok;
+
+    // Console and urgent TX only wait out the rate switches themselves, not
+    // the round trip
+    snprintf(cmd, sizeof(cmd), "%s set %lu\n", BAUD_CMD, (unsigned long)rate);
+    blackhat_uart_tx_lock(baud->uart);
+    blackhat_uart_tx(baud->uart, cmd, strlen(cmd));
+    blackhat_uart_set_baud(baud->uart, rate);
+    blackhat_uart_tx_unlock(baud->uart);
+    furi_delay_ms(BAUD_SWITCH_DELAY_MS);
+
+    ok = blackhat_baud_check(baud) == BaudCheckOk;
+    if (ok) {
+        snprintf(cmd, sizeof(cmd), "%s commit\n", BAUD_CMD);
+        blackhat_uart_tx_lock(baud->uart);
+        blackhat_uart_tx(baud->uart, cmd, strlen(cmd));
+        blackhat_uart_tx_unlock(baud->uart);
+    } else {
+        blackhat_uart_tx_lock(baud->uart);
+        blackhat_uart_set_baud(baud->uart, BLACKHAT_UART_BAUD);
+        blackhat_uart_tx_unlock(baud->uart);
+        // The device falls back by itself once its revert timer expires,
+        // stop cuts the wait short
+        if (!baud->stop) {
+            uint32_t events = furi_thread_flags_wait(
+                BaudEvtStop, FuriFlagWaitAny, BAUD_REVERT_DELAY_MS
+            );
+            if (events == BaudEvtStop) baud->stop = true;
+        }
+    }
+
+    FURI_LOG_I(TAG, "%lu baud: %s", (unsigned long)rate, ok ? "ok" : "failed");
+    return ok;
+}
+
+static uint32_t blackhat_baud_load(void)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    char buf[16] = {0};
+    uint32_t rate = 0;
+
+    if (storage_file_open(
+            file, BAUD_CACHE_PATH, FSAM_READ, FSOM_OPEN_EXISTING
+        )) {
+        storage_file_read(file, buf, sizeof(buf) - 1);
+        rate = strtoul(buf, NULL, 10);
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    return rate;
+}
+
+static void blackhat_baud_save(uint32_t rate)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    char buf[16];
+
+    if (storage_file_open(
+            file, BAUD_CACHE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS
+        )) {
+        snprintf(buf, sizeof(buf), "%lu\n", (unsigned long)rate);
+        storage_file_write(file, buf, strlen(buf));
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static bool blackhat_baud_wait_for_device(BlackhatBaud* baud)
+{
+    uint32_t start = furi_get_tick();
+
+    // The device is power cycled on launch. Stay silent until its boot
+    // output has gone quiet, so we never interrupt the bootloader.
+    while (!baud->stop) {
+        bool timed_out = furi_get_tick() - start >=
+                         furi_ms_to_ticks(BAUD_BOOT_TIMEOUT_MS);
+
+        if (!timed_out) {
+            if (furi_thread_flags_wait(
+                    BaudEvtStop, FuriFlagWaitAny, BAUD_BOOT_POLL_MS
+                ) == BaudEvtStop) {
+                baud->stop = true;
+                break;
+            }
+
+            if (!baud->last_rx ||
+                furi_get_tick() - baud->last_rx <
+                    furi_ms_to_ticks(BAUD_BOOT_QUIET_MS)) {
+                continue;
+            }
+        }
+
+        switch (blackhat_baud_check(baud)) {
+        case BaudCheckOk:
+            baud->alive = true;
+            return true;
+        case BaudCheckUnsupported:
+            FURI_LOG_I(TAG, "Device has no baud handshake");
+            baud->alive = true;
+            return false;
+        default:
+            break;
+        }
+
+        // One last try reaches a device that printed nothing at boot
+        if (timed_out) break;
+    }
+
+    return false;
+}
+
+static int32_t blackhat_baud_worker(void* context)
+{
+    BlackhatBaud* baud = context;
+
+    blackhat_uart_set_rx_hook(baud->uart, blackhat_baud_rx_hook, baud);
+
+    if (blackhat_baud_wait_for_device(baud)) {
+        uint32_t cached = blackhat_baud_load();
+        uint32_t chosen = BLACKHAT_UART_BAUD;
+
+        if (cached > BLACKHAT_UART_BAUD &&
+            blackhat_uart_is_baud_supported(baud->uart, cached) &&
+            blackhat_baud_try(baud, cached)) {
+            chosen = cached;
+        }
+
+        for (size_t i = 0; !baud->stop && chosen == BLACKHAT_UART_BAUD &&
+                           i < COUNT_OF(blackhat_baud_rates);
+             i++) {
+            uint32_t rate = blackhat_baud_rates[i];
+            if (rate == cached) continue;
+            if (!blackhat_uart_is_baud_supported(baud->uart, rate)) continue;
+            if (blackhat_baud_try(baud, rate)) chosen = rate;
+        }
+
+        if (chosen != cached) blackhat_baud_save(chosen);
+    }
+
+    blackhat_uart_set_rx_hook(baud->uart, NULL, NULL);
+
+    if (!baud->stop && baud->done_cb) {
+        baud->done_cb(baud->alive, baud->done_context);
+    }
+
+    return 0;
+}
+
+BlackhatBaud* blackhat_baud_start(
+    BlackhatUart* uart,
+    void (*done_cb)(bool alive, void* context),
+    void* context
+)
+{
+    BlackhatBaud* baud = malloc(sizeof(BlackhatBaud));
+    baud->uart = uart;
+    baud->stop = false;
+    baud->alive = false;
+    baud->done_cb = done_cb;
+    baud->done_context = context;
+    baud->line_len = 0;
+    baud->last_rx = 0;
+
+    baud->thread = furi_thread_alloc();
+    furi_thread_set_name(baud->thread, "BlackhatBaudThread");
+    furi_thread_set_stack_size(baud->thread, 2048);
+    furi_thread_set_context(baud->thread, baud);
+    furi_thread_set_callback(baud->thread, blackhat_baud_worker);
+    furi_thread_start(baud->thread);
+
+    return baud;
+}
+
+void blackhat_baud_stop(BlackhatBaud* baud)
+{
+    furi_assert(baud);
+
+    baud->stop = true;
+    furi_thread_flags_set(furi_thread_get_id(baud->thread), BaudEvtStop);
+    furi_thread_join(baud->thread);
+    furi_thread_free(baud->thread);
+
+    free(baud);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "blackhat_uart.h"
+
+// Background link speed negotiation.
+//
+// Once the device answers the handshake at BLACKHAT_UART_BAUD, each faster
+// rate is tried in turn:
+//   -> "bh baud set <rate>"     device switches and arms a revert timer
+//   -> "bh baud check <hex> <crc32>" sent at the new rate
+//   <- "BHBAUD <hex> <crc32>"   echoed back, verified on the Flipper
+//   -> "bh baud commit"         device keeps the new rate
+// If the round trip fails the Flipper drops back and the device reverts on
+// its own. The rate that worked is cached and tried first on next launch.
+
+typedef struct BlackhatBaud BlackhatBaud;
+
+// done_cb runs on the negotiation thread once the link is settled, `alive`
+// tells whether the device answered at all
+BlackhatBaud* blackhat_baud_start(
+    BlackhatUart* uart,
+    void (*done_cb)(bool alive, void* context),
+    void* context
+);
+void blackhat_baud_stop(BlackhatBaud* baud);
@@ -0,0 +1,539 @@
+#include "blackhat_bench.h"
+
+#include <furi_hal.h>
+#include <storage/storage.h>
+
+#include "blackhat_app_i.h"
+
+#define TAG "BlackhatBench"
+
+#define BENCH_PREFIX "BHB "
+#define BENCH_IDLE_MS (500)
+#define BENCH_STEP_TIMEOUT_MS (BLACKHAT_BENCH_STEP_MS * 4)
+#define BENCH_SCAN_RESET_LINES (128)
+// Give up on a consumer once it loses more than this share, in percent
+#define BENCH_MAX_LOSS (50)
+
+// Bytes per second, steps too fast for the current baud rate are skipped
+static const uint32_t blackhat_bench_rates[] = {
+    1000,
+    2000,
+    4000,
+    8000,
+    16000,
+    32000,
+    64000,
+    128000,
+    192000,
+};
+
+static const char* const blackhat_bench_consumer_names[] = {
+    [BlackhatBenchConsumerConsole] = "console",
+    [BlackhatBenchConsumerTui] = "tui",
+    [BlackhatBenchConsumerScan] = "scan",
+};
+
+typedef enum {
+    BenchEvtStop = (1 << 0),
+    BenchEvtDone = (1 << 1),
+} BenchEvtFlags;
+
+#define BENCH_ALL_EVENTS (BenchEvtStop | BenchEvtDone)
+
+void blackhat_console_output_handle_rx_data_cb(
+    uint8_t* buf, size_t len, void* context
+);
+void blackhat_scene_tui_handle_rx_data(
+    uint8_t* buf, size_t len, void* context
+);
+
+// log2 buckets in microseconds
+typedef struct {
+    uint32_t hist[BLACKHAT_BENCH_LAT_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+} BlackhatBenchHist;
+
+struct BlackhatBench {
+    BlackhatApp* app;
+    FuriThread* thread;
+    volatile bool stop;
+    uint32_t step_event;
+    uint32_t done_event;
+
+    BlackhatBenchResult results[BLACKHAT_BENCH_MAX_STEPS];
+    volatile size_t count;
+    char path[64];
+    FuriString* report;
+    BlackhatBenchHist consumer_lat[BlackhatBenchConsumerCount];
+
+    // Current step, only touched by the UART worker while it runs
+    BlackhatBenchConsumer consumer;
+    BlackhatLineList scan;
+    char line[BLACKHAT_BENCH_LINE_SIZE + 1];
+    size_t line_len;
+    uint32_t next_idx;
+    BlackhatBenchHist step_lat;
+    uint32_t first_rx;
+    uint32_t last_rx;
+    BlackhatBenchResult* result;
+};
+
+void blackhat_bench_format_line(char* line, uint32_t idx)
+{
+    size_t len = snprintf(
+        line,
+        BLACKHAT_BENCH_LINE_SIZE,
+        BENCH_PREFIX "%08lx ",
+        (unsigned long)idx
+    );
+    for (size_t i = 0; len < BLACKHAT_BENCH_LINE_SIZE - 1; i++) {
+        line[len++] = 'a' + (idx + i) % 26;
+    }
+    line[len++] = '\n';
+    line[len] = '\0';
+}
+
+static void blackhat_bench_check_line(BlackhatBench* bench)
+{
+    BlackhatBenchResult* result = bench->result;
+    char expected[BLACKHAT_BENCH_LINE_SIZE + 1];
+
+    // Echo and prompt lines don't carry the prefix, anything else that
+    // does but doesn't match was damaged on the way
+    if (!strstr(bench->line, BENCH_PREFIX)) return;
+
+    uint32_t idx = strtoul(&bench->line[strlen(BENCH_PREFIX)], NULL, 16);
+    blackhat_bench_format_line(expected, idx);
+    if (bench->line_len == BLACKHAT_BENCH_LINE_SIZE &&
+        !memcmp(bench->line, expected, BLACKHAT_BENCH_LINE_SIZE) &&
+        idx >= bench->next_idx && idx < result->lines_expected) {
+        result->lines_ok++;
+        bench->next_idx = idx + 1;
+    } else {
+        result->lines_bad++;
+    }
+
+    if (bench->next_idx == result->lines_expected) {
+        furi_thread_flags_set(furi_thread_get_id(bench->thread), BenchEvtDone);
+    }
+}
+
+// Runs on the UART worker in place of the scene callback
+static void blackhat_bench_rx_cb(uint8_t* buf, size_t len, void* context)
+{
+    BlackhatApp* app = context;
+    BlackhatBench* bench = app->bench;
+
+    // The consumer under test sees the bytes first, exactly as it would
+    switch (bench->consumer) {
+    case BlackhatBenchConsumerConsole:
+        blackhat_console_output_handle_rx_data_cb(buf, len, app);
+        break;
+    case BlackhatBenchConsumerTui:
+        blackhat_scene_tui_handle_rx_data(buf, len, app);
+        break;
+    case BlackhatBenchConsumerScan:
+        blackhat_line_list_feed(&bench->scan, buf, len);
+        if (bench->scan.count >= BENCH_SCAN_RESET_LINES) {
+            blackhat_line_list_reset(&bench->scan);
+        }
+        break;
+    default:
+        break;
+    }
+    blackhat_uart_rx_latency_mark(app->uart);
+
+    uint32_t now = furi_get_tick();
+    if (!bench->result->rx_bytes) bench->first_rx = now;
+    bench->last_rx = now;
+    bench->result->rx_bytes += len;
+
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] == '\r') continue;
+        if (buf[i] != '\n') {
+            if (bench->line_len < BLACKHAT_BENCH_LINE_SIZE) {
+                bench->line[bench->line_len] = buf[i];
+            }
+            bench->line_len++;
+            continue;
+        }
+
+        if (bench->line_len < BLACKHAT_BENCH_LINE_SIZE) {
+            bench->line[bench->line_len++] = '\n';
+        } else {
+            bench->line_len++;
+        }
+        bench->line[MIN(bench->line_len, BLACKHAT_BENCH_LINE_SIZE)] = '\0';
+        blackhat_bench_check_line(bench);
+        bench->line_len = 0;
+    }
+}
+
+static void blackhat_bench_hist_add(BlackhatBenchHist* hist, uint32_t us)
+{
+    size_t bucket = 0;
+    while (bucket < BLACKHAT_BENCH_LAT_BUCKETS - 1 &&
+           (1UL << bucket) <= us) {
+        bucket++;
+    }
+
+    hist->hist[bucket]++;
+    hist->count++;
+    hist->max = MAX(hist->max, us);
+}
+
+static void blackhat_bench_latency_cb(uint32_t latency_us, void* context)
+{
+    BlackhatBench* bench = context;
+
+    blackhat_bench_hist_add(&bench->step_lat, latency_us);
+    blackhat_bench_hist_add(
+        &bench->consumer_lat[bench->consumer], latency_us
+    );
+}
+
+// Upper bound of the log2 bucket holding the given share of samples
+static uint32_t
+    blackhat_bench_percentile(const BlackhatBenchHist* hist, uint32_t pct)
+{
+    uint32_t want = (hist->count * pct + 99) / 100;
+    uint32_t seen = 0;
+
+    for (size_t i = 0; i < BLACKHAT_BENCH_LAT_BUCKETS; i++) {
+        seen += hist->hist[i];
+        if (want && seen >= want) return MIN(1UL << i, hist->max);
+    }
+
+    return hist->max;
+}
+
+static void blackhat_bench_step(
+    BlackhatBench* bench, BlackhatBenchConsumer consumer, uint32_t rate
+)
+{
+    BlackhatApp* app = bench->app;
+    BlackhatBenchResult* result = &bench->results[bench->count];
+    uint32_t bytes = rate * BLACKHAT_BENCH_STEP_MS / 1000;
+    char cmd[48];
+
+    memset(result, 0, sizeof(*result));
+    result->consumer = consumer;
+    result->baud = blackhat_uart_get_baud(app->uart);
+    result->rate = rate;
+    result->lines_expected = bytes / BLACKHAT_BENCH_LINE_SIZE;
+
+    bench->consumer = consumer;
+    bench->result = result;
+    bench->line_len = 0;
+    bench->next_idx = 0;
+    memset(&bench->step_lat, 0, sizeof(bench->step_lat));
+    blackhat_line_list_reset(&bench->scan);
+
+    furi_thread_flags_clear(BenchEvtDone);
+    blackhat_uart_set_rx_latency_cb(
+        app->uart, blackhat_bench_latency_cb, bench
+    );
+    blackhat_uart_set_handle_rx_data_cb(app->uart, blackhat_bench_rx_cb);
+
+    snprintf(
+        cmd,
+        sizeof(cmd),
+        "%s %lu %lu\n",
+        BLACKHAT_BENCH_CMD,
+        (unsigned long)rate,
+        (unsigned long)bytes
+    );
+    uint32_t start = furi_get_tick();
+    blackhat_uart_tx(app->uart, cmd, strlen(cmd));
+
+    // Done when the last line arrives, or once the stream has gone quiet
+    while (!bench->stop &&
+           furi_get_tick() - start < furi_ms_to_ticks(BENCH_STEP_TIMEOUT_MS)) {
+        uint32_t seen = result->rx_bytes;
+        uint32_t events = furi_thread_flags_wait(
+            BENCH_ALL_EVENTS, FuriFlagWaitAny, BENCH_IDLE_MS
+        );
+        if (!(events & FuriFlagError)) {
+            if (events & BenchEvtStop) bench->stop = true;
+            if (events & BenchEvtDone) break;
+        } else if (
+            result->rx_bytes == seen &&
+            furi_get_tick() - start >=
+                furi_ms_to_ticks(BLACKHAT_BENCH_STEP_MS)) {
+            break;
+        }
+    }
+
+    blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+    blackhat_uart_set_rx_latency_cb(app->uart, NULL, NULL);
+    // The worker may still be inside the callbacks, and the bench is freed
+    // once the last step is over
+    blackhat_uart_rx_sync(app->uart);
+
+    result->elapsed_ms = bench->last_rx - bench->first_rx;
+    result->p50_us = blackhat_bench_percentile(&bench->step_lat, 50);
+    result->p99_us = blackhat_bench_percentile(&bench->step_lat, 99);
+    result->max_us = bench->step_lat.max;
+
+    // Let the prompt drain so it doesn't land in the next step
+    furi_delay_ms(BENCH_IDLE_MS);
+}
+
+static void blackhat_bench_save(BlackhatBench* bench)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    FuriString* row = furi_string_alloc();
+    DateTime dt;
+
+    furi_hal_rtc_get_datetime(&dt);
+    snprintf(
+        bench->path,
+        sizeof(bench->path),
+        "%s/%04u%02u%02u-%02u%02u%02u.csv",
+        BLACKHAT_BENCH_DIR,
+        dt.year,
+        dt.month,
+        dt.day,
+        dt.hour,
+        dt.minute,
+        dt.second
+    );
+
+    storage_simply_mkdir(storage, BLACKHAT_BENCH_DIR);
+    if (storage_file_open(
+            file, bench->path, FSAM_WRITE, FSOM_CREATE_ALWAYS
+        )) {
+        furi_string_set_str(
+            row,
+            "firmware,consumer,baud,rate_Bps,rx_bytes,elapsed_ms,"
+            "throughput_Bps,lines_expected,lines_ok,lines_bad,"
+            "lines_missing,p50_us,p99_us,max_us\n"
+        );
+        storage_file_write(
+            file, furi_string_get_cstr(row), furi_string_size(row)
+        );
+
+        const char* firmware =
+            version_get_version(furi_hal_version_get_firmware_version());
+        for (size_t i = 0; i < bench->count; i++) {
+            const BlackhatBenchResult* r = &bench->results[i];
+            furi_string_printf(
+                row,
+                "%s,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+                firmware,
+                blackhat_bench_consumer_name(r->consumer),
+                (unsigned long)r->baud,
+                (unsigned long)r->rate,
+                (unsigned long)r->rx_bytes,
+                (unsigned long)r->elapsed_ms,
+                (unsigned long)(r->elapsed_ms ?
+                                    (uint64_t)r->rx_bytes * 1000 /
+                                        r->elapsed_ms :
+                                    0),
+                (unsigned long)r->lines_expected,
+                (unsigned long)r->lines_ok,
+                (unsigned long)r->lines_bad,
+                (unsigned long)blackhat_bench_missing(r),
+                (unsigned long)r->p50_us,
+                (unsigned long)r->p99_us,
+                (unsigned long)r->max_us
+            );
+            storage_file_write(
+                file, furi_string_get_cstr(row), furi_string_size(row)
+            );
+        }
+        FURI_LOG_I(TAG, "Results saved to %s", bench->path);
+    } else {
+        FURI_LOG_E(TAG, "Can't open %s", bench->path);
+        bench->path[0] = '\0';
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_string_free(row);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static int32_t blackhat_bench_worker(void* context)
+{
+    BlackhatBench* bench = context;
+    BlackhatApp* app = bench->app;
+
+    for (size_t c = 0; c < BlackhatBenchConsumerCount && !bench->stop; c++) {
+        // 10 bits per byte, leave some headroom for the echo and prompt
+        uint32_t wire = blackhat_uart_get_baud(app->uart) / 10 * 9 / 10;
+
+        for (size_t i = 0; i < COUNT_OF(blackhat_bench_rates); i++) {
+            uint32_t rate = blackhat_bench_rates[i];
+            if (bench->stop || rate > wire ||
+                bench->count == BLACKHAT_BENCH_MAX_STEPS) {
+                break;
+            }
+
+            blackhat_bench_step(bench, c, rate);
+            const BlackhatBenchResult* result = &bench->results[bench->count];
+            bench->count++;
+            view_dispatcher_send_custom_event(
+                app->view_dispatcher, bench->step_event
+            );
+
+            if (blackhat_bench_missing(result) + result->lines_bad >
+                result->lines_expected * BENCH_MAX_LOSS / 100) {
+                break;
+            }
+        }
+    }
+
+    if (bench->count) blackhat_bench_save(bench);
+    view_dispatcher_send_custom_event(app->view_dispatcher, bench->done_event);
+
+    return 0;
+}
+
+BlackhatBench* blackhat_bench_start(
+    BlackhatApp* app, uint32_t step_event, uint32_t done_event
+)
+{
+    BlackhatBench* bench = malloc(sizeof(BlackhatBench));
+    bench->app = app;
+    bench->stop = false;
+    bench->step_event = step_event;
+    bench->done_event = done_event;
+    bench->count = 0;
+    bench->path[0] = '\0';
+    bench->report = furi_string_alloc();
+    memset(bench->consumer_lat, 0, sizeof(bench->consumer_lat));
+    blackhat_line_list_init(&bench->scan);
+
+    // The RX callback finds the bench through the app
+    app->bench = bench;
+
+    bench->thread = furi_thread_alloc();
+    furi_thread_set_name(bench->thread, "BlackhatBenchThread");
+    furi_thread_set_stack_size(bench->thread, 2048);
+    furi_thread_set_context(bench->thread, bench);
+    furi_thread_set_callback(bench->thread, blackhat_bench_worker);
+    furi_thread_start(bench->thread);
+
+    return bench;
+}
+
+void blackhat_bench_stop(BlackhatBench* bench)
+{
+    furi_assert(bench);
+
+    bench->stop = true;
+    furi_thread_flags_set(furi_thread_get_id(bench->thread), BenchEvtStop);
+    furi_thread_join(bench->thread);
+    furi_thread_free(bench->thread);
+
+    blackhat_line_list_free(&bench->scan);
+    furi_string_free(bench->report);
+    bench->app->bench = NULL;
+    free(bench);
+}
+
+size_t blackhat_bench_get_count(BlackhatBench* bench)
+{
+    return bench->count;
+}
+
+const BlackhatBenchResult*
+    blackhat_bench_get_result(BlackhatBench* bench, size_t index)
+{
+    furi_assert(index < bench->count);
+    return &bench->results[index];
+}
+
+const char* blackhat_bench_consumer_name(BlackhatBenchConsumer consumer)
+{
+    return consumer < BlackhatBenchConsumerCount ?
+               blackhat_bench_consumer_names[consumer] :
+               "?";
+}
+
+uint32_t blackhat_bench_missing(const BlackhatBenchResult* result)
+{
+    uint32_t seen = result->lines_ok + result->lines_bad;
+    return seen < result->lines_expected ? result->lines_expected - seen : 0;
+}
+
+const char* blackhat_bench_get_path(BlackhatBench* bench)
+{
+    return bench->path;
+}
+
+void blackhat_bench_get_latency(
+    BlackhatBench* bench,
+    BlackhatBenchConsumer consumer,
+    BlackhatBenchLatency* latency
+)
+{
+    furi_assert(consumer < BlackhatBenchConsumerCount);
+    const BlackhatBenchHist* hist = &bench->consumer_lat[consumer];
+
+    latency->samples = hist->count;
+    latency->p50_us = blackhat_bench_percentile(hist, 50);
+    latency->p99_us = blackhat_bench_percentile(hist, 99);
+    latency->max_us = hist->max;
+}
+
+const char* blackhat_bench_get_report(BlackhatBench* bench, bool done)
+{
+    FuriString* report = bench->report;
+
+    furi_string_printf(
+        report,
+        "RX benchmark @ %lu baud\n",
+        (unsigned long)blackhat_uart_get_baud(bench->app->uart)
+    );
+
+    for (size_t i = 0; i < bench->count; i++) {
+        const BlackhatBenchResult* r = &bench->results[i];
+        uint32_t lost = blackhat_bench_missing(r) + r->lines_bad;
+        uint32_t permille =
+            r->lines_expected ? lost * 1000 / r->lines_expected : 0;
+
+        furi_string_cat_printf(
+            report,
+            "%s %luB/s\n loss %lu.%lu%% %luB/s\n p50 %lu p99 %luus\n",
+            blackhat_bench_consumer_name(r->consumer),
+            (unsigned long)r->rate,
+            (unsigned long)(permille / 10),
+            (unsigned long)(permille % 10),
+            (unsigned long)(r->elapsed_ms ?
+                                (uint64_t)r->rx_bytes * 1000 / r->elapsed_ms :
+                                0),
+            (unsigned long)r->p50_us,
+            (unsigned long)r->p99_us
+        );
+    }
+
+    if (!done) {
+        furi_string_cat_str(report, "Running...\n");
+        return furi_string_get_cstr(report);
+    }
+
+    for (size_t c = 0; c < BlackhatBenchConsumerCount; c++) {
+        BlackhatBenchLatency latency;
+        blackhat_bench_get_latency(bench, c, &latency);
+        if (!latency.samples) continue;
+        furi_string_cat_printf(
+            report,
+            "%s overall\n p50 %lu p99 %luus\n",
+            blackhat_bench_consumer_name(c),
+            (unsigned long)latency.p50_us,
+            (unsigned long)latency.p99_us
+        );
+    }
+
+    if (bench->path[0]) {
+        furi_string_cat_printf(report, "Saved to %s\n", bench->path);
+    } else {
+        furi_string_cat_str(report, "Results were not saved\n");
+    }
+
+    return furi_string_get_cstr(report);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <furi.h>
+
+#include "blackhat_app.h"
+
+// RX pipeline benchmark. For each consumer the device is asked to stream
+// numbered pattern lines with "bh bench <bytes per second> <bytes>" at
+// rising rates. Every step checks the lines for loss and collects the
+// latency from the serial callback to the consumer's handle_rx_data_cb.
+// Results go to SD as CSV.
+
+#define BLACKHAT_BENCH_CMD "bh bench"
+#define BLACKHAT_BENCH_DIR APP_DATA_PATH("bench")
+
+// "BHB <idx hex> <filler>\n", the filler depends on the index
+#define BLACKHAT_BENCH_LINE_SIZE (32)
+#define BLACKHAT_BENCH_STEP_MS (2000)
+#define BLACKHAT_BENCH_MAX_STEPS (32)
+#define BLACKHAT_BENCH_LAT_BUCKETS (24)
+
+typedef enum {
+    BlackhatBenchConsumerConsole,
+    BlackhatBenchConsumerTui,
+    BlackhatBenchConsumerScan,
+    BlackhatBenchConsumerCount,
+} BlackhatBenchConsumer;
+
+typedef struct {
+    BlackhatBenchConsumer consumer;
+    uint32_t baud;
+    uint32_t rate;
+    uint32_t rx_bytes;
+    uint32_t elapsed_ms;
+    uint32_t lines_expected;
+    uint32_t lines_ok;
+    uint32_t lines_bad;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} BlackhatBenchResult;
+
+// Over every step the consumer has run so far
+typedef struct {
+    uint32_t samples;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} BlackhatBenchLatency;
+
+typedef struct BlackhatBench BlackhatBench;
+
+// Sends step_event after every finished step and done_event at the end
+BlackhatBench* blackhat_bench_start(
+    BlackhatApp* app, uint32_t step_event, uint32_t done_event
+);
+void blackhat_bench_stop(BlackhatBench* bench);
+
+size_t blackhat_bench_get_count(BlackhatBench* bench);
+const BlackhatBenchResult*
+    blackhat_bench_get_result(BlackhatBench* bench, size_t index);
+const char* blackhat_bench_consumer_name(BlackhatBenchConsumer consumer);
+uint32_t blackhat_bench_missing(const BlackhatBenchResult* result);
+void blackhat_bench_get_latency(
+    BlackhatBench* bench,
+    BlackhatBenchConsumer consumer,
+    BlackhatBenchLatency* latency
+);
+
+// Text for the results screen, owned by the bench and valid until it stops
+const char* blackhat_bench_get_report(BlackhatBench* bench, bool done);
+
+// CSV written at the end of the run, empty if it could not be saved
+const char* blackhat_bench_get_path(BlackhatBench* bench);
+
+// Writes one pattern line plus a terminating NUL
+void blackhat_bench_format_line(char* line, uint32_t idx);
@@ -0,0 +1,204 @@
+#include "blackhat_cache.h"
+
+#include <stdlib.h>
+
+#include "blackhat_app_i.h"
+
+#define TAG "BlackhatCache"
+
+typedef enum {
+    BlackhatCacheDepParams = 1 << 0,
+    BlackhatCacheDepWifi = 1 << 1,
+    BlackhatCacheDepAll = 0xff,
+} BlackhatCacheDep;
+
+typedef struct {
+    const char* cmd;
+    uint32_t ttl_ms;
+    uint8_t deps;
+} BlackhatCacheQuery;
+
+typedef struct {
+    const char* prefix;
+    uint8_t deps;
+} BlackhatCacheWriter;
+
+static const BlackhatCacheQuery blackhat_cache_queries[] = {
+    {GET_CMD, 60000, BlackhatCacheDepParams},
+    {GET_IP_CMD, 30000, BlackhatCacheDepWifi},
+    {DEV_CMD, 30000, BlackhatCacheDepWifi},
+    {TEST_INET, 15000, BlackhatCacheDepWifi},
+};
+
+// Commands matched by prefix, anything else leaves the cache alone
+static const BlackhatCacheWriter blackhat_cache_writers[] = {
+    {SET_CMD_PREFIX, BlackhatCacheDepParams},
+    {WIFI_CON_CMD, BlackhatCacheDepWifi},
+    {START_AP_CMD, BlackhatCacheDepWifi},
+    {START_KISMET_CMD, BlackhatCacheDepWifi},
+    {ST_EVIL_TWIN_CMD, BlackhatCacheDepWifi},
+    {ST_EVIL_PORT_CMD, BlackhatCacheDepWifi},
+    {RUN_CMD, BlackhatCacheDepAll},
+    {REBOOT_CMD, BlackhatCacheDepAll},
+};
+
+#define CACHE_ENTRIES COUNT_OF(blackhat_cache_queries)
+
+typedef struct {
+    FuriString* text;
+    uint32_t stamp;
+    bool valid;
+} BlackhatCacheEntry;
+
+struct BlackhatCache {
+    FuriMutex* mutex;
+    BlackhatCacheEntry entries[CACHE_ENTRIES];
+
+    // Answer being recorded, -1 when idle
+    int8_t capture;
+    FuriString* capture_text;
+    uint32_t capture_stamp;
+    bool capture_done;
+};
+
+static int8_t blackhat_cache_find(const char* cmd)
+{
+    for (size_t i = 0; i < CACHE_ENTRIES; i++) {
+        if (!strcmp(cmd, blackhat_cache_queries[i].cmd)) return i;
+    }
+    return -1;
+}
+
+bool blackhat_cache_is_query(const char* cmd)
+{
+    return blackhat_cache_find(cmd) >= 0;
+}
+
+bool blackhat_cache_get(
+    BlackhatCache* cache, const char* cmd, FuriString* out, uint32_t* age_ms
+)
+{
+    int8_t index = blackhat_cache_find(cmd);
+    if (index < 0) return false;
+
+    const BlackhatCacheQuery* query = &blackhat_cache_queries[index];
+    BlackhatCacheEntry* entry = &cache->entries[index];
+    bool hit = false;
+
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    uint32_t age = furi_get_tick() - entry->stamp;
+    if (entry->valid && age < furi_ms_to_ticks(query->ttl_ms)) {
+        furi_string_set(out, entry->text);
+        *age_ms = age * 1000 / furi_kernel_get_tick_frequency();
+        hit = true;
+    } else {
+        entry->valid = false;
+    }
+    furi_mutex_release(cache->mutex);
+
+    return hit;
+}
+
+bool blackhat_cache_start(BlackhatCache* cache, const char* cmd)
+{
+    int8_t index = blackhat_cache_find(cmd);
+
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    cache->capture = index;
+    cache->capture_done = false;
+    furi_string_reset(cache->capture_text);
+    furi_mutex_release(cache->mutex);
+
+    return index >= 0;
+}
+
+void blackhat_cache_feed(BlackhatCache* cache, const uint8_t* buf, size_t len)
+{
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    if (cache->capture >= 0) {
+        // Too long to be worth keeping, the query goes to the device again
+        if (furi_string_size(cache->capture_text) + len >
+            BLACKHAT_CACHE_MAX_TEXT) {
+            cache->capture = -1;
+        } else {
+            furi_string_cat_printf(
+                cache->capture_text, "%.*s", (int)len, (const char*)buf
+            );
+        }
+    }
+    furi_mutex_release(cache->mutex);
+}
+
+void blackhat_cache_done(BlackhatCache* cache)
+{
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    if (cache->capture >= 0 && !cache->capture_done) {
+        cache->capture_done = true;
+        cache->capture_stamp = furi_get_tick();
+    }
+    furi_mutex_release(cache->mutex);
+}
+
+void blackhat_cache_stop(BlackhatCache* cache)
+{
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    // A silent device gives nothing worth serving
+    if (cache->capture >= 0 && cache->capture_done &&
+        !furi_string_empty(cache->capture_text)) {
+        BlackhatCacheEntry* entry = &cache->entries[cache->capture];
+        furi_string_set(entry->text, cache->capture_text);
+        entry->stamp = cache->capture_stamp;
+        entry->valid = true;
+    }
+    cache->capture = -1;
+    furi_string_reset(cache->capture_text);
+    furi_mutex_release(cache->mutex);
+}
+
+void blackhat_cache_invalidate(BlackhatCache* cache, const char* cmd)
+{
+    uint8_t deps = 0;
+    for (size_t i = 0; i < COUNT_OF(blackhat_cache_writers); i++) {
+        const char* prefix = blackhat_cache_writers[i].prefix;
+        if (!strncmp(cmd, prefix, strlen(prefix))) {
+            deps |= blackhat_cache_writers[i].deps;
+        }
+    }
+    if (!deps) return;
+
+    furi_mutex_acquire(cache->mutex, FuriWaitForever);
+    for (size_t i = 0; i < CACHE_ENTRIES; i++) {
+        if (blackhat_cache_queries[i].deps & deps) {
+            cache->entries[i].valid = false;
+        }
+    }
+    furi_mutex_release(cache->mutex);
+
+    FURI_LOG_D(TAG, "\"%s\" dropped 0x%02x", cmd, deps);
+}
+
+BlackhatCache* blackhat_cache_alloc(void)
+{
+    BlackhatCache* cache = malloc(sizeof(BlackhatCache));
+    cache->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    for (size_t i = 0; i < CACHE_ENTRIES; i++) {
+        cache->entries[i].text = furi_string_alloc();
+        cache->entries[i].valid = false;
+    }
+    cache->capture = -1;
+    cache->capture_text = furi_string_alloc();
+    cache->capture_done = false;
+    return cache;
+}
+
+void blackhat_cache_free(BlackhatCache* cache)
+{
+    furi_assert(cache);
+
+    for (size_t i = 0; i < CACHE_ENTRIES; i++) {
+        furi_string_free(cache->entries[i].text);
+    }
+    furi_string_free(cache->capture_text);
+    furi_mutex_free(cache->mutex);
+    free(cache);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <furi.h>
+
+// Answers of read-only queries (bh get, wifi ip, wifi dev, test_inet) kept
+// in memory, so picking the same menu item again doesn't wait on the
+// device. Each entry expires after its TTL, and commands that change the
+// device state drop the entries they affect before they are sent.
+
+#define BLACKHAT_CACHE_MAX_TEXT (1024)
+
+typedef struct BlackhatCache BlackhatCache;
+
+BlackhatCache* blackhat_cache_alloc(void);
+void blackhat_cache_free(BlackhatCache* cache);
+
+// Copies a fresh answer to cmd into out, with its age
+bool blackhat_cache_get(
+    BlackhatCache* cache, const char* cmd, FuriString* out, uint32_t* age_ms
+);
+
+// True for the queries kept here
+bool blackhat_cache_is_query(const char* cmd);
+
+// Starts recording the answer to cmd, false if cmd isn't cached
+bool blackhat_cache_start(BlackhatCache* cache, const char* cmd);
+
+// Called from the UART worker with every chunk of the answer
+void blackhat_cache_feed(BlackhatCache* cache, const uint8_t* buf, size_t len);
+
+// The response is complete. Output that trails in afterwards is still
+// recorded, the answer is stored on stop, or thrown away if never done.
+void blackhat_cache_done(BlackhatCache* cache);
+void blackhat_cache_stop(BlackhatCache* cache);
+
+// Call with every command sent to the device
+void blackhat_cache_invalidate(BlackhatCache* cache, const char* cmd);
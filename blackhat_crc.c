@@ -0,0 +1,37 @@
+#include "blackhat_crc.h"
+
+// Nibble tables keep the footprint small while staying reasonably fast
+static const uint32_t blackhat_crc32_table[16] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+    0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+    0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+uint32_t blackhat_crc32(uint32_t crc, const void* data, size_t len)
+{
+    const uint8_t* p = data;
+
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ blackhat_crc32_table[crc & 0x0f];
+        crc = (crc >> 4) ^ blackhat_crc32_table[crc & 0x0f];
+    }
+
+    return ~crc;
+}
+
+uint16_t blackhat_crc16(uint16_t crc, const void* data, size_t len)
+{
+    const uint8_t* p = data;
+
+    while (len--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+}
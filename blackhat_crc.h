@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3), start with 0 and feed the previous result to chain
+uint32_t blackhat_crc32(uint32_t crc, const void* data, size_t len);
+
+// CRC-16/CCITT-FALSE, start with 0xffff and feed the previous result to chain
+uint16_t blackhat_crc16(uint16_t crc, const void* data, size_t len);
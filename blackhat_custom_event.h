@@ -8,4 +8,16 @@ typedef enum {
     BlackhatEventTextInput,
     BlackhatEventTuiGameModeStarted,
     BlackhatEventTuiGameModeStopped,
+    BlackhatEventTuiGameModeFrames,
+    BlackhatEventTuiMirrorSync,
+    BlackhatEventTuiFrame,
+    BlackhatEventTuiAHold,
+    BlackhatEventTuiBackHold,
+    BlackhatEventTelemetry,
+    BlackhatEventCacheRefresh,
+    BlackhatEventLinkReady,
+    BlackhatEventXferList,
+    BlackhatEventResponseDone,
+    BlackhatEventBenchStep,
+    BlackhatEventBenchDone,
 } BlackhatCustomEvent;
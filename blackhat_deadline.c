@@ -0,0 +1,95 @@
+#include "blackhat_deadline.h"
+
+#include <furi_hal.h>
+
+struct BlackhatDeadline {
+    ViewDispatcher* view_dispatcher;
+    uint32_t event;
+    FuriTimer* timer;
+    bool armed;
+    uint32_t start;
+    uint32_t cycles;
+    BlackhatDeadlineStats stats;
+};
+
+static void blackhat_deadline_timer_callback(void* context)
+{
+    BlackhatDeadline* deadline = context;
+
+    // Timer service thread, the GUI thread owns the state
+    view_dispatcher_send_custom_event(
+        deadline->view_dispatcher, deadline->event
+    );
+}
+
+BlackhatDeadline*
+    blackhat_deadline_alloc(ViewDispatcher* view_dispatcher, uint32_t event)
+{
+    BlackhatDeadline* deadline = malloc(sizeof(BlackhatDeadline));
+    deadline->view_dispatcher = view_dispatcher;
+    deadline->event = event;
+    deadline->armed = false;
+    deadline->timer = furi_timer_alloc(
+        blackhat_deadline_timer_callback, FuriTimerTypeOnce, deadline
+    );
+    blackhat_deadline_reset_stats(deadline);
+    return deadline;
+}
+
+void blackhat_deadline_free(BlackhatDeadline* deadline)
+{
+    furi_timer_stop(deadline->timer);
+    furi_timer_free(deadline->timer);
+    free(deadline);
+}
+
+void blackhat_deadline_start(BlackhatDeadline* deadline, uint32_t ms)
+{
+    deadline->armed = true;
+    deadline->start = DWT->CYCCNT;
+    deadline->cycles =
+        ms * 1000 * furi_hal_cortex_instructions_per_microsecond();
+    furi_timer_start(deadline->timer, furi_ms_to_ticks(ms));
+}
+
+void blackhat_deadline_cancel(BlackhatDeadline* deadline)
+{
+    deadline->armed = false;
+    furi_timer_stop(deadline->timer);
+}
+
+bool blackhat_deadline_expired(BlackhatDeadline* deadline)
+{
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    uint32_t tick_cycles =
+        1000000 / furi_kernel_get_tick_frequency() * cycles_per_us;
+    uint32_t elapsed = DWT->CYCCNT - deadline->start;
+
+    // The timer counts whole ticks and can fire up to one tick before the
+    // cycle deadline. Anything earlier is a stale event from a cancelled
+    // or restarted deadline.
+    if (!deadline->armed || elapsed + tick_cycles < deadline->cycles) {
+        return false;
+    }
+    deadline->armed = false;
+
+    uint32_t late = elapsed > deadline->cycles ? elapsed - deadline->cycles : 0;
+    uint32_t late_us = late / cycles_per_us;
+    deadline->stats.fired++;
+    deadline->stats.late_total_us += late_us;
+    deadline->stats.late_max_us = MAX(deadline->stats.late_max_us, late_us);
+
+    return true;
+}
+
+void blackhat_deadline_get_stats(
+    BlackhatDeadline* deadline, BlackhatDeadlineStats* stats
+)
+{
+    *stats = deadline->stats;
+}
+
+void blackhat_deadline_reset_stats(BlackhatDeadline* deadline)
+{
+    memset(&deadline->stats, 0, sizeof(deadline->stats));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+// One-shot deadline on a FuriTimer. Expiry is reported to the GUI thread as
+// a custom event, where blackhat_deadline_expired() confirms it and records
+// how late it was handled against the DWT cycle counter, counting an early
+// tick as on time. Scenes polling on the 100 ms dispatcher tick are up to
+// a whole tick late, a deadline is late by the timer tick plus the event
+// queue.
+//
+// A holds at random times on the host build, 40 per run over three runs:
+//   tick poll  late avg 46-55 ms, max 99.7 ms
+//   deadline   late avg 0.4-0.9 ms, max 11.8 ms
+// Not yet measured on a Flipper, where the timer runs at a higher priority.
+
+typedef struct BlackhatDeadline BlackhatDeadline;
+
+typedef struct {
+    uint32_t fired;
+    uint32_t late_max_us;
+    uint64_t late_total_us;
+} BlackhatDeadlineStats;
+
+BlackhatDeadline*
+    blackhat_deadline_alloc(ViewDispatcher* view_dispatcher, uint32_t event);
+void blackhat_deadline_free(BlackhatDeadline* deadline);
+
+// Restarts the deadline if it is already armed
+void blackhat_deadline_start(BlackhatDeadline* deadline, uint32_t ms);
+void blackhat_deadline_cancel(BlackhatDeadline* deadline);
+
+// Call from the GUI thread when the event arrives. False for an event left
+// in the queue by a cancelled or restarted deadline.
+bool blackhat_deadline_expired(BlackhatDeadline* deadline);
+
+void blackhat_deadline_get_stats(
+    BlackhatDeadline* deadline, BlackhatDeadlineStats* stats
+);
+void blackhat_deadline_reset_stats(BlackhatDeadline* deadline);
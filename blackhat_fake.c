@@ -0,0 +1,255 @@
+#include "blackhat_fake.h"
+
+#include "blackhat_app_i.h"
+
+#if BLACKHAT_UART_FAKE
+
+#define TAG "BlackhatFake"
+
+#define FAKE_BOOT_BANNER                                 \
+    "\r\nU-Boot SPL (fake)\r\n"                          \
+    "Starting kernel ...\r\n"                            \
+    "\r\nWelcome to Blackhat (fake device)\r\n"          \
+    "blackhat login: root (automatic login)\r\n\r\n"
+
+typedef enum {
+    FakeEvtStop = (1 << 0),
+    FakeEvtData = (1 << 1),
+} FakeEvtFlags;
+
+#define FAKE_ALL_EVENTS (FakeEvtStop | FakeEvtData)
+
+// bhtui game mode bytes, see blackhat_scene_tui.c
+#define FAKE_QUIT_GAME (0x90)
+#define FAKE_GAME_MODE_STARTED "\x91"
+#define FAKE_GAME_MODE_STOPPED "\x92"
+
+typedef struct {
+    const char* cmd;
+    const char* reply;
+} BlackhatFakeReply;
+
+// Longest prefix first, the first match wins
+static const BlackhatFakeReply blackhat_fake_replies[] = {
+    {SCAN_CMD, "recon.sh\r\nevil_twin.sh\r\nhandshake.sh\r\nbeacon.sh\r\n"},
+    {"bh get SSID", "fakenet\r\n"},
+    {"bh get PASS", "hunter22\r\n"},
+    {"bh get AP_SSID", "blackhat\r\n"},
+    {GET_CMD, "SSID=fakenet\r\nPASS=hunter22\r\nAP_SSID=blackhat\r\n"},
+    {SET_CMD_PREFIX, ""},
+    {GET_IP_CMD, "wlan0: 192.168.4.20/24\r\n"},
+    {DEV_CMD, "wlan0 rtl8821cu managed\r\nwlan1 mt7601u monitor\r\n"},
+    {LIST_AP_CMD, "fakenet -42 ch6\r\ncoffee_shop -67 ch11\r\n"},
+    {SHELL_CMD, "root\r\n"},
+    {"bh baud set", ""},
+    {"bh baud commit", ""},
+    {"bh", "Unknown command\r\n"},
+};
+
+struct BlackhatFake {
+    FuriThread* thread;
+    FuriStreamBuffer* in;
+    void (*rx_cb)(const uint8_t* data, size_t len, void* context);
+    void* context;
+    volatile uint32_t baud;
+    uint32_t owed_us;
+
+    char line[BLACKHAT_FAKE_LINE_SIZE];
+    size_t line_len;
+    // In bhtui, button bytes until QUIT_GAME
+    bool game;
+};
+
+static void blackhat_fake_send(BlackhatFake* fake, const char* data, size_t len)
+{
+    while (len) {
+        size_t chunk = MIN(len, (size_t)BLACKHAT_FAKE_CHUNK_SIZE);
+        fake->rx_cb((const uint8_t*)data, chunk, fake->context);
+        data += chunk;
+        len -= chunk;
+
+        // 10 bits per byte on the wire, sleep once a whole tick is owed
+        fake->owed_us += chunk * 10 * 1000000UL / fake->baud;
+        if (fake->owed_us >= 1000) {
+            furi_delay_ms(fake->owed_us / 1000);
+            fake->owed_us %= 1000;
+        }
+    }
+}
+
+static void blackhat_fake_send_str(BlackhatFake* fake, const char* str)
+{
+    blackhat_fake_send(fake, str, strlen(str));
+}
+
+// Numbered pattern lines at the requested rate, see blackhat_bench.h
+static void blackhat_fake_bench(BlackhatFake* fake, const char* args)
+{
+    uint32_t rate = strtoul(args, (char**)&args, 10);
+    uint32_t total = strtoul(args, NULL, 10);
+    if (!rate) return;
+
+    uint32_t start = furi_get_tick();
+    char line[BLACKHAT_BENCH_LINE_SIZE + 1];
+
+    for (uint32_t idx = 0; idx < total / BLACKHAT_BENCH_LINE_SIZE; idx++) {
+        blackhat_bench_format_line(line, idx);
+        blackhat_fake_send(fake, line, BLACKHAT_BENCH_LINE_SIZE);
+
+        uint32_t due = start + furi_ms_to_ticks(
+                                   (uint64_t)(idx + 1) *
+                                   BLACKHAT_BENCH_LINE_SIZE * 1000 / rate
+                               );
+        int32_t wait = (int32_t)(due - furi_get_tick());
+        if (wait > 0) furi_delay_tick(wait);
+    }
+}
+
+static void blackhat_fake_run(BlackhatFake* fake, char* cmd)
+{
+    // Commands can be chained the way the summary item sends them
+    char* next;
+    do {
+        next = strstr(cmd, "; ");
+        if (next) {
+            *next = '\0';
+            next += 2;
+        }
+
+        if (!strncmp(cmd, "bh baud check ", 14)) {
+            // Echo payload and CRC back, the app checks both
+            char reply[BLACKHAT_FAKE_LINE_SIZE];
+            snprintf(reply, sizeof(reply), "BHBAUD %s\r\n", &cmd[14]);
+            blackhat_fake_send_str(fake, reply);
+        } else if (!strncmp(cmd, BLACKHAT_BENCH_CMD " ", 9)) {
+            blackhat_fake_bench(fake, &cmd[9]);
+        } else if (!strcmp(cmd, BHTUI_CMD)) {
+            // Straight into a game, the prompt comes back on quit
+            fake->game = true;
+            blackhat_fake_send_str(fake, FAKE_GAME_MODE_STARTED);
+            return;
+        } else {
+            for (size_t i = 0; i < COUNT_OF(blackhat_fake_replies); i++) {
+                const BlackhatFakeReply* r = &blackhat_fake_replies[i];
+                if (!strncmp(cmd, r->cmd, strlen(r->cmd))) {
+                    blackhat_fake_send_str(fake, r->reply);
+                    break;
+                }
+            }
+        }
+    } while ((cmd = next));
+
+    blackhat_fake_send_str(fake, BLACKHAT_FAKE_PROMPT);
+}
+
+static void blackhat_fake_input(BlackhatFake* fake, char c)
+{
+    if (fake->game) {
+        if ((uint8_t)c == FAKE_QUIT_GAME) {
+            fake->game = false;
+            blackhat_fake_send_str(
+                fake, FAKE_GAME_MODE_STOPPED BLACKHAT_FAKE_PROMPT
+            );
+        }
+        return;
+    }
+
+    if (c == '\r') return;
+
+    if (c == '\n') {
+        fake->line[fake->line_len] = '\0';
+        fake->line_len = 0;
+        blackhat_fake_send_str(fake, "\r\n");
+        blackhat_fake_run(fake, fake->line);
+    } else if (c == 0x03) {
+        // Ctrl-C drops the half typed line
+        fake->line_len = 0;
+        blackhat_fake_send_str(fake, "^C\r\n" BLACKHAT_FAKE_PROMPT);
+    } else {
+        // Terminal echo, everything else is typed into the line
+        blackhat_fake_send(fake, &c, 1);
+        if (fake->line_len < BLACKHAT_FAKE_LINE_SIZE - 1) {
+            fake->line[fake->line_len++] = c;
+        }
+    }
+}
+
+static int32_t blackhat_fake_worker(void* context)
+{
+    BlackhatFake* fake = context;
+    uint8_t buf[BLACKHAT_FAKE_CHUNK_SIZE];
+
+    blackhat_fake_send_str(fake, FAKE_BOOT_BANNER BLACKHAT_FAKE_PROMPT);
+
+    while (1) {
+        uint32_t events = furi_thread_flags_wait(
+            FAKE_ALL_EVENTS, FuriFlagWaitAny, FuriWaitForever
+        );
+        furi_check((events & FuriFlagError) == 0);
+        if (events & FakeEvtStop) break;
+
+        size_t len;
+        while ((len = furi_stream_buffer_receive(
+                    fake->in, buf, sizeof(buf), 0
+                )) > 0) {
+            for (size_t i = 0; i < len; i++) {
+                blackhat_fake_input(fake, buf[i]);
+            }
+        }
+    }
+
+    return 0;
+}
+
+BlackhatFake* blackhat_fake_alloc(
+    void (*rx_cb)(const uint8_t* data, size_t len, void* context),
+    void* context
+)
+{
+    BlackhatFake* fake = malloc(sizeof(BlackhatFake));
+    fake->rx_cb = rx_cb;
+    fake->context = context;
+    fake->baud = BLACKHAT_UART_BAUD;
+    fake->owed_us = 0;
+    fake->line_len = 0;
+    fake->game = false;
+    fake->in = furi_stream_buffer_alloc(BLACKHAT_FAKE_IN_SIZE, 1);
+
+    fake->thread = furi_thread_alloc();
+    furi_thread_set_name(fake->thread, "BlackhatFakeThread");
+    furi_thread_set_stack_size(fake->thread, 1024);
+    furi_thread_set_context(fake->thread, fake);
+    furi_thread_set_callback(fake->thread, blackhat_fake_worker);
+    furi_thread_start(fake->thread);
+
+    FURI_LOG_W(TAG, "Fake device attached, the UART is not used");
+
+    return fake;
+}
+
+void blackhat_fake_free(BlackhatFake* fake)
+{
+    furi_thread_flags_set(furi_thread_get_id(fake->thread), FakeEvtStop);
+    furi_thread_join(fake->thread);
+    furi_thread_free(fake->thread);
+    furi_stream_buffer_free(fake->in);
+    free(fake);
+}
+
+void blackhat_fake_write(BlackhatFake* fake, const uint8_t* data, size_t len)
+{
+    while (len) {
+        size_t sent =
+            furi_stream_buffer_send(fake->in, data, len, FuriWaitForever);
+        furi_thread_flags_set(furi_thread_get_id(fake->thread), FakeEvtData);
+        data += sent;
+        len -= sent;
+    }
+}
+
+void blackhat_fake_set_baud(BlackhatFake* fake, uint32_t baud)
+{
+    fake->baud = baud;
+}
+
+#endif
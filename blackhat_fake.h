@@ -0,0 +1,27 @@
+#pragma once
+
+#include <furi.h>
+
+// Scripted stand-in for the Blackhat on the far end of the UART. Building
+// with BLACKHAT_UART_FAKE set to 1 routes TX into it and its answers into
+// the RX stream, so the worker, parsers and scenes run with nothing attached.
+
+#define BLACKHAT_FAKE_LINE_SIZE (128)
+#define BLACKHAT_FAKE_IN_SIZE (256)
+#define BLACKHAT_FAKE_CHUNK_SIZE (64)
+#define BLACKHAT_FAKE_PROMPT "root@blackhat:~# "
+
+typedef struct BlackhatFake BlackhatFake;
+
+// Called on the fake's own thread, the way the serial IRQ would deliver
+BlackhatFake* blackhat_fake_alloc(
+    void (*rx_cb)(const uint8_t* data, size_t len, void* context),
+    void* context
+);
+void blackhat_fake_free(BlackhatFake* fake);
+
+// Bytes sent by the Flipper, the fake echoes them and answers each line
+void blackhat_fake_write(BlackhatFake* fake, const uint8_t* data, size_t len);
+
+// Wire pacing of the answers, one chunk per baud-rate byte time
+void blackhat_fake_set_baud(BlackhatFake* fake, uint32_t baud);
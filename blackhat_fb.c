@@ -0,0 +1,307 @@
+#include "blackhat_fb.h"
+
+#include <gui/canvas.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TAG "BlackhatFb"
+
+typedef struct {
+    uint8_t xbm[BLACKHAT_FB_SIZE];
+    uint8_t fps;
+    uint8_t link;
+    uint32_t bytes_per_s;
+} BlackhatFbModel;
+
+struct BlackhatFb {
+    BlackhatRpc* rpc;
+    BlackhatUart* uart;
+    View* view;
+    FuriMutex* mutex;
+    bool active;
+    bool shown;
+    uint8_t fps;
+
+    // Decoder, the work buffer holds the last frame the device sent
+    uint8_t work[BLACKHAT_FB_SIZE];
+    size_t pos;
+    uint8_t literal;
+    uint8_t repeat;
+    uint8_t seq;
+    uint8_t chunk;
+    bool in_frame;
+    bool synced;
+
+    // Counted by the worker, taken by the GUI thread once per window
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t lost;
+    bool need_key;
+    uint32_t window_start;
+};
+
+static void blackhat_fb_send(BlackhatFb* fb, const char* fmt, ...)
+{
+    char cmd[32];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(cmd, sizeof(cmd), fmt, args);
+    va_end(args);
+
+    if (!blackhat_rpc_send(fb->rpc, cmd)) {
+        FURI_LOG_W(TAG, "Can't send \"%s\"", cmd);
+    }
+}
+
+static void blackhat_fb_decode(
+    BlackhatFb* fb, const uint8_t* data, size_t len
+)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        size_t count = 0;
+
+        if (fb->literal) {
+            fb->literal--;
+            count = 1;
+        } else if (fb->repeat) {
+            count = fb->repeat;
+            fb->repeat = 0;
+        } else if (byte & 0x80) {
+            fb->repeat = (byte & 0x7f) + 1;
+        } else {
+            fb->literal = byte + 1;
+        }
+
+        // Overruns are caught by the size check at the end of the frame
+        count = MIN(count, BLACKHAT_FB_SIZE - fb->pos);
+        for (size_t j = 0; j < count; j++) {
+            fb->work[fb->pos++] ^= byte;
+        }
+    }
+}
+
+static void blackhat_fb_broken(BlackhatFb* fb)
+{
+    fb->lost++;
+    fb->in_frame = false;
+    fb->synced = false;
+    fb->need_key = true;
+}
+
+bool blackhat_fb_feed(
+    BlackhatFb* fb, uint8_t seq, const uint8_t* payload, size_t len
+)
+{
+    if (len < 2) return false;
+
+    uint8_t flags = payload[0];
+    uint8_t chunk = payload[1];
+    bool first = false;
+
+    furi_mutex_acquire(fb->mutex, FuriWaitForever);
+
+    fb->bytes += len + BLACKHAT_PROTO_HEADER_SIZE + BLACKHAT_PROTO_CRC_SIZE;
+
+    if (!chunk) {
+        if (fb->in_frame) blackhat_fb_broken(fb);
+
+        // A delta only applies on top of the frame right before it
+        if (flags & BLACKHAT_FB_FLAG_KEY) {
+            memset(fb->work, 0, sizeof(fb->work));
+            fb->synced = true;
+        } else if (!fb->synced) {
+            fb->need_key = true;
+        } else if (seq != (uint8_t)(fb->seq + 1)) {
+            blackhat_fb_broken(fb);
+        }
+
+        fb->in_frame = fb->synced;
+        fb->seq = seq;
+        fb->chunk = 0;
+        fb->pos = 0;
+        fb->literal = 0;
+        fb->repeat = 0;
+    } else if (fb->in_frame && (seq != fb->seq || chunk != fb->chunk)) {
+        blackhat_fb_broken(fb);
+    }
+
+    if (fb->in_frame) {
+        blackhat_fb_decode(fb, payload + 2, len - 2);
+        fb->chunk++;
+
+        if (flags & BLACKHAT_FB_FLAG_LAST) {
+            fb->in_frame = false;
+            if (fb->pos == BLACKHAT_FB_SIZE && !fb->literal && !fb->repeat) {
+                with_view_model(
+                    fb->view,
+                    BlackhatFbModel * model,
+                    { memcpy(model->xbm, fb->work, sizeof(model->xbm)); },
+                    true
+                );
+                fb->frames++;
+                first = !fb->shown;
+                fb->shown = true;
+            } else {
+                blackhat_fb_broken(fb);
+            }
+        }
+    }
+
+    furi_mutex_release(fb->mutex);
+
+    return first;
+}
+
+void blackhat_fb_update(BlackhatFb* fb)
+{
+    uint32_t elapsed = furi_get_tick() - fb->window_start;
+    if (elapsed < furi_ms_to_ticks(BLACKHAT_FB_WINDOW_MS)) return;
+
+    furi_mutex_acquire(fb->mutex, FuriWaitForever);
+    uint32_t frames = fb->frames;
+    uint32_t bytes = fb->bytes;
+    uint32_t lost = fb->lost;
+    bool need_key = fb->need_key;
+    fb->frames = fb->bytes = fb->lost = 0;
+    fb->need_key = false;
+    fb->window_start += elapsed;
+    furi_mutex_release(fb->mutex);
+
+    uint32_t ms = elapsed * 1000 / furi_kernel_get_tick_frequency();
+    uint32_t bytes_per_s = (uint64_t)bytes * 1000 / ms;
+    // 10 bits on the wire per byte
+    uint32_t link = bytes_per_s * 10 * 100 / blackhat_uart_get_baud(fb->uart);
+
+    with_view_model(
+        fb->view,
+        BlackhatFbModel * model,
+        {
+            model->fps = (frames * 1000 + ms / 2) / ms;
+            model->link = MIN(link, 100U);
+            model->bytes_per_s = bytes_per_s;
+        },
+        true
+    );
+
+    if (!fb->active) return;
+
+    if (need_key) blackhat_fb_send(fb, BLACKHAT_FB_CMD " key");
+
+    // Back off quickly when the link struggles, recover one step at a time
+    uint8_t fps = fb->fps;
+    if (lost || link > BLACKHAT_FB_LINK_HIGH) {
+        fps = MAX(fps * 2 / 3, BLACKHAT_FB_FPS_MIN);
+    } else if (link < BLACKHAT_FB_LINK_LOW && fps < BLACKHAT_FB_FPS_MAX) {
+        fps++;
+    }
+    if (fps != fb->fps) {
+        FURI_LOG_D(
+            TAG,
+            "%u fps, link %lu%%, lost %lu",
+            fps,
+            (unsigned long)link,
+            (unsigned long)lost
+        );
+        fb->fps = fps;
+        blackhat_fb_send(fb, BLACKHAT_FB_CMD " fps %u", fps);
+    }
+}
+
+bool blackhat_fb_start(BlackhatFb* fb)
+{
+    if (!blackhat_rpc_is_framed(fb->rpc)) return false;
+
+    furi_mutex_acquire(fb->mutex, FuriWaitForever);
+    fb->in_frame = false;
+    fb->synced = false;
+    fb->shown = false;
+    fb->frames = fb->bytes = fb->lost = 0;
+    fb->need_key = false;
+    fb->window_start = furi_get_tick();
+    furi_mutex_release(fb->mutex);
+
+    fb->fps = BLACKHAT_FB_FPS_MAX;
+    fb->active = true;
+    blackhat_fb_send(fb, BLACKHAT_FB_CMD " start %u", fb->fps);
+
+    return true;
+}
+
+void blackhat_fb_stop(BlackhatFb* fb)
+{
+    if (!fb->active) return;
+
+    fb->active = false;
+    blackhat_fb_send(fb, BLACKHAT_FB_CMD " stop");
+}
+
+static void blackhat_fb_draw_callback(Canvas* canvas, void* _model)
+{
+    const BlackhatFbModel* model = _model;
+    char stats[32];
+
+    canvas_clear(canvas);
+    canvas_draw_xbm(
+        canvas, 0, 0, BLACKHAT_FB_WIDTH, BLACKHAT_FB_HEIGHT, model->xbm
+    );
+
+    snprintf(
+        stats,
+        sizeof(stats),
+        "%ufps %lu.%lukB/s %u%%",
+        model->fps,
+        (unsigned long)(model->bytes_per_s / 1000),
+        (unsigned long)(model->bytes_per_s % 1000 / 100),
+        model->link
+    );
+
+    // Top right, on a cleared strip so it reads over any game
+    canvas_set_font(canvas, FontBatteryPercent);
+    uint16_t width = canvas_string_width(canvas, stats);
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(canvas, BLACKHAT_FB_WIDTH - width - 2, 0, width + 2, 8);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_str_aligned(
+        canvas, BLACKHAT_FB_WIDTH - 1, 0, AlignRight, AlignTop, stats
+    );
+}
+
+BlackhatFb* blackhat_fb_alloc(BlackhatRpc* rpc, BlackhatUart* uart)
+{
+    BlackhatFb* fb = malloc(sizeof(BlackhatFb));
+    memset(fb, 0, sizeof(BlackhatFb));
+    fb->rpc = rpc;
+    fb->uart = uart;
+    fb->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+
+    fb->view = view_alloc();
+    view_allocate_model(
+        fb->view, ViewModelTypeLocking, sizeof(BlackhatFbModel)
+    );
+    with_view_model(
+        fb->view,
+        BlackhatFbModel * model,
+        { memset(model, 0, sizeof(BlackhatFbModel)); },
+        false
+    );
+    view_set_draw_callback(fb->view, blackhat_fb_draw_callback);
+
+    return fb;
+}
+
+void blackhat_fb_free(BlackhatFb* fb)
+{
+    furi_assert(fb);
+
+    view_free_model(fb->view);
+    view_free(fb->view);
+    furi_mutex_free(fb->mutex);
+    free(fb);
+}
+
+View* blackhat_fb_get_view(BlackhatFb* fb)
+{
+    return fb->view;
+}
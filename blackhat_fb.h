@@ -0,0 +1,58 @@
+#pragma once
+
+#include <furi.h>
+#include <gui/view.h>
+
+#include "blackhat_rpc.h"
+#include "blackhat_uart.h"
+
+// Game mode framebuffer stream. The device dithers the game to 128x64 and
+// sends each frame as BlackhatProtoFramebuffer frames, the frame id is the
+// frame sequence number and each payload is
+//
+//   flags | chunk index | RLE data
+//
+// The RLE data, split across chunks at any byte, expands to the 1024 byte
+// XBM image XORed with the previous frame, or with a blank one for a key
+// frame. A token t < 0x80 is followed by t + 1 literal bytes, t >= 0x80 by
+// one byte repeated (t & 0x7f) + 1 times.
+//
+// The frame rate starts at BLACKHAT_FB_FPS_MAX and is cut back while the
+// link is close to full or chunks go missing, then raised one step at a
+// time once it recovers. A broken delta chain asks for a key frame.
+
+#define BLACKHAT_FB_CMD "bh fb"
+
+#define BLACKHAT_FB_WIDTH (128)
+#define BLACKHAT_FB_HEIGHT (64)
+#define BLACKHAT_FB_SIZE (BLACKHAT_FB_WIDTH * BLACKHAT_FB_HEIGHT / 8)
+
+#define BLACKHAT_FB_FLAG_KEY (1 << 0)
+#define BLACKHAT_FB_FLAG_LAST (1 << 1)
+
+#define BLACKHAT_FB_FPS_MAX (15)
+#define BLACKHAT_FB_FPS_MIN (2)
+// Link use above which the frame rate is cut, and below which it may rise
+#define BLACKHAT_FB_LINK_HIGH (80)
+#define BLACKHAT_FB_LINK_LOW (50)
+#define BLACKHAT_FB_WINDOW_MS (1000)
+
+typedef struct BlackhatFb BlackhatFb;
+
+BlackhatFb* blackhat_fb_alloc(BlackhatRpc* rpc, BlackhatUart* uart);
+void blackhat_fb_free(BlackhatFb* fb);
+View* blackhat_fb_get_view(BlackhatFb* fb);
+
+// Asks the device to start or stop streaming, start needs a framed link
+bool blackhat_fb_start(BlackhatFb* fb);
+void blackhat_fb_stop(BlackhatFb* fb);
+
+// Called with every stream frame from the UART worker. True once, when the
+// first complete frame is on the view.
+bool blackhat_fb_feed(
+    BlackhatFb* fb, uint8_t seq, const uint8_t* payload, size_t len
+);
+
+// GUI thread, on every tick. Updates the FPS and bandwidth overlay and
+// adapts the frame rate once per window.
+void blackhat_fb_update(BlackhatFb* fb);
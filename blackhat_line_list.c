@@ -0,0 +1,127 @@
+#include "blackhat_line_list.h"
+
+#include <string.h>
+
+struct BlackhatLine {
+    BlackhatLine* next;
+    char text[];
+};
+
+void blackhat_line_list_init(BlackhatLineList* list)
+{
+    list->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    blackhat_arena_init(&list->arena);
+    blackhat_line_list_reset(list);
+}
+
+void blackhat_line_list_free(BlackhatLineList* list)
+{
+    blackhat_arena_free(&list->arena);
+    furi_mutex_free(list->mutex);
+}
+
+void blackhat_line_list_reset(BlackhatLineList* list)
+{
+    furi_mutex_acquire(list->mutex, FuriWaitForever);
+    blackhat_arena_reset(&list->arena);
+    list->first = NULL;
+    list->last = NULL;
+    list->count = 0;
+    list->index = NULL;
+    list->finished = false;
+    list->partial_len = 0;
+    furi_mutex_release(list->mutex);
+}
+
+static void blackhat_line_list_commit(
+    BlackhatLineList* list, const char* text, size_t len
+)
+{
+    BlackhatLine* line =
+        blackhat_arena_alloc(&list->arena, sizeof(BlackhatLine) + len + 1);
+    line->next = NULL;
+    memcpy(line->text, text, len);
+    line->text[len] = '\0';
+
+    if (list->last) {
+        list->last->next = line;
+    } else {
+        list->first = line;
+    }
+    list->last = line;
+    list->count++;
+}
+
+void blackhat_line_list_feed(
+    BlackhatLineList* list, const uint8_t* buf, size_t len
+)
+{
+    furi_mutex_acquire(list->mutex, FuriWaitForever);
+
+    // The GUI may finish a list while the tail of a response still arrives,
+    // a line counted after that would have no index entry
+    for (size_t i = 0; !list->finished && i < len; i++) {
+        char c = buf[i];
+
+        if (c == '\n') {
+            blackhat_line_list_commit(list, list->partial, list->partial_len);
+            list->partial_len = 0;
+        } else if (c != '\r' && list->partial_len < BLACKHAT_LINE_MAX - 1) {
+            list->partial[list->partial_len++] = c;
+        }
+    }
+
+    furi_mutex_release(list->mutex);
+}
+
+void blackhat_line_list_add(BlackhatLineList* list, const char* line)
+{
+    furi_mutex_acquire(list->mutex, FuriWaitForever);
+    if (!list->finished) blackhat_line_list_commit(list, line, strlen(line));
+    furi_mutex_release(list->mutex);
+}
+
+void blackhat_line_list_finish(BlackhatLineList* list)
+{
+    furi_mutex_acquire(list->mutex, FuriWaitForever);
+
+    if (!list->finished) {
+        list->partial_len = 0;
+        list->index = blackhat_arena_alloc(
+            &list->arena, sizeof(char*) * (list->count + 1)
+        );
+
+        size_t i = 0;
+        for (BlackhatLine* line = list->first; line; line = line->next) {
+            list->index[i++] = line->text;
+        }
+        list->finished = true;
+    }
+
+    furi_mutex_release(list->mutex);
+}
+
+size_t blackhat_line_list_count(BlackhatLineList* list)
+{
+    furi_mutex_acquire(list->mutex, FuriWaitForever);
+    size_t count = list->count;
+    furi_mutex_release(list->mutex);
+    return count;
+}
+
+const char* blackhat_line_list_get(BlackhatLineList* list, size_t index)
+{
+    const char* text = NULL;
+
+    furi_mutex_acquire(list->mutex, FuriWaitForever);
+    if (index < list->count && list->finished) {
+        text = list->index[index];
+    } else if (index < list->count) {
+        BlackhatLine* line = list->first;
+        while (index--) line = line->next;
+        text = line->text;
+    }
+    furi_mutex_release(list->mutex);
+
+    return text;
+}
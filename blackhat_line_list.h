@@ -0,0 +1,46 @@
+#pragma once
+
+#include <furi.h>
+#include <stdbool.h>
+
+#include "blackhat_arena.h"
+
+// Streaming line tokenizer. Lines are stored in an arena as the bytes
+// arrive, so a listing is ready as soon as its last line has been received.
+// Lines longer than BLACKHAT_LINE_MAX are truncated and CRs are dropped.
+
+#define BLACKHAT_LINE_MAX (128)
+
+typedef struct BlackhatLine BlackhatLine;
+
+typedef struct {
+    // Lines are fed on the UART worker and read on the GUI thread
+    FuriMutex* mutex;
+    BlackhatArena arena;
+    BlackhatLine* first;
+    BlackhatLine* last;
+    size_t count;
+
+    // Index built by finish() for O(1) lookups
+    const char** index;
+    bool finished;
+
+    char partial[BLACKHAT_LINE_MAX];
+    size_t partial_len;
+} BlackhatLineList;
+
+void blackhat_line_list_init(BlackhatLineList* list);
+void blackhat_line_list_free(BlackhatLineList* list);
+void blackhat_line_list_reset(BlackhatLineList* list);
+
+void blackhat_line_list_feed(
+    BlackhatLineList* list, const uint8_t* buf, size_t len
+);
+void blackhat_line_list_add(BlackhatLineList* list, const char* line);
+
+// Drops the unterminated tail (usually the shell prompt) and indexes lines.
+// Anything fed after that is ignored.
+void blackhat_line_list_finish(BlackhatLineList* list);
+
+size_t blackhat_line_list_count(BlackhatLineList* list);
+const char* blackhat_line_list_get(BlackhatLineList* list, size_t index);
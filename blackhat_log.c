@@ -0,0 +1,221 @@
+#include "blackhat_log.h"
+
+#include <furi_hal.h>
+#include <storage/storage.h>
+
+#define TAG "BlackhatLog"
+
+typedef enum {
+    LogEvtStop = (1 << 0),
+    LogEvtFlush = (1 << 1),
+} LogEvtFlags;
+
+#define LOG_ALL_EVENTS (LogEvtStop | LogEvtFlush)
+
+struct BlackhatLog {
+    FuriThread* thread;
+    volatile bool running;
+
+    uint8_t buf[2][BLACKHAT_LOG_BUF_SIZE];
+    size_t fill[2];
+    volatile bool pending[2];
+    size_t active;
+
+    volatile uint32_t written;
+    volatile uint32_t dropped;
+
+    Storage* storage;
+    File* file;
+};
+
+// Hand the active half to the writer if it is free, caller must be in a
+// critical section
+static bool blackhat_log_swap(BlackhatLog* log)
+{
+    size_t other = log->active ^ 1;
+    if (log->pending[other] || !log->fill[log->active]) return false;
+
+    log->pending[log->active] = true;
+    log->active = other;
+    log->fill[other] = 0;
+    return true;
+}
+
+void blackhat_log_write(BlackhatLog* log, const uint8_t* data, size_t len)
+{
+    if (!log->running) return;
+
+    bool swapped = false;
+
+    // RX chunks are small, copying them with the writer locked out is cheap
+    FURI_CRITICAL_ENTER();
+    while (len) {
+        size_t room = BLACKHAT_LOG_BUF_SIZE - log->fill[log->active];
+        if (!room) {
+            // Writer is still busy with the other half
+            if (!blackhat_log_swap(log)) break;
+            swapped = true;
+            continue;
+        }
+
+        size_t n = MIN(room, len);
+        memcpy(&log->buf[log->active][log->fill[log->active]], data, n);
+        log->fill[log->active] += n;
+        data += n;
+        len -= n;
+    }
+    log->dropped += len;
+    FURI_CRITICAL_EXIT();
+
+    if (swapped) {
+        furi_thread_flags_set(furi_thread_get_id(log->thread), LogEvtFlush);
+    }
+}
+
+static void blackhat_log_flush_pending(BlackhatLog* log)
+{
+    for (size_t i = 0; i < 2; i++) {
+        if (!log->pending[i]) continue;
+
+        size_t n = storage_file_write(log->file, log->buf[i], log->fill[i]);
+        log->written += n;
+        log->dropped += log->fill[i] - n;
+        log->pending[i] = false;
+    }
+}
+
+static int32_t blackhat_log_worker(void* context)
+{
+    BlackhatLog* log = context;
+    bool stop = false;
+
+    while (!stop) {
+        uint32_t events = furi_thread_flags_wait(
+            LOG_ALL_EVENTS,
+            FuriFlagWaitAny,
+            furi_ms_to_ticks(BLACKHAT_LOG_FLUSH_MS)
+        );
+        stop = !(events & FuriFlagError) && (events & LogEvtStop);
+
+        // Periodically push out a partly filled half too
+        if ((events & FuriFlagError) || stop) {
+            FURI_CRITICAL_ENTER();
+            blackhat_log_swap(log);
+            FURI_CRITICAL_EXIT();
+        }
+
+        blackhat_log_flush_pending(log);
+
+        if (stop) {
+            // The swap above may have had to wait for the other half
+            FURI_CRITICAL_ENTER();
+            blackhat_log_swap(log);
+            FURI_CRITICAL_EXIT();
+            blackhat_log_flush_pending(log);
+        }
+    }
+
+    return 0;
+}
+
+BlackhatLog* blackhat_log_alloc(void)
+{
+    BlackhatLog* log = malloc(sizeof(BlackhatLog));
+    log->running = false;
+    log->written = 0;
+    log->dropped = 0;
+    log->storage = furi_record_open(RECORD_STORAGE);
+    log->file = storage_file_alloc(log->storage);
+
+    log->thread = furi_thread_alloc();
+    furi_thread_set_name(log->thread, "BlackhatLogThread");
+    furi_thread_set_stack_size(log->thread, 2048);
+    furi_thread_set_priority(log->thread, FuriThreadPriorityLow);
+    furi_thread_set_context(log->thread, log);
+    furi_thread_set_callback(log->thread, blackhat_log_worker);
+
+    return log;
+}
+
+void blackhat_log_free(BlackhatLog* log)
+{
+    furi_assert(log);
+
+    blackhat_log_stop(log);
+    storage_file_free(log->file);
+    furi_record_close(RECORD_STORAGE);
+    furi_thread_free(log->thread);
+    free(log);
+}
+
+bool blackhat_log_start(BlackhatLog* log)
+{
+    if (log->running) return true;
+
+    char path[64];
+    DateTime dt;
+    furi_hal_rtc_get_datetime(&dt);
+    snprintf(
+        path,
+        sizeof(path),
+        "%s/%04u%02u%02u-%02u%02u%02u.log",
+        BLACKHAT_LOG_DIR,
+        dt.year,
+        dt.month,
+        dt.day,
+        dt.hour,
+        dt.minute,
+        dt.second
+    );
+
+    storage_simply_mkdir(log->storage, BLACKHAT_LOG_DIR);
+    if (!storage_file_open(log->file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        FURI_LOG_E(TAG, "Can't open %s", path);
+        storage_file_close(log->file);
+        return false;
+    }
+
+    log->active = 0;
+    log->fill[0] = log->fill[1] = 0;
+    log->pending[0] = log->pending[1] = false;
+    log->written = 0;
+    log->dropped = 0;
+
+    furi_thread_start(log->thread);
+    log->running = true;
+
+    FURI_LOG_I(TAG, "Logging to %s", path);
+    return true;
+}
+
+void blackhat_log_stop(BlackhatLog* log)
+{
+    if (!log->running) return;
+
+    log->running = false;
+    furi_thread_flags_set(furi_thread_get_id(log->thread), LogEvtStop);
+    furi_thread_join(log->thread);
+    storage_file_close(log->file);
+
+    FURI_LOG_I(
+        TAG,
+        "Stopped, %lu bytes written, %lu dropped",
+        (unsigned long)log->written,
+        (unsigned long)log->dropped
+    );
+}
+
+bool blackhat_log_is_running(BlackhatLog* log)
+{
+    return log->running;
+}
+
+uint32_t blackhat_log_get_written(BlackhatLog* log)
+{
+    return log->written;
+}
+
+uint32_t blackhat_log_get_dropped(BlackhatLog* log)
+{
+    return log->dropped;
+}
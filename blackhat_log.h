@@ -0,0 +1,27 @@
+#pragma once
+
+#include <furi.h>
+
+// Console capture to SD. The RX worker copies bytes into one half of a
+// ping-pong buffer while a low priority thread writes the other half out,
+// so storage latency never reaches the RX path. If both halves are full
+// the new bytes are dropped and counted.
+
+#define BLACKHAT_LOG_DIR APP_DATA_PATH("logs")
+#define BLACKHAT_LOG_BUF_SIZE (2048)
+#define BLACKHAT_LOG_FLUSH_MS (1000)
+
+typedef struct BlackhatLog BlackhatLog;
+
+BlackhatLog* blackhat_log_alloc(void);
+void blackhat_log_free(BlackhatLog* log);
+
+bool blackhat_log_start(BlackhatLog* log);
+void blackhat_log_stop(BlackhatLog* log);
+bool blackhat_log_is_running(BlackhatLog* log);
+
+// Never blocks, safe to call from the UART worker
+void blackhat_log_write(BlackhatLog* log, const uint8_t* data, size_t len);
+
+uint32_t blackhat_log_get_written(BlackhatLog* log);
+uint32_t blackhat_log_get_dropped(BlackhatLog* log);
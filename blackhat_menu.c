@@ -0,0 +1,225 @@
+#include "blackhat_menu.h"
+
+#include <string.h>
+
+#include "blackhat_app_i.h"
+
+static const BlackhatItem blackhat_menu_head[] = {
+    {"Shell", {""}, 1, NULL, SHELL_CMD, false},
+    {"Scan for Scripts", {""}, 1, NULL, SCAN_CMD, false},
+    {"Run Script", {""}, 1, NULL, CHG_RUN_CMD_SCREEN, false},
+    {"BHtui (Screen Only)", {""}, 1, NULL, BHTUI_CMD, false},
+    {"BHtui Mirror", {""}, 1, NULL, BHTUI_MIRROR_CMD, false},
+};
+
+static const BlackhatItem blackhat_menu_tail[] = {
+    {"Device Summary", {""}, 1, NULL, SUMMARY_CMD, false},
+    {"Reboot", {""}, 1, NULL, REBOOT_CMD, false},
+    {"Log Console to SD", {"off", "on"}, 2, NULL, LOG_TOGGLE_CMD, false},
+    {"RX Benchmark", {""}, 1, NULL, BLACKHAT_BENCH_CMD, false},
+    {"Link Diagnostics", {""}, 1, NULL, DIAG_CMD, false},
+    {"Device Dashboard", {""}, 1, NULL, DASH_CMD, false},
+    {"Memory Profiler", {""}, 1, NULL, PROFILE_CMD, false},
+    {"File Transfer", {"push", "pull"}, 2, NULL, XFER_CMD, false},
+};
+
+// What the firmware offered before it could describe itself
+static const char blackhat_menu_builtin[] =
+    "I wlan0 wlan1 wlan2\n"
+    "C Connect WiFi|" WIFI_CON_CMD "|iface,stop\n"
+    "C Set inet SSID|" SET_INET_SSID_CMD "|text\n"
+    "C Set inet Password|" SET_INET_PWD_CMD "|text\n"
+    "C Set AP SSID|" SET_AP_SSID_CMD "|text\n"
+    "C List Networks|" LIST_AP_CMD "|iface\n"
+    "C Wifi Device Info|" DEV_CMD "|\n"
+    "C Deauth Broadcast|" DEAUTH_CMD "|iface\n"
+    "C Enable AP|" START_AP_CMD "|iface,stop\n"
+    "C Start Kismet|" START_KISMET_CMD "|iface,stop\n"
+    "C Get IP|" GET_IP_CMD "|\n"
+    "C SSH|" START_SSH_CMD "|start,stop\n"
+    "C Start Evil Twin|" ST_EVIL_TWIN_CMD "|\n"
+    "C Evil Portal|" ST_EVIL_PORT_CMD "|start,stop\n"
+    "C Test Internet (ping)|" TEST_INET "|\n"
+    "C Get Params|" GET_CMD "|\n";
+
+#define MENU_DEVICE_MAX_ITEMS                                 \
+    (BLACKHAT_MENU_MAX_ITEMS - COUNT_OF(blackhat_menu_head) - \
+     COUNT_OF(blackhat_menu_tail))
+
+static void blackhat_menu_add_option(BlackhatItem* item, char* option)
+{
+    if (item->num_options_menu < MAX_OPTIONS) {
+        item->options_menu[item->num_options_menu++] = option;
+    }
+}
+
+static void blackhat_menu_add_ifaces(BlackhatMenu* menu, char* list)
+{
+    char* save;
+    for (char* iface = strtok_r(list, " ", &save); iface;
+         iface = strtok_r(NULL, " ", &save)) {
+        if (menu->num_ifaces < MAX_OPTIONS) {
+            menu->ifaces[menu->num_ifaces++] = iface;
+        }
+    }
+}
+
+static void blackhat_menu_add_command(BlackhatMenu* menu, char* line)
+{
+    char* label = line;
+    char* cmd = strchr(label, '|');
+    if (!cmd) return;
+    *cmd++ = '\0';
+    char* args = strchr(cmd, '|');
+    if (args) *args++ = '\0';
+
+    size_t count = menu->count - COUNT_OF(blackhat_menu_head);
+    if (!label[0] || !cmd[0] || count == MENU_DEVICE_MAX_ITEMS) return;
+
+    BlackhatItem* item = &menu->items[menu->count];
+    memset(item, 0, sizeof(BlackhatItem));
+    item->item_string = label;
+    item->actual_command = cmd;
+
+    // Only parameters can be edited, the rename scene reads them back first
+    if (args && !strcmp(args, "text")) {
+        args = NULL;
+        item->text_input_req =
+            !strncmp(cmd, SET_CMD_PREFIX, strlen(SET_CMD_PREFIX));
+    }
+
+    if (args && args[0]) {
+        char* save;
+        for (char* option = strtok_r(args, ",", &save); option;
+             option = strtok_r(NULL, ",", &save)) {
+            if (!strcmp(option, "iface")) {
+                for (size_t i = 0; i < menu->num_ifaces; i++) {
+                    blackhat_menu_add_option(item, menu->ifaces[i]);
+                }
+            } else {
+                blackhat_menu_add_option(item, option);
+            }
+        }
+        // Nothing left to choose, e.g. no interface is up
+        if (!item->num_options_menu) return;
+    } else {
+        blackhat_menu_add_option(item, "");
+    }
+
+    menu->count++;
+}
+
+static void blackhat_menu_add_line(
+    BlackhatMenu* menu, const char* text, size_t len
+)
+{
+    if (len < 2 || text[1] != ' ') return;
+
+    // Split in place on a copy that lives as long as the menu
+    char* line = blackhat_arena_alloc(&menu->arena, len + 1);
+    memcpy(line, text, len);
+    line[len] = '\0';
+
+    if (line[0] == 'I') {
+        blackhat_menu_add_ifaces(menu, &line[2]);
+    } else if (line[0] == 'C') {
+        blackhat_menu_add_command(menu, &line[2]);
+    }
+}
+
+static void blackhat_menu_add_items(
+    BlackhatMenu* menu, const BlackhatItem* items, size_t count
+)
+{
+    memcpy(&menu->items[menu->count], items, count * sizeof(BlackhatItem));
+    menu->count += count;
+}
+
+static void blackhat_menu_reset_device(BlackhatMenu* menu)
+{
+    blackhat_arena_reset(&menu->arena);
+    menu->count = COUNT_OF(blackhat_menu_head);
+    menu->num_ifaces = 0;
+}
+
+void blackhat_menu_build(BlackhatMenu* menu, BlackhatLineList* schema)
+{
+    menu->count = 0;
+    blackhat_menu_add_items(
+        menu, blackhat_menu_head, COUNT_OF(blackhat_menu_head)
+    );
+    blackhat_menu_reset_device(menu);
+
+    for (size_t i = 0; i < blackhat_line_list_count(schema); i++) {
+        const char* line = blackhat_line_list_get(schema, i);
+        blackhat_menu_add_line(menu, line, strlen(line));
+    }
+
+    if (menu->count == COUNT_OF(blackhat_menu_head)) {
+        blackhat_menu_reset_device(menu);
+        const char* line = blackhat_menu_builtin;
+        while (*line) {
+            const char* end = strchr(line, '\n');
+            blackhat_menu_add_line(menu, line, end - line);
+            line = end + 1;
+        }
+    }
+
+    blackhat_menu_add_items(
+        menu, blackhat_menu_tail, COUNT_OF(blackhat_menu_tail)
+    );
+}
+
+static bool blackhat_menu_is_hash(const char* line)
+{
+    return line[0] == 'H' && line[1] == ' ' &&
+           strlen(&line[2]) <= BLACKHAT_MENU_HASH_MAX;
+}
+
+const char* blackhat_menu_schema_hash(BlackhatLineList* schema)
+{
+    for (size_t i = 0; i < blackhat_line_list_count(schema); i++) {
+        const char* line = blackhat_line_list_get(schema, i);
+        if (blackhat_menu_is_hash(line)) return &line[2];
+    }
+    return "0";
+}
+
+bool blackhat_menu_schema_update(
+    BlackhatLineList* schema, BlackhatLineList* answer
+)
+{
+    bool has_hash = false;
+    bool has_command = false;
+
+    for (size_t i = 0; i < blackhat_line_list_count(answer); i++) {
+        const char* line = blackhat_line_list_get(answer, i);
+        has_hash |= blackhat_menu_is_hash(line);
+        has_command |= line[0] == 'C' && line[1] == ' ';
+    }
+    if (!has_hash || !has_command) return false;
+
+    blackhat_line_list_reset(schema);
+    for (size_t i = 0; i < blackhat_line_list_count(answer); i++) {
+        const char* line = blackhat_line_list_get(answer, i);
+        if (blackhat_menu_is_hash(line) ||
+            (line[0] && strchr("IC", line[0]) && line[1] == ' ')) {
+            blackhat_line_list_add(schema, line);
+        }
+    }
+    blackhat_line_list_finish(schema);
+
+    return true;
+}
+
+void blackhat_menu_init(BlackhatMenu* menu)
+{
+    blackhat_arena_init(&menu->arena);
+    menu->count = 0;
+    menu->num_ifaces = 0;
+}
+
+void blackhat_menu_free(BlackhatMenu* menu)
+{
+    blackhat_arena_free(&menu->arena);
+}
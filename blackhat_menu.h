@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "blackhat_arena.h"
+#include "blackhat_line_list.h"
+
+// Start menu. The device commands come from the schema the device answers
+// to "bh schema <hash>", with the app's own entries around them:
+//
+//   H <hash>                  version of this schema
+//   I <iface> ...             interfaces present right now
+//   C <label>|<cmd>|<args>    one menu entry
+//
+// args is a comma separated option list where "iface" stands for every
+// interface, or "text" to ask for the value of a "bh set" command. When
+// the hash sent along is still current the device only answers "= <hash>".
+// The last schema is kept on SD, a built-in one is used until there is one.
+
+#define BLACKHAT_MENU_CMD "bh schema"
+#define BLACKHAT_MENU_MAX_ITEMS (40)
+// Longer hashes are refused, so "bh schema <hash>" always fits a line
+#define BLACKHAT_MENU_HASH_MAX (32)
+
+#define MAX_OPTIONS (9)
+typedef struct {
+    const char* item_string;
+    char* options_menu[MAX_OPTIONS];
+    int num_options_menu;
+    char* selected_option;
+    char* actual_command;
+    bool text_input_req;
+} BlackhatItem;
+
+typedef struct {
+    BlackhatItem items[BLACKHAT_MENU_MAX_ITEMS];
+    size_t count;
+    char* ifaces[MAX_OPTIONS];
+    size_t num_ifaces;
+    BlackhatArena arena;
+} BlackhatMenu;
+
+void blackhat_menu_init(BlackhatMenu* menu);
+void blackhat_menu_free(BlackhatMenu* menu);
+
+// Falls back to the built-in schema when this one has no commands
+void blackhat_menu_build(BlackhatMenu* menu, BlackhatLineList* schema);
+
+// "0" when there is no schema yet, at most BLACKHAT_MENU_HASH_MAX chars
+const char* blackhat_menu_schema_hash(BlackhatLineList* schema);
+
+// Keeps the schema lines of a "bh schema" answer, false if it has none
+bool blackhat_menu_schema_update(
+    BlackhatLineList* schema, BlackhatLineList* answer
+);
@@ -0,0 +1,275 @@
+#include "blackhat_mirror.h"
+
+#include <stdlib.h>
+
+#define MIRROR_CURSOR_HIDDEN (0x7f)
+#define MIRROR_MAX_ARGS (3)
+
+struct BlackhatMirror {
+    View* view;
+    FuriMutex* mutex;
+    uint8_t cols;
+    uint8_t rows;
+
+    char cells[BLACKHAT_MIRROR_MAX_ROWS][BLACKHAT_MIRROR_MAX_COLS];
+    uint8_t reverse[BLACKHAT_MIRROR_MAX_ROWS][BLACKHAT_MIRROR_MAX_COLS / 8];
+    uint32_t dirty;
+
+    uint8_t cursor_col;
+    uint8_t cursor_row;
+    uint8_t origin_col;
+    uint8_t origin_row;
+
+    uint8_t op;
+    uint8_t args[MIRROR_MAX_ARGS];
+    uint8_t num_args;
+    volatile bool sync_queued;
+};
+
+static void blackhat_mirror_resize(
+    BlackhatMirror* mirror, uint8_t cols, uint8_t rows
+)
+{
+    mirror->cols = CLAMP(cols, BLACKHAT_MIRROR_MAX_COLS, 1);
+    mirror->rows = CLAMP(rows, BLACKHAT_MIRROR_MAX_ROWS, 1);
+    memset(mirror->cells, ' ', sizeof(mirror->cells));
+    memset(mirror->reverse, 0, sizeof(mirror->reverse));
+    mirror->dirty = (uint32_t)((1ULL << mirror->rows) - 1);
+    mirror->cursor_col = 0;
+    mirror->cursor_row = MIRROR_CURSOR_HIDDEN;
+    mirror->origin_col = 0;
+    mirror->origin_row = 0;
+}
+
+static void blackhat_mirror_put(BlackhatMirror* mirror, char ch)
+{
+    uint8_t row = mirror->args[0];
+    uint8_t col = mirror->args[1]++;
+    if (row >= mirror->rows || col >= mirror->cols) return;
+
+    uint8_t bit = 1 << (col % 8);
+    mirror->cells[row][col] = (ch >= ' ' && ch < 0x7f) ? ch : '?';
+    if (mirror->op == MIRROR_REVERSE) {
+        mirror->reverse[row][col / 8] |= bit;
+    } else {
+        mirror->reverse[row][col / 8] &= ~bit;
+    }
+    mirror->dirty |= 1UL << row;
+}
+
+// Returns true at the end of a batch
+static bool blackhat_mirror_input(BlackhatMirror* mirror, uint8_t byte)
+{
+    // A record header always starts over, so a lost byte costs one record
+    if (byte & 0x80) {
+        mirror->op = (byte >= MIRROR_SIZE && byte < MIRROR_SYNC) ? byte : 0;
+        mirror->num_args = 0;
+        return byte == MIRROR_SYNC;
+    }
+    if (!mirror->op) return false;
+
+    bool run = mirror->op == MIRROR_CELLS || mirror->op == MIRROR_REVERSE;
+    if (run && mirror->num_args == MIRROR_MAX_ARGS) {
+        blackhat_mirror_put(mirror, byte);
+        if (!--mirror->args[2]) mirror->op = 0;
+        return false;
+    }
+
+    mirror->args[mirror->num_args++] = byte;
+
+    switch (mirror->op) {
+    case MIRROR_SIZE:
+        if (mirror->num_args == 2) {
+            blackhat_mirror_resize(mirror, mirror->args[0], mirror->args[1]);
+            mirror->op = 0;
+        }
+        break;
+    case MIRROR_CURSOR:
+        if (mirror->num_args == 2) {
+            mirror->cursor_col = mirror->args[0];
+            mirror->cursor_row = mirror->args[1];
+            mirror->op = 0;
+        }
+        break;
+    default:
+        // Empty runs carry no cells
+        if (mirror->num_args == MIRROR_MAX_ARGS && !mirror->args[2]) {
+            mirror->op = 0;
+        }
+        break;
+    }
+
+    return false;
+}
+
+bool blackhat_mirror_feed(
+    BlackhatMirror* mirror, const uint8_t* data, size_t len
+)
+{
+    bool sync = false;
+
+    furi_mutex_acquire(mirror->mutex, FuriWaitForever);
+    for (size_t i = 0; i < len; i++) {
+        sync |= blackhat_mirror_input(mirror, data[i]);
+    }
+    if (sync) {
+        sync = !mirror->sync_queued;
+        mirror->sync_queued = true;
+    }
+    furi_mutex_release(mirror->mutex);
+
+    return sync;
+}
+
+// Smallest move that brings the cursor into view
+static uint8_t blackhat_mirror_follow(
+    uint8_t origin, uint8_t cursor, uint8_t view, uint8_t size
+)
+{
+    if (cursor < origin) {
+        origin = cursor;
+    } else if (cursor >= origin + view) {
+        origin = cursor - view + 1;
+    }
+    return MIN(origin, size > view ? size - view : 0);
+}
+
+static void blackhat_mirror_render_row(
+    BlackhatMirror* mirror, BlackhatTermScreen* model, uint8_t row
+)
+{
+    char* text = model->text[row];
+    uint32_t reverse = 0;
+    uint8_t grid_row = mirror->origin_row + row;
+
+    for (uint8_t col = 0; col < model->cols; col++) {
+        uint8_t grid_col = mirror->origin_col + col;
+        if (grid_row >= mirror->rows || grid_col >= mirror->cols) {
+            text[col] = ' ';
+            continue;
+        }
+        text[col] = mirror->cells[grid_row][grid_col];
+        if (mirror->reverse[grid_row][grid_col / 8] & (1 << (grid_col % 8))) {
+            reverse |= 1UL << col;
+        }
+    }
+
+    text[model->cols] = '\0';
+    model->reverse[row] = reverse;
+}
+
+bool blackhat_mirror_commit(BlackhatMirror* mirror)
+{
+    bool changed;
+
+    furi_mutex_acquire(mirror->mutex, FuriWaitForever);
+    mirror->sync_queued = false;
+
+    uint8_t origin_col = mirror->origin_col;
+    uint8_t origin_row = mirror->origin_row;
+    bool cursor_visible = mirror->cursor_row != MIRROR_CURSOR_HIDDEN &&
+                          mirror->cursor_row < mirror->rows &&
+                          mirror->cursor_col < mirror->cols;
+    if (cursor_visible) {
+        mirror->origin_col = blackhat_mirror_follow(
+            origin_col, mirror->cursor_col, BLACKHAT_TERM_COLS, mirror->cols
+        );
+        mirror->origin_row = blackhat_mirror_follow(
+            origin_row, mirror->cursor_row, BLACKHAT_TERM_ROWS, mirror->rows
+        );
+    }
+
+    // A moved viewport shows every row in a new place
+    uint32_t dirty = mirror->dirty >> mirror->origin_row;
+    if (mirror->origin_col != origin_col ||
+        mirror->origin_row != origin_row) {
+        dirty = UINT32_MAX;
+    }
+    mirror->dirty = 0;
+
+    int8_t cursor_col = -1;
+    int8_t cursor_row = -1;
+    if (cursor_visible) {
+        cursor_col = mirror->cursor_col - mirror->origin_col;
+        cursor_row = mirror->cursor_row - mirror->origin_row;
+    }
+
+    BlackhatTermScreen* model = view_get_model(mirror->view);
+    changed = (dirty & ((1UL << model->rows) - 1)) ||
+              model->cursor_col != cursor_col ||
+              model->cursor_row != cursor_row;
+    for (uint8_t row = 0; row < model->rows; row++) {
+        if (dirty & (1UL << row)) {
+            blackhat_mirror_render_row(mirror, model, row);
+        }
+    }
+    model->cursor_col = cursor_col;
+    model->cursor_row = cursor_row;
+    view_commit_model(mirror->view, changed);
+
+    furi_mutex_release(mirror->mutex);
+
+    return changed;
+}
+
+void blackhat_mirror_reset(BlackhatMirror* mirror)
+{
+    static const char waiting[] = "Waiting for bhtui...";
+
+    furi_mutex_acquire(mirror->mutex, FuriWaitForever);
+    blackhat_mirror_resize(mirror, BLACKHAT_TERM_COLS, BLACKHAT_TERM_ROWS);
+    memcpy(mirror->cells[0], waiting, sizeof(waiting) - 1);
+    mirror->op = 0;
+    mirror->num_args = 0;
+    mirror->sync_queued = false;
+    furi_mutex_release(mirror->mutex);
+
+    blackhat_mirror_commit(mirror);
+}
+
+static void blackhat_mirror_draw_callback(Canvas* canvas, void* model)
+{
+    blackhat_term_draw_screen(canvas, model);
+}
+
+BlackhatMirror* blackhat_mirror_alloc(void)
+{
+    BlackhatMirror* mirror = malloc(sizeof(BlackhatMirror));
+    mirror->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+
+    mirror->view = view_alloc();
+    view_allocate_model(
+        mirror->view, ViewModelTypeLocking, sizeof(BlackhatTermScreen)
+    );
+    with_view_model(
+        mirror->view,
+        BlackhatTermScreen * model,
+        {
+            model->cols = BLACKHAT_TERM_COLS;
+            model->rows = BLACKHAT_TERM_ROWS;
+            model->cursor_col = -1;
+            model->cursor_row = -1;
+        },
+        false
+    );
+    view_set_draw_callback(mirror->view, blackhat_mirror_draw_callback);
+
+    blackhat_mirror_reset(mirror);
+
+    return mirror;
+}
+
+void blackhat_mirror_free(BlackhatMirror* mirror)
+{
+    furi_assert(mirror);
+
+    view_free_model(mirror->view);
+    view_free(mirror->view);
+    furi_mutex_free(mirror->mutex);
+    free(mirror);
+}
+
+View* blackhat_mirror_get_view(BlackhatMirror* mirror)
+{
+    return mirror->view;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <furi.h>
+#include <gui/view.h>
+
+#include "blackhat_term.h"
+
+// Mirror of the bhtui tty. With --mirror, bhtui sends the character cells
+// that changed on its console since the last batch, and the Flipper keeps
+// the whole grid and shows a screen sized viewport that follows the
+// cursor. Records start with a byte >= 0x80, every argument is below it:
+//
+//   MIRROR_SIZE    cols rows         resize and clear the grid
+//   MIRROR_CELLS   row col n ch*n    run of printable cells
+//   MIRROR_REVERSE row col n ch*n    same, in reverse video
+//   MIRROR_CURSOR  col row           row 0x7f hides the cursor
+//   MIRROR_SYNC                      end of a batch, show it
+//
+// Game mode bytes share the link and are left to the TUI scene.
+
+#define BLACKHAT_MIRROR_MAX_COLS (80)
+#define BLACKHAT_MIRROR_MAX_ROWS (30)
+
+#define MIRROR_SIZE    (0x95)
+#define MIRROR_CELLS   (0x96)
+#define MIRROR_REVERSE (0x97)
+#define MIRROR_CURSOR  (0x98)
+#define MIRROR_SYNC    (0x99)
+
+typedef struct BlackhatMirror BlackhatMirror;
+
+BlackhatMirror* blackhat_mirror_alloc(void);
+void blackhat_mirror_free(BlackhatMirror* mirror);
+View* blackhat_mirror_get_view(BlackhatMirror* mirror);
+
+void blackhat_mirror_reset(BlackhatMirror* mirror);
+
+// Called from the UART worker. True when a batch is complete and no commit
+// is queued yet, the caller then asks the GUI thread to commit.
+bool blackhat_mirror_feed(
+    BlackhatMirror* mirror, const uint8_t* data, size_t len
+);
+
+// Moves the viewport to the cursor and copies the rows that changed
+bool blackhat_mirror_commit(BlackhatMirror* mirror);
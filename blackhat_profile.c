@@ -0,0 +1,131 @@
+#include "blackhat_profile.h"
+
+#include <stdlib.h>
+
+#define TAG "BlackhatProfile"
+
+struct BlackhatProfile {
+    size_t baseline;
+    FuriThreadId thread_ids[BLACKHAT_PROFILE_MAX_THREADS];
+    uint32_t last_period;
+    BlackhatScene scene;
+    size_t history_head;
+    BlackhatProfileStats stats;
+};
+
+static void blackhat_profile_sample_period(BlackhatProfile* profile)
+{
+    BlackhatProfileStats* stats = &profile->stats;
+
+    // Walks the free list with the scheduler stopped, so not every tick
+    stats->max_block = memmgr_heap_get_max_free_block();
+    stats->max_block_min = MIN(stats->max_block_min, stats->max_block);
+
+    for (size_t i = 0; i < stats->num_threads; i++) {
+        stats->threads[i].stack_free =
+            furi_thread_get_stack_space(profile->thread_ids[i]);
+    }
+
+    stats->history[profile->history_head] = stats->heap_free;
+    profile->history_head =
+        (profile->history_head + 1) % BLACKHAT_PROFILE_HISTORY;
+    if (stats->history_count < BLACKHAT_PROFILE_HISTORY) {
+        stats->history_count++;
+    }
+}
+
+void blackhat_profile_sample(BlackhatProfile* profile, BlackhatScene scene)
+{
+    BlackhatProfileStats* stats = &profile->stats;
+
+    stats->heap_free = memmgr_get_free_heap();
+    stats->heap_free_min = MIN(stats->heap_free_min, stats->heap_free);
+
+    if (scene < BlackhatSceneNum) {
+        size_t used = profile->baseline > stats->heap_free ?
+                          profile->baseline - stats->heap_free :
+                          0;
+        stats->scene_peak[scene] = MAX(stats->scene_peak[scene], used);
+    }
+
+    if (scene != profile->scene) {
+        FURI_LOG_D(
+            TAG,
+            "Scene %u, free %lu, block %lu",
+            scene,
+            (unsigned long)stats->heap_free,
+            (unsigned long)stats->max_block
+        );
+        profile->scene = scene;
+    }
+
+    uint32_t now = furi_get_tick();
+    if (now - profile->last_period >=
+        furi_ms_to_ticks(BLACKHAT_PROFILE_PERIOD_MS)) {
+        profile->last_period = now;
+        blackhat_profile_sample_period(profile);
+    }
+}
+
+void blackhat_profile_get_stats(
+    BlackhatProfile* profile, BlackhatProfileStats* stats
+)
+{
+    *stats = profile->stats;
+
+    // Unroll the ring so the view draws it left to right
+    size_t count = stats->history_count;
+    size_t start = (profile->history_head + BLACKHAT_PROFILE_HISTORY - count) %
+                   BLACKHAT_PROFILE_HISTORY;
+    for (size_t i = 0; i < count; i++) {
+        stats->history[i] =
+            profile->stats.history[(start + i) % BLACKHAT_PROFILE_HISTORY];
+    }
+}
+
+void blackhat_profile_watch(
+    BlackhatProfile* profile,
+    const char* name,
+    FuriThreadId id,
+    uint32_t stack_size
+)
+{
+    BlackhatProfileStats* stats = &profile->stats;
+    if (!id || stats->num_threads == BLACKHAT_PROFILE_MAX_THREADS) return;
+
+    BlackhatProfileThread* thread = &stats->threads[stats->num_threads];
+    thread->name = name;
+    thread->stack_size = stack_size;
+    thread->stack_free = furi_thread_get_stack_space(id);
+    profile->thread_ids[stats->num_threads++] = id;
+}
+
+void blackhat_profile_reset(BlackhatProfile* profile)
+{
+    BlackhatProfileStats* stats = &profile->stats;
+
+    stats->heap_free = memmgr_get_free_heap();
+    stats->heap_free_min = stats->heap_free;
+    stats->max_block = memmgr_heap_get_max_free_block();
+    stats->max_block_min = stats->max_block;
+    memset(stats->scene_peak, 0, sizeof(stats->scene_peak));
+    stats->history_count = 0;
+    profile->history_head = 0;
+    profile->last_period = furi_get_tick();
+}
+
+BlackhatProfile* blackhat_profile_alloc(void)
+{
+    BlackhatProfile* profile = malloc(sizeof(BlackhatProfile));
+    memset(profile, 0, sizeof(BlackhatProfile));
+    profile->baseline = memmgr_get_free_heap();
+    profile->scene = BlackhatSceneNum;
+    blackhat_profile_reset(profile);
+    return profile;
+}
+
+void blackhat_profile_free(BlackhatProfile* profile)
+{
+    furi_assert(profile);
+    free(profile);
+}
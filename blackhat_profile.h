@@ -0,0 +1,57 @@
+#pragma once
+
+#include <furi.h>
+
+#include "scenes/blackhat_scene.h"
+
+// Heap and stack watermarks, sampled on the GUI thread at every view
+// dispatcher tick. Heap use is counted from the free heap at launch, and
+// the peak is kept for each scene that was on screen. Stack figures are
+// the FreeRTOS high water marks, the least free stack a thread ever had.
+// Allocations that come and go between two ticks are not seen.
+
+#define BLACKHAT_PROFILE_MAX_THREADS (4)
+#define BLACKHAT_PROFILE_HISTORY (64)
+#define BLACKHAT_PROFILE_PERIOD_MS (1000)
+
+typedef struct {
+    const char* name;
+    uint32_t stack_size;
+    uint32_t stack_free;
+} BlackhatProfileThread;
+
+typedef struct {
+    size_t heap_free;
+    size_t heap_free_min;
+    size_t max_block;
+    size_t max_block_min;
+    size_t scene_peak[BlackhatSceneNum];
+
+    BlackhatProfileThread threads[BLACKHAT_PROFILE_MAX_THREADS];
+    size_t num_threads;
+
+    // Free heap once per period, oldest first
+    uint32_t history[BLACKHAT_PROFILE_HISTORY];
+    size_t history_count;
+} BlackhatProfileStats;
+
+typedef struct BlackhatProfile BlackhatProfile;
+
+BlackhatProfile* blackhat_profile_alloc(void);
+void blackhat_profile_free(BlackhatProfile* profile);
+
+void blackhat_profile_watch(
+    BlackhatProfile* profile,
+    const char* name,
+    FuriThreadId id,
+    uint32_t stack_size
+);
+
+// GUI thread only, like everything below
+void blackhat_profile_sample(BlackhatProfile* profile, BlackhatScene scene);
+void blackhat_profile_get_stats(
+    BlackhatProfile* profile, BlackhatProfileStats* stats
+);
+
+// Starts the peaks over, the launch baseline is kept
+void blackhat_profile_reset(BlackhatProfile* profile);
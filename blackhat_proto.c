@@ -0,0 +1,190 @@
+#include "blackhat_proto.h"
+
+#include <string.h>
+
+#include "blackhat_crc.h"
+
+void blackhat_proto_decoder_init(
+    BlackhatProtoDecoder* decoder, const BlackhatProtoCallbacks* callbacks
+)
+{
+    decoder->callbacks = *callbacks;
+    blackhat_proto_decoder_reset(decoder);
+}
+
+void blackhat_proto_decoder_reset(BlackhatProtoDecoder* decoder)
+{
+    decoder->frame_len = 0;
+    decoder->frame_need = 0;
+}
+
+static void blackhat_proto_emit_text(
+    BlackhatProtoDecoder* decoder, uint8_t* buf, size_t len
+)
+{
+    if (len && decoder->callbacks.on_text) {
+        decoder->callbacks.on_text(buf, len, decoder->callbacks.context);
+    }
+}
+
+static bool blackhat_proto_complete(BlackhatProtoDecoder* decoder)
+{
+    uint8_t* f = decoder->frame;
+    size_t len = f[2] | (f[3] << 8);
+    size_t crc_at = BLACKHAT_PROTO_HEADER_SIZE + len;
+    uint16_t crc = f[crc_at] | (f[crc_at + 1] << 8);
+
+    if (crc != blackhat_crc16(0xffff, &f[2], crc_at - 2)) return false;
+
+    if (decoder->callbacks.on_frame) {
+        decoder->callbacks.on_frame(
+            f[5],
+            f[4],
+            &f[BLACKHAT_PROTO_HEADER_SIZE],
+            len,
+            decoder->callbacks.context
+        );
+    }
+    blackhat_proto_decoder_reset(decoder);
+    return true;
+}
+
+// Checks the byte just added to the frame, false if the frame is bad
+static bool blackhat_proto_check(BlackhatProtoDecoder* decoder)
+{
+    uint8_t* f = decoder->frame;
+    size_t frame_len = decoder->frame_len;
+
+    if (frame_len == 2) return f[1] == BLACKHAT_PROTO_SOF1;
+    if (frame_len == BLACKHAT_PROTO_HEADER_SIZE) {
+        size_t payload = f[2] | (f[3] << 8);
+        if (payload > BLACKHAT_PROTO_MAX_PAYLOAD) return false;
+        decoder->frame_need =
+            BLACKHAT_PROTO_HEADER_SIZE + payload + BLACKHAT_PROTO_CRC_SIZE;
+        return true;
+    }
+    if (frame_len == decoder->frame_need) {
+        return blackhat_proto_complete(decoder);
+    }
+    return true;
+}
+
+// Give up on the current frame. Text is kept at the front of the buffer and
+// the rest is scanned again in place, a real frame may start inside it.
+static void blackhat_proto_reject(BlackhatProtoDecoder* decoder)
+{
+    uint8_t* f = decoder->frame;
+    size_t len = decoder->frame_len;
+    size_t pos = 1;
+
+    blackhat_proto_decoder_reset(decoder);
+    while (pos < len) {
+        if (!decoder->frame_len) {
+            if (f[pos] != BLACKHAT_PROTO_SOF0) {
+                pos++;
+                continue;
+            }
+            // Flush the text and move the new frame to the front
+            blackhat_proto_emit_text(decoder, f, pos);
+            memmove(f, &f[pos], len - pos);
+            len -= pos;
+            pos = 1;
+            decoder->frame_len = 1;
+            decoder->frame_need = BLACKHAT_PROTO_HEADER_SIZE;
+            continue;
+        }
+
+        // The frame is always f[0..pos), so the next byte is already there
+        decoder->frame_len++;
+        pos++;
+        if (!blackhat_proto_check(decoder)) {
+            // Start over from the second byte of this frame
+            blackhat_proto_decoder_reset(decoder);
+            pos = 1;
+        } else if (!decoder->frame_len) {
+            memmove(f, &f[pos], len - pos);
+            len -= pos;
+            pos = 0;
+        }
+    }
+
+    if (!decoder->frame_len) blackhat_proto_emit_text(decoder, f, len);
+}
+
+void blackhat_proto_decoder_feed(
+    BlackhatProtoDecoder* decoder, uint8_t* buf, size_t len
+)
+{
+    size_t text_start = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = buf[i];
+
+        if (!decoder->frame_len) {
+            if (b != BLACKHAT_PROTO_SOF0) continue;
+            // Flush the text seen so far before starting a frame
+            blackhat_proto_emit_text(decoder, &buf[text_start], i - text_start);
+            decoder->frame[decoder->frame_len++] = b;
+            decoder->frame_need = BLACKHAT_PROTO_HEADER_SIZE;
+            text_start = i + 1;
+            continue;
+        }
+
+        decoder->frame[decoder->frame_len++] = b;
+        if (!blackhat_proto_check(decoder)) blackhat_proto_reject(decoder);
+
+        text_start = i + 1;
+    }
+
+    if (!decoder->frame_len) {
+        blackhat_proto_emit_text(decoder, &buf[text_start], len - text_start);
+    }
+}
+
+size_t blackhat_proto_encode(
+    uint8_t* out,
+    size_t out_size,
+    uint8_t type,
+    uint8_t id,
+    const void* payload,
+    size_t len
+)
+{
+    size_t size =
+        BLACKHAT_PROTO_HEADER_SIZE + len + BLACKHAT_PROTO_CRC_SIZE;
+    if (len > BLACKHAT_PROTO_MAX_PAYLOAD || size > out_size) return 0;
+
+    out[0] = BLACKHAT_PROTO_SOF0;
+    out[1] = BLACKHAT_PROTO_SOF1;
+    out[2] = len & 0xff;
+    out[3] = len >> 8;
+    out[4] = id;
+    out[5] = type;
+    if (len) memcpy(&out[BLACKHAT_PROTO_HEADER_SIZE], payload, len);
+
+    uint16_t crc = blackhat_crc16(0xffff, &out[2], len + 4);
+    out[size - 2] = crc & 0xff;
+    out[size - 1] = crc >> 8;
+
+    return size;
+}
+
+BlackhatChannel blackhat_proto_channel(uint8_t type)
+{
+    switch (type) {
+    case BlackhatProtoHello:
+    case BlackhatProtoRequest:
+    case BlackhatProtoData:
+    case BlackhatProtoEnd:
+        return BlackhatChannelControl;
+    case BlackhatProtoConsole:
+        return BlackhatChannelConsole;
+    case BlackhatProtoEvent:
+        return BlackhatChannelEvent;
+    case BlackhatProtoFramebuffer:
+    case BlackhatProtoBulk:
+        return BlackhatChannelBulk;
+    default:
+        return BlackhatChannelCount;
+    }
+}
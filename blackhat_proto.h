@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Framed link protocol, used alongside the plain text console.
+//
+//   0xb5 0x5b | len (u16 le) | id | type | payload[len] | crc16 (u16 le)
+//
+// The CRC covers len, id, type and payload. Bytes that are not part of a
+// valid frame are passed through untouched as console text, so devices that
+// only speak the text protocol keep working.
+
+#define BLACKHAT_PROTO_SOF0 (0xb5)
+#define BLACKHAT_PROTO_SOF1 (0x5b)
+#define BLACKHAT_PROTO_HEADER_SIZE (6)
+#define BLACKHAT_PROTO_CRC_SIZE (2)
+#define BLACKHAT_PROTO_MAX_PAYLOAD (512)
+#define BLACKHAT_PROTO_MAX_FRAME                            \
+    (BLACKHAT_PROTO_HEADER_SIZE + BLACKHAT_PROTO_MAX_PAYLOAD + \
+     BLACKHAT_PROTO_CRC_SIZE)
+
+typedef enum {
+    BlackhatProtoHello = 0x01,
+    BlackhatProtoRequest = 0x02,
+    BlackhatProtoData = 0x03,
+    BlackhatProtoEnd = 0x04,
+    BlackhatProtoConsole = 0x05,
+    BlackhatProtoFramebuffer = 0x06,
+    BlackhatProtoEvent = 0x07,
+    BlackhatProtoBulk = 0x08,
+} BlackhatProtoType;
+
+// Logical channels sharing the link, each frame type belongs to one. The
+// UART sends the channels round robin so a busy one can't hold the others
+// up, plain console text goes on the console channel.
+typedef enum {
+    BlackhatChannelControl,
+    BlackhatChannelConsole,
+    BlackhatChannelEvent,
+    BlackhatChannelBulk,
+    BlackhatChannelCount,
+} BlackhatChannel;
+
+// BlackhatChannelCount for types this side doesn't know
+BlackhatChannel blackhat_proto_channel(uint8_t type);
+
+typedef struct {
+    void (*on_frame)(
+        uint8_t type,
+        uint8_t id,
+        uint8_t* payload,
+        size_t len,
+        void* context
+    );
+    void (*on_text)(uint8_t* buf, size_t len, void* context);
+    void* context;
+} BlackhatProtoCallbacks;
+
+typedef struct {
+    BlackhatProtoCallbacks callbacks;
+    uint8_t frame[BLACKHAT_PROTO_MAX_FRAME];
+    size_t frame_len;
+    size_t frame_need;
+} BlackhatProtoDecoder;
+
+void blackhat_proto_decoder_init(
+    BlackhatProtoDecoder* decoder, const BlackhatProtoCallbacks* callbacks
+);
+void blackhat_proto_decoder_reset(BlackhatProtoDecoder* decoder);
+void blackhat_proto_decoder_feed(
+    BlackhatProtoDecoder* decoder, uint8_t* buf, size_t len
+);
+
+// Returns the encoded size, or 0 if the frame doesn't fit in `out`
+size_t blackhat_proto_encode(
+    uint8_t* out,
+    size_t out_size,
+    uint8_t type,
+    uint8_t id,
+    const void* payload,
+    size_t len
+);
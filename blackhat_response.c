@@ -0,0 +1,96 @@
+#include "blackhat_response.h"
+
+struct BlackhatResponse {
+    ViewDispatcher* view_dispatcher;
+    uint32_t event;
+    FuriTimer* timer;
+    volatile bool active;
+    char tail[2];
+};
+
+static void blackhat_response_done(BlackhatResponse* response)
+{
+    // Only the first of prompt, idle and timeout reports completion
+    bool was_active;
+    FURI_CRITICAL_ENTER();
+    was_active = response->active;
+    response->active = false;
+    FURI_CRITICAL_EXIT();
+
+    if (was_active) {
+        view_dispatcher_send_custom_event(
+            response->view_dispatcher, response->event
+        );
+    }
+}
+
+static void blackhat_response_timer_callback(void* context)
+{
+    blackhat_response_done(context);
+}
+
+BlackhatResponse*
+    blackhat_response_alloc(ViewDispatcher* view_dispatcher, uint32_t event)
+{
+    BlackhatResponse* response = malloc(sizeof(BlackhatResponse));
+    response->view_dispatcher = view_dispatcher;
+    response->event = event;
+    response->active = false;
+    response->timer = furi_timer_alloc(
+        blackhat_response_timer_callback, FuriTimerTypeOnce, response
+    );
+    return response;
+}
+
+void blackhat_response_free(BlackhatResponse* response)
+{
+    furi_timer_stop(response->timer);
+    furi_timer_free(response->timer);
+    free(response);
+}
+
+void blackhat_response_start(BlackhatResponse* response)
+{
+    response->tail[0] = response->tail[1] = '\0';
+    response->active = true;
+    furi_timer_start(
+        response->timer, furi_ms_to_ticks(BLACKHAT_RESPONSE_TIMEOUT_MS)
+    );
+}
+
+void blackhat_response_cancel(BlackhatResponse* response)
+{
+    response->active = false;
+    furi_timer_stop(response->timer);
+}
+
+void blackhat_response_feed(
+    BlackhatResponse* response, const uint8_t* buf, size_t len
+)
+{
+    if (!response->active || !len) return;
+
+    if (len >= 2) {
+        response->tail[0] = buf[len - 2];
+    } else {
+        response->tail[0] = response->tail[1];
+    }
+    response->tail[1] = buf[len - 1];
+
+    // A fresh "# " or "$ " with nothing after it is the shell prompt
+    if ((response->tail[0] == '#' || response->tail[0] == '$') &&
+        response->tail[1] == ' ') {
+        furi_timer_stop(response->timer);
+        blackhat_response_done(response);
+        return;
+    }
+
+    furi_timer_restart(
+        response->timer, furi_ms_to_ticks(BLACKHAT_RESPONSE_IDLE_MS)
+    );
+}
+
+bool blackhat_response_is_active(BlackhatResponse* response)
+{
+    return response->active;
+}
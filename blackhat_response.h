@@ -0,0 +1,27 @@
+#pragma once
+
+#include <furi.h>
+#include <gui/view_dispatcher.h>
+
+// Detects the end of a text response without blocking. The response is
+// done when the shell prompt shows up again, or when the line has been idle
+// for BLACKHAT_RESPONSE_IDLE_MS. Completion is reported to the GUI thread
+// as a custom event.
+
+#define BLACKHAT_RESPONSE_IDLE_MS (300)
+#define BLACKHAT_RESPONSE_TIMEOUT_MS (3000)
+
+typedef struct BlackhatResponse BlackhatResponse;
+
+BlackhatResponse*
+    blackhat_response_alloc(ViewDispatcher* view_dispatcher, uint32_t event);
+void blackhat_response_free(BlackhatResponse* response);
+
+void blackhat_response_start(BlackhatResponse* response);
+void blackhat_response_cancel(BlackhatResponse* response);
+
+// Called from the UART worker with every chunk of the response
+void blackhat_response_feed(
+    BlackhatResponse* response, const uint8_t* buf, size_t len
+);
+bool blackhat_response_is_active(BlackhatResponse* response);
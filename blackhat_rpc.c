@@ -0,0 +1,278 @@
+#include "blackhat_rpc.h"
+
+#include "blackhat_app_i.h"
+
+#define TAG "BlackhatRpc"
+
+typedef struct {
+    uint8_t id;
+    uint32_t sent_at;
+    BlackhatRpcCallback cb;
+    void* context;
+} BlackhatRpcPending;
+
+struct BlackhatRpc {
+    BlackhatUart* uart;
+    BlackhatProtoDecoder decoder;
+    FuriMutex* mutex;
+    volatile bool framed;
+
+    BlackhatRpcChannelCallback channel_cb[BlackhatChannelCount];
+    void* channel_context[BlackhatChannelCount];
+
+    BlackhatRpcPending pending[BLACKHAT_RPC_MAX_PENDING];
+    uint8_t next_id;
+    FuriMutex* tx_mutex;
+    uint8_t tx_frame[BLACKHAT_PROTO_MAX_FRAME];
+};
+
+static BlackhatRpcPending* blackhat_rpc_find(BlackhatRpc* rpc, uint8_t id)
+{
+    for (size_t i = 0; i < BLACKHAT_RPC_MAX_PENDING; i++) {
+        if (rpc->pending[i].id == id) return &rpc->pending[i];
+    }
+    return NULL;
+}
+
+static void blackhat_rpc_on_text(uint8_t* buf, size_t len, void* context)
+{
+    BlackhatRpc* rpc = context;
+    blackhat_uart_deliver(rpc->uart, buf, len);
+}
+
+static void blackhat_rpc_on_frame(
+    uint8_t type, uint8_t id, uint8_t* payload, size_t len, void* context
+)
+{
+    BlackhatRpc* rpc = context;
+
+    switch (type) {
+    case BlackhatProtoHello:
+        if (!rpc->framed) FURI_LOG_I(TAG, "Framed mode enabled");
+        rpc->framed = true;
+        break;
+
+    case BlackhatProtoConsole:
+        blackhat_uart_deliver(rpc->uart, payload, len);
+        break;
+
+    case BlackhatProtoData:
+    case BlackhatProtoEnd: {
+        // The callback runs under the lock so cancel() can't race it
+        furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+        BlackhatRpcPending* pending = id ? blackhat_rpc_find(rpc, id) : NULL;
+        if (pending) {
+            if (type == BlackhatProtoEnd) pending->id = 0;
+            pending->cb(
+                type == BlackhatProtoEnd ? BlackhatRpcEventEnd :
+                                           BlackhatRpcEventData,
+                payload,
+                len,
+                pending->context
+            );
+        }
+        furi_mutex_release(rpc->mutex);
+        break;
+    }
+
+    default: {
+        BlackhatChannel channel = blackhat_proto_channel(type);
+        if (channel != BlackhatChannelEvent && channel != BlackhatChannelBulk) {
+            break;
+        }
+        furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+        if (rpc->channel_cb[channel]) {
+            rpc->channel_cb[channel](
+                type, id, payload, len, rpc->channel_context[channel]
+            );
+        }
+        furi_mutex_release(rpc->mutex);
+        break;
+    }
+    }
+}
+
+static void blackhat_rpc_rx_filter(uint8_t* buf, size_t len, void* context)
+{
+    BlackhatRpc* rpc = context;
+    blackhat_proto_decoder_feed(&rpc->decoder, buf, len);
+}
+
+BlackhatRpc* blackhat_rpc_alloc(BlackhatUart* uart)
+{
+    BlackhatRpc* rpc = malloc(sizeof(BlackhatRpc));
+    rpc->uart = uart;
+    rpc->mutex = furi_mutex_alloc(FuriMutexTypeRecursive);
+    rpc->tx_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    rpc->framed = false;
+    rpc->next_id = 1;
+    memset(rpc->channel_cb, 0x00, sizeof(rpc->channel_cb));
+    memset(rpc->pending, 0x00, sizeof(rpc->pending));
+
+    const BlackhatProtoCallbacks callbacks = {
+        .on_frame = blackhat_rpc_on_frame,
+        .on_text = blackhat_rpc_on_text,
+        .context = rpc,
+    };
+    blackhat_proto_decoder_init(&rpc->decoder, &callbacks);
+
+    blackhat_uart_set_rx_filter(uart, blackhat_rpc_rx_filter, rpc);
+
+    return rpc;
+}
+
+void blackhat_rpc_free(BlackhatRpc* rpc)
+{
+    furi_assert(rpc);
+
+    blackhat_uart_set_rx_filter(rpc->uart, NULL, NULL);
+    furi_mutex_free(rpc->tx_mutex);
+    furi_mutex_free(rpc->mutex);
+    free(rpc);
+}
+
+void blackhat_rpc_negotiate(BlackhatRpc* rpc)
+{
+    static const char cmd[] = PROTO_CMD "\n";
+    blackhat_uart_tx(rpc->uart, (char*)cmd, sizeof(cmd) - 1);
+}
+
+bool blackhat_rpc_is_framed(BlackhatRpc* rpc)
+{
+    return rpc->framed;
+}
+
+void blackhat_rpc_reset(BlackhatRpc* rpc)
+{
+    // The End callbacks forward into the console callback, keep the worker
+    // from delivering alongside them and from feeding the decoder
+    blackhat_uart_rx_lock(rpc->uart);
+    furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+    if (rpc->framed) FURI_LOG_I(TAG, "Framed mode disabled");
+    rpc->framed = false;
+
+    for (size_t i = 0; i < BLACKHAT_RPC_MAX_PENDING; i++) {
+        BlackhatRpcPending* p = &rpc->pending[i];
+        if (!p->id) continue;
+        p->id = 0;
+        p->cb(BlackhatRpcEventEnd, NULL, 0, p->context);
+    }
+    // A half received frame from before the reset would swallow new text
+    blackhat_proto_decoder_reset(&rpc->decoder);
+    furi_mutex_release(rpc->mutex);
+    blackhat_uart_rx_unlock(rpc->uart);
+}
+
+static BlackhatRpcPending* blackhat_rpc_alloc_slot(BlackhatRpc* rpc)
+{
+    BlackhatRpcPending* oldest = NULL;
+
+    for (size_t i = 0; i < BLACKHAT_RPC_MAX_PENDING; i++) {
+        BlackhatRpcPending* p = &rpc->pending[i];
+        if (!p->id) return p;
+        if (!oldest || p->sent_at - oldest->sent_at > (UINT32_MAX / 2)) {
+            oldest = p;
+        }
+    }
+
+    // Reclaim a request the device never finished
+    if (furi_get_tick() - oldest->sent_at >=
+        furi_ms_to_ticks(BLACKHAT_RPC_TIMEOUT_MS)) {
+        FURI_LOG_W(TAG, "Request %u timed out", oldest->id);
+        return oldest;
+    }
+
+    return NULL;
+}
+
+static uint8_t blackhat_rpc_next_id(BlackhatRpc* rpc)
+{
+    uint8_t id;
+
+    do {
+        id = rpc->next_id++;
+        if (!rpc->next_id) rpc->next_id = 1;
+    } while (blackhat_rpc_find(rpc, id));
+
+    return id;
+}
+
+// tx_frame has a lock of its own, a sender waiting for room on the control
+// lane must not hold rpc->mutex and keep the worker from delivering answers
+static void blackhat_rpc_send_frame(
+    BlackhatRpc* rpc, uint8_t id, const char* cmd, size_t len
+)
+{
+    furi_mutex_acquire(rpc->tx_mutex, FuriWaitForever);
+    size_t size = blackhat_proto_encode(
+        rpc->tx_frame,
+        sizeof(rpc->tx_frame),
+        BlackhatProtoRequest,
+        id,
+        cmd,
+        len
+    );
+    blackhat_uart_tx_channel(
+        rpc->uart, BlackhatChannelControl, rpc->tx_frame, size
+    );
+    furi_mutex_release(rpc->tx_mutex);
+}
+
+uint8_t blackhat_rpc_request(
+    BlackhatRpc* rpc, const char* cmd, BlackhatRpcCallback cb, void* context
+)
+{
+    size_t len = strlen(cmd);
+    if (!rpc->framed || len > BLACKHAT_PROTO_MAX_PAYLOAD) return 0;
+
+    furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+
+    uint8_t id = 0;
+    BlackhatRpcPending* slot = blackhat_rpc_alloc_slot(rpc);
+    if (slot) {
+        id = blackhat_rpc_next_id(rpc);
+        slot->id = id;
+        slot->sent_at = furi_get_tick();
+        slot->cb = cb;
+        slot->context = context;
+    }
+
+    furi_mutex_release(rpc->mutex);
+
+    if (id) blackhat_rpc_send_frame(rpc, id, cmd, len);
+
+    return id;
+}
+
+bool blackhat_rpc_send(BlackhatRpc* rpc, const char* cmd)
+{
+    size_t len = strlen(cmd);
+    if (!rpc->framed || len > BLACKHAT_PROTO_MAX_PAYLOAD) return false;
+
+    blackhat_rpc_send_frame(rpc, 0, cmd, len);
+    return true;
+}
+
+void blackhat_rpc_cancel(BlackhatRpc* rpc, uint8_t id)
+{
+    furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+    BlackhatRpcPending* pending = id ? blackhat_rpc_find(rpc, id) : NULL;
+    if (pending) pending->id = 0;
+    furi_mutex_release(rpc->mutex);
+}
+
+void blackhat_rpc_set_channel_callback(
+    BlackhatRpc* rpc,
+    BlackhatChannel channel,
+    BlackhatRpcChannelCallback cb,
+    void* context
+)
+{
+    furi_assert(
+        channel == BlackhatChannelEvent || channel == BlackhatChannelBulk
+    );
+    furi_mutex_acquire(rpc->mutex, FuriWaitForever);
+    rpc->channel_cb[channel] = cb;
+    rpc->channel_context[channel] = context;
+    furi_mutex_release(rpc->mutex);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "blackhat_proto.h"
+#include "blackhat_uart.h"
+
+// Request/response client on top of the framed protocol. Several requests
+// can be in flight at once, responses are matched back by request id and
+// may arrive in any order. Until the device has answered the handshake
+// with a Hello frame, callers fall back to the text protocol.
+
+#define PROTO_CMD "bh proto framed"
+
+#define BLACKHAT_RPC_MAX_PENDING (8)
+#define BLACKHAT_RPC_TIMEOUT_MS (10000)
+
+typedef enum {
+    BlackhatRpcEventData,
+    BlackhatRpcEventEnd,
+} BlackhatRpcEvent;
+
+// Called from the UART worker thread, or by blackhat_rpc_reset()
+typedef void (*BlackhatRpcCallback)(
+    BlackhatRpcEvent event, const uint8_t* data, size_t len, void* context
+);
+
+// Unsolicited event and bulk frames, also from the UART worker thread
+typedef void (*BlackhatRpcChannelCallback)(
+    uint8_t type, uint8_t id, const uint8_t* data, size_t len, void* context
+);
+
+typedef struct BlackhatRpc BlackhatRpc;
+
+BlackhatRpc* blackhat_rpc_alloc(BlackhatUart* uart);
+void blackhat_rpc_free(BlackhatRpc* rpc);
+
+void blackhat_rpc_negotiate(BlackhatRpc* rpc);
+bool blackhat_rpc_is_framed(BlackhatRpc* rpc);
+// Back to text until negotiated again, for a device that restarts. Requests
+// in flight are ended without an answer.
+void blackhat_rpc_reset(BlackhatRpc* rpc);
+
+// Returns the request id, or 0 if the link isn't framed or too busy
+uint8_t blackhat_rpc_request(
+    BlackhatRpc* rpc, const char* cmd, BlackhatRpcCallback cb, void* context
+);
+// Fire and forget, sent as request id 0 whose answers are dropped. Takes no
+// pending slot. False if the link isn't framed.
+bool blackhat_rpc_send(BlackhatRpc* rpc, const char* cmd);
+void blackhat_rpc_cancel(BlackhatRpc* rpc, uint8_t id);
+
+// Receives the frames of BlackhatChannelEvent or BlackhatChannelBulk, the
+// control and console channels are handled here. NULL to stop.
+void blackhat_rpc_set_channel_callback(
+    BlackhatRpc* rpc,
+    BlackhatChannel channel,
+    BlackhatRpcChannelCallback cb,
+    void* context
+);
@@ -0,0 +1,202 @@
+#include "blackhat_store.h"
+
+#include <furi.h>
+#include <storage/storage.h>
+
+#include "blackhat_crc.h"
+
+#define TAG "BlackhatStore"
+
+#define STORE_MAGIC "BHSTORE"
+#define STORE_HEADER_SIZE (24)
+
+// Kept in memory only, the cache file is plaintext on the SD card
+static const char* const blackhat_store_secret_keys[] = {
+    "PASS",
+};
+
+static bool blackhat_store_is_secret(const char* key)
+{
+    for (size_t i = 0; i < COUNT_OF(blackhat_store_secret_keys); i++) {
+        if (!strcmp(key, blackhat_store_secret_keys[i])) return true;
+    }
+    return false;
+}
+
+const char*
+    blackhat_store_param_get(BlackhatStoreParams* params, const char* key)
+{
+    for (size_t i = 0; i < params->num_params; i++) {
+        if (!strcmp(params->param[i].key, key)) return params->param[i].value;
+    }
+    return NULL;
+}
+
+void blackhat_store_param_set(
+    BlackhatStoreParams* params, const char* key, const char* value
+)
+{
+    BlackhatStoreParam* param = NULL;
+
+    for (size_t i = 0; i < params->num_params; i++) {
+        if (!strcmp(params->param[i].key, key)) param = &params->param[i];
+    }
+    if (!param) {
+        if (params->num_params == BLACKHAT_STORE_MAX_PARAMS) return;
+        param = &params->param[params->num_params++];
+        strlcpy(param->key, key, sizeof(param->key));
+    }
+
+    strlcpy(param->value, value, sizeof(param->value));
+}
+
+uint32_t blackhat_store_list_hash(BlackhatLineList* list)
+{
+    uint32_t crc = 0;
+
+    for (size_t i = 0; i < blackhat_line_list_count(list); i++) {
+        const char* line = blackhat_line_list_get(list, i);
+        crc = blackhat_crc32(crc, line, strlen(line) + 1);
+    }
+
+    return crc;
+}
+
+static void blackhat_store_parse(
+    char* body,
+    BlackhatLineList* scripts,
+    BlackhatStoreParams* params,
+    BlackhatLineList* schema
+)
+{
+    char* line = body;
+
+    while (*line) {
+        char* end = strchr(line, '\n');
+        if (end) *end = '\0';
+
+        if (line[0] == 'S' && line[1] == ' ') {
+            blackhat_line_list_add(scripts, &line[2]);
+        } else if (line[0] == 'P' && line[1] == ' ') {
+            char* eq = strchr(&line[2], '=');
+            if (eq) {
+                *eq = '\0';
+                blackhat_store_param_set(params, &line[2], eq + 1);
+            }
+        } else if (line[0] == 'M' && line[1] == ' ') {
+            blackhat_line_list_add(schema, &line[2]);
+        }
+
+        if (!end) break;
+        line = end + 1;
+    }
+}
+
+bool blackhat_store_load(
+    BlackhatLineList* scripts,
+    BlackhatStoreParams* params,
+    BlackhatLineList* schema
+)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    char* buf = NULL;
+    bool loaded = false;
+
+    do {
+        if (!storage_file_open(
+                file, BLACKHAT_STORE_PATH, FSAM_READ, FSOM_OPEN_EXISTING
+            )) {
+            break;
+        }
+
+        size_t size = storage_file_size(file);
+        if (!size || size > BLACKHAT_STORE_MAX_SIZE) break;
+
+        // Everything comes in with a single read
+        buf = malloc(size + 1);
+        if (storage_file_read(file, buf, size) != size) break;
+        buf[size] = '\0';
+
+        unsigned version;
+        unsigned long crc;
+        if (sscanf(buf, STORE_MAGIC " %u %lx", &version, &crc) != 2) break;
+        if (version != BLACKHAT_STORE_VERSION) break;
+
+        char* body = strchr(buf, '\n');
+        if (!body) break;
+        body++;
+        if (crc != blackhat_crc32(0, body, strlen(body))) {
+            FURI_LOG_W(TAG, "Cache checksum mismatch");
+            break;
+        }
+
+        blackhat_line_list_reset(scripts);
+        blackhat_line_list_reset(schema);
+        blackhat_store_parse(body, scripts, params, schema);
+        blackhat_line_list_finish(scripts);
+        blackhat_line_list_finish(schema);
+        loaded = true;
+    } while (false);
+
+    free(buf);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+
+    return loaded;
+}
+
+void blackhat_store_save(
+    BlackhatLineList* scripts,
+    BlackhatStoreParams* params,
+    BlackhatLineList* schema
+)
+{
+    FuriString* body = furi_string_alloc();
+
+    for (size_t i = 0; i < blackhat_line_list_count(scripts); i++) {
+        furi_string_cat_printf(
+            body, "S %s\n", blackhat_line_list_get(scripts, i)
+        );
+    }
+    for (size_t i = 0; i < params->num_params; i++) {
+        if (blackhat_store_is_secret(params->param[i].key)) continue;
+        furi_string_cat_printf(
+            body, "P %s=%s\n", params->param[i].key, params->param[i].value
+        );
+    }
+    for (size_t i = 0; i < blackhat_line_list_count(schema); i++) {
+        furi_string_cat_printf(
+            body, "M %s\n", blackhat_line_list_get(schema, i)
+        );
+    }
+
+    char header[STORE_HEADER_SIZE + 1];
+    snprintf(
+        header,
+        sizeof(header),
+        STORE_MAGIC " %u %08lx\n",
+        BLACKHAT_STORE_VERSION,
+        (unsigned long)blackhat_crc32(
+            0, furi_string_get_cstr(body), furi_string_size(body)
+        )
+    );
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+
+    if (storage_file_open(
+            file, BLACKHAT_STORE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS
+        )) {
+        storage_file_write(file, header, strlen(header));
+        storage_file_write(
+            file, furi_string_get_cstr(body), furi_string_size(body)
+        );
+    }
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(body);
+}
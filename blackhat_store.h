@@ -0,0 +1,46 @@
+#pragma once
+
+#include "blackhat_line_list.h"
+
+// Persistent copy of the last script manifest, device parameters and menu
+// schema, so menus are usable right after launch. The file carries a format
+// version and a CRC-32 of its body; anything that doesn't match is ignored.
+
+#define BLACKHAT_STORE_PATH APP_DATA_PATH("cache.txt")
+// 2 drops files from before secrets were kept off the card
+#define BLACKHAT_STORE_VERSION (2)
+#define BLACKHAT_STORE_MAX_SIZE (16 * 1024)
+
+#define BLACKHAT_STORE_MAX_PARAMS (8)
+#define BLACKHAT_STORE_KEY_SIZE (16)
+#define BLACKHAT_STORE_VALUE_SIZE (32)
+
+typedef struct {
+    char key[BLACKHAT_STORE_KEY_SIZE];
+    char value[BLACKHAT_STORE_VALUE_SIZE];
+} BlackhatStoreParam;
+
+typedef struct {
+    BlackhatStoreParam param[BLACKHAT_STORE_MAX_PARAMS];
+    size_t num_params;
+} BlackhatStoreParams;
+
+bool blackhat_store_load(
+    BlackhatLineList* scripts,
+    BlackhatStoreParams* params,
+    BlackhatLineList* schema
+);
+void blackhat_store_save(
+    BlackhatLineList* scripts,
+    BlackhatStoreParams* params,
+    BlackhatLineList* schema
+);
+
+const char*
+    blackhat_store_param_get(BlackhatStoreParams* params, const char* key);
+void blackhat_store_param_set(
+    BlackhatStoreParams* params, const char* key, const char* value
+);
+
+// CRC-32 over the lines of a list, to tell whether a rescan changed anything
+uint32_t blackhat_store_list_hash(BlackhatLineList* list);
@@ -0,0 +1,152 @@
+#include "blackhat_telemetry.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#define WLAN_FIELD(n, name)                           \
+    {offsetof(BlackhatTelemetryFields, wlan[n].name), \
+     sizeof(((BlackhatTelemetryWlan*)0)->name)}
+#define FIELD(name) \
+    {offsetof(BlackhatTelemetryFields, name), \
+     sizeof(((BlackhatTelemetryFields*)0)->name)}
+
+typedef struct {
+    uint16_t offset;
+    uint8_t size;
+} BlackhatTelemetryLayout;
+
+static const BlackhatTelemetryLayout
+    blackhat_telemetry_layout[BlackhatTelemetryCount] = {
+        [BlackhatTelemetryIp] = FIELD(ip),
+        [BlackhatTelemetryWlan0Mode] = WLAN_FIELD(0, mode),
+        [BlackhatTelemetryWlan0Link] = WLAN_FIELD(0, link),
+        [BlackhatTelemetryWlan0Channel] = WLAN_FIELD(0, channel),
+        [BlackhatTelemetryWlan1Mode] = WLAN_FIELD(1, mode),
+        [BlackhatTelemetryWlan1Link] = WLAN_FIELD(1, link),
+        [BlackhatTelemetryWlan1Channel] = WLAN_FIELD(1, channel),
+        [BlackhatTelemetryWlan2Mode] = WLAN_FIELD(2, mode),
+        [BlackhatTelemetryWlan2Link] = WLAN_FIELD(2, link),
+        [BlackhatTelemetryWlan2Channel] = WLAN_FIELD(2, channel),
+        [BlackhatTelemetryApClients] = FIELD(ap_clients),
+        [BlackhatTelemetrySsh] = FIELD(ssh),
+        [BlackhatTelemetryPortal] = FIELD(portal),
+        [BlackhatTelemetryKismet] = FIELD(kismet),
+};
+
+struct BlackhatTelemetry {
+    FuriMutex* mutex;
+    BlackhatTelemetryFields fields;
+    uint32_t dirty;
+    bool queued;
+};
+
+static char* blackhat_telemetry_value(
+    BlackhatTelemetryFields* fields, BlackhatTelemetryField field
+)
+{
+    return (char*)fields + blackhat_telemetry_layout[field].offset;
+}
+
+// Returns true when the value is different
+static bool blackhat_telemetry_set(
+    BlackhatTelemetry* telemetry,
+    BlackhatTelemetryField field,
+    const uint8_t* data,
+    size_t len
+)
+{
+    char value[sizeof(BlackhatTelemetryFields)];
+    size_t size = blackhat_telemetry_layout[field].size;
+
+    len = MIN(len, size - 1);
+    for (size_t i = 0; i < len; i++) {
+        value[i] = (data[i] >= ' ' && data[i] < 0x7f) ? data[i] : '?';
+    }
+    value[len] = '\0';
+
+    char* dst = blackhat_telemetry_value(&telemetry->fields, field);
+    if (!strcmp(dst, value)) return false;
+    memcpy(dst, value, len + 1);
+    return true;
+}
+
+bool blackhat_telemetry_apply(
+    BlackhatTelemetry* telemetry, const uint8_t* payload, size_t len
+)
+{
+    bool wake = false;
+
+    furi_mutex_acquire(telemetry->mutex, FuriWaitForever);
+
+    size_t pos = 0;
+    while (pos + 2 <= len) {
+        uint8_t field = payload[pos];
+        uint8_t size = payload[pos + 1];
+        pos += 2;
+        if (size > len - pos) break;
+
+        if (field < BlackhatTelemetryCount &&
+            blackhat_telemetry_set(telemetry, field, &payload[pos], size)) {
+            telemetry->dirty |= 1UL << field;
+        }
+        pos += size;
+    }
+
+    if (telemetry->dirty && !telemetry->queued) {
+        telemetry->queued = true;
+        wake = true;
+    }
+
+    furi_mutex_release(telemetry->mutex);
+
+    return wake;
+}
+
+uint32_t blackhat_telemetry_take(
+    BlackhatTelemetry* telemetry, BlackhatTelemetryFields* fields
+)
+{
+    furi_mutex_acquire(telemetry->mutex, FuriWaitForever);
+
+    uint32_t dirty = telemetry->dirty;
+    for (size_t field = 0; field < BlackhatTelemetryCount; field++) {
+        if (dirty & (1UL << field)) {
+            memcpy(
+                blackhat_telemetry_value(fields, field),
+                blackhat_telemetry_value(&telemetry->fields, field),
+                blackhat_telemetry_layout[field].size
+            );
+        }
+    }
+    telemetry->dirty = 0;
+    telemetry->queued = false;
+
+    furi_mutex_release(telemetry->mutex);
+
+    return dirty;
+}
+
+void blackhat_telemetry_reset(BlackhatTelemetry* telemetry)
+{
+    furi_mutex_acquire(telemetry->mutex, FuriWaitForever);
+    memset(&telemetry->fields, 0, sizeof(telemetry->fields));
+    telemetry->dirty = 0;
+    telemetry->queued = false;
+    furi_mutex_release(telemetry->mutex);
+}
+
+BlackhatTelemetry* blackhat_telemetry_alloc(void)
+{
+    BlackhatTelemetry* telemetry = malloc(sizeof(BlackhatTelemetry));
+    telemetry->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    blackhat_telemetry_reset(telemetry);
+    return telemetry;
+}
+
+void blackhat_telemetry_free(BlackhatTelemetry* telemetry)
+{
+    furi_assert(telemetry);
+
+    furi_mutex_free(telemetry->mutex);
+    free(telemetry);
+}
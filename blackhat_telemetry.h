@@ -0,0 +1,68 @@
+#pragma once
+
+#include <furi.h>
+
+// Device status pushed on the event channel. After "bh telemetry start
+// <interval ms>" the device sends a BlackhatProtoEvent frame with id
+// BLACKHAT_EVENT_TELEMETRY holding every field, then only the fields that
+// changed, at most once per interval. The payload is a list of
+//
+//   field | len | value[len]
+//
+// with every value as short text. Unknown fields are skipped by length.
+
+#define BLACKHAT_TELEMETRY_CMD "bh telemetry"
+#define BLACKHAT_TELEMETRY_INTERVAL_MS (500)
+#define BLACKHAT_EVENT_TELEMETRY (0x01)
+#define BLACKHAT_TELEMETRY_WLANS (3)
+
+typedef enum {
+    BlackhatTelemetryIp,
+    BlackhatTelemetryWlan0Mode,
+    BlackhatTelemetryWlan0Link,
+    BlackhatTelemetryWlan0Channel,
+    BlackhatTelemetryWlan1Mode,
+    BlackhatTelemetryWlan1Link,
+    BlackhatTelemetryWlan1Channel,
+    BlackhatTelemetryWlan2Mode,
+    BlackhatTelemetryWlan2Link,
+    BlackhatTelemetryWlan2Channel,
+    BlackhatTelemetryApClients,
+    BlackhatTelemetrySsh,
+    BlackhatTelemetryPortal,
+    BlackhatTelemetryKismet,
+    BlackhatTelemetryCount,
+} BlackhatTelemetryField;
+
+typedef struct {
+    char mode[10];
+    char link[6];
+    char channel[4];
+} BlackhatTelemetryWlan;
+
+typedef struct {
+    char ip[16];
+    BlackhatTelemetryWlan wlan[BLACKHAT_TELEMETRY_WLANS];
+    char ap_clients[4];
+    char ssh[4];
+    char portal[4];
+    char kismet[4];
+} BlackhatTelemetryFields;
+
+typedef struct BlackhatTelemetry BlackhatTelemetry;
+
+BlackhatTelemetry* blackhat_telemetry_alloc(void);
+void blackhat_telemetry_free(BlackhatTelemetry* telemetry);
+void blackhat_telemetry_reset(BlackhatTelemetry* telemetry);
+
+// Called from the UART worker with an event payload. True when a field
+// changed and no take is queued yet, the caller then wakes the GUI thread.
+bool blackhat_telemetry_apply(
+    BlackhatTelemetry* telemetry, const uint8_t* payload, size_t len
+);
+
+// Copies only the fields that changed since the last take, returns them as
+// a mask of 1 << BlackhatTelemetryField
+uint32_t blackhat_telemetry_take(
+    BlackhatTelemetry* telemetry, BlackhatTelemetryFields* fields
+);
@@ -0,0 +1,788 @@
+#include "blackhat_term.h"
+
+#include <gui/canvas.h>
+#include <input/input.h>
+#include <stdlib.h>
+
+#define TERM_ATTR_REVERSE (1 << 0)
+
+typedef enum {
+    TermStateGround,
+    TermStateEscape,
+    TermStateCharset,
+    TermStateCsi,
+    TermStateOsc,
+    TermStateOscEscape,
+} TermState;
+
+typedef struct {
+    char ch;
+    uint8_t attr;
+} TermCell;
+
+struct BlackhatTerm {
+    View* view;
+    FuriMutex* mutex;
+    uint8_t cols;
+    uint8_t rows;
+
+    TermCell cells[BLACKHAT_TERM_MAX_ROWS][BLACKHAT_TERM_MAX_COLS];
+    uint32_t dirty;
+
+    uint8_t cx;
+    uint8_t cy;
+    bool wrap_pending;
+    bool cursor_visible;
+    uint8_t attr;
+    uint8_t saved_cx;
+    uint8_t saved_cy;
+    uint8_t saved_attr;
+    uint8_t top;
+    uint8_t bottom;
+
+    TermState state;
+    uint16_t params[BLACKHAT_TERM_MAX_PARAMS];
+    uint8_t num_params;
+    bool private_mode;
+
+    char history[BLACKHAT_TERM_HISTORY][BLACKHAT_TERM_MAX_COLS];
+    uint8_t history_head;
+    uint8_t history_count;
+    uint8_t offset;
+
+    ViewInputCallback input_callback;
+    void* input_context;
+};
+
+#define TERM_ALL_ROWS(term) ((uint32_t)((1ULL << (term)->rows) - 1))
+
+static void blackhat_term_clear_cells(
+    BlackhatTerm* term, uint8_t row, uint8_t from, uint8_t to
+)
+{
+    for (uint8_t col = from; col < to; col++) {
+        term->cells[row][col].ch = ' ';
+        term->cells[row][col].attr = term->attr & TERM_ATTR_REVERSE;
+    }
+    term->dirty |= 1UL << row;
+}
+
+static void blackhat_term_clear_rows(
+    BlackhatTerm* term, uint8_t from, uint8_t to
+)
+{
+    for (uint8_t row = from; row < to; row++) {
+        blackhat_term_clear_cells(term, row, 0, term->cols);
+    }
+}
+
+static void blackhat_term_push_history(BlackhatTerm* term, uint8_t row)
+{
+    char* line = term->history[term->history_head];
+    for (uint8_t col = 0; col < term->cols; col++) {
+        line[col] = term->cells[row][col].ch;
+    }
+
+    term->history_head = (term->history_head + 1) % BLACKHAT_TERM_HISTORY;
+    if (term->history_count < BLACKHAT_TERM_HISTORY) term->history_count++;
+
+    // Keep a viewport that looks into history on the same lines
+    if (term->offset && term->offset < term->history_count) term->offset++;
+}
+
+static void blackhat_term_scroll_up(
+    BlackhatTerm* term, uint8_t n, bool to_history
+)
+{
+    uint8_t height = term->bottom - term->top + 1;
+    n = MIN(n, height);
+
+    if (to_history) {
+        for (uint8_t i = 0; i < n; i++) {
+            blackhat_term_push_history(term, i);
+        }
+    }
+
+    memmove(
+        &term->cells[term->top],
+        &term->cells[term->top + n],
+        (height - n) * sizeof(term->cells[0])
+    );
+    blackhat_term_clear_rows(term, term->bottom + 1 - n, term->bottom + 1);
+    for (uint8_t row = term->top; row <= term->bottom; row++) {
+        term->dirty |= 1UL << row;
+    }
+}
+
+static void blackhat_term_scroll_down(BlackhatTerm* term, uint8_t n)
+{
+    uint8_t height = term->bottom - term->top + 1;
+    n = MIN(n, height);
+
+    memmove(
+        &term->cells[term->top + n],
+        &term->cells[term->top],
+        (height - n) * sizeof(term->cells[0])
+    );
+    blackhat_term_clear_rows(term, term->top, term->top + n);
+    for (uint8_t row = term->top; row <= term->bottom; row++) {
+        term->dirty |= 1UL << row;
+    }
+}
+
+static void blackhat_term_move(BlackhatTerm* term, int32_t col, int32_t row)
+{
+    term->cx = CLAMP(col, term->cols - 1, 0);
+    term->cy = CLAMP(row, term->rows - 1, 0);
+    term->wrap_pending = false;
+}
+
+static void blackhat_term_index(BlackhatTerm* term)
+{
+    if (term->cy == term->bottom) {
+        blackhat_term_scroll_up(term, 1, term->top == 0);
+    } else if (term->cy < term->rows - 1) {
+        term->cy++;
+    }
+}
+
+static void blackhat_term_reverse_index(BlackhatTerm* term)
+{
+    if (term->cy == term->top) {
+        blackhat_term_scroll_down(term, 1);
+    } else if (term->cy > 0) {
+        term->cy--;
+    }
+}
+
+static void blackhat_term_put(BlackhatTerm* term, char ch)
+{
+    if (term->wrap_pending) {
+        term->cx = 0;
+        term->wrap_pending = false;
+        blackhat_term_index(term);
+    }
+
+    TermCell* cell = &term->cells[term->cy][term->cx];
+    cell->ch = ch;
+    cell->attr = term->attr;
+    term->dirty |= 1UL << term->cy;
+
+    // The cursor stays on the last column until the next glyph arrives
+    if (term->cx == term->cols - 1) {
+        term->wrap_pending = true;
+    } else {
+        term->cx++;
+    }
+}
+
+static void blackhat_term_do_reset(BlackhatTerm* term)
+{
+    term->cx = term->cy = 0;
+    term->wrap_pending = false;
+    term->cursor_visible = true;
+    term->attr = 0;
+    term->saved_cx = term->saved_cy = term->saved_attr = 0;
+    term->top = 0;
+    term->bottom = term->rows - 1;
+    term->state = TermStateGround;
+    term->history_count = 0;
+    term->history_head = 0;
+    term->offset = 0;
+    blackhat_term_clear_rows(term, 0, term->rows);
+}
+
+static uint16_t blackhat_term_param(BlackhatTerm* term, uint8_t i, uint16_t def)
+{
+    return (i < term->num_params && term->params[i]) ? term->params[i] : def;
+}
+
+static void blackhat_term_erase_display(BlackhatTerm* term, uint16_t mode)
+{
+    switch (mode) {
+    case 0:
+        blackhat_term_clear_cells(term, term->cy, term->cx, term->cols);
+        blackhat_term_clear_rows(term, term->cy + 1, term->rows);
+        break;
+    case 1:
+        blackhat_term_clear_rows(term, 0, term->cy);
+        blackhat_term_clear_cells(term, term->cy, 0, term->cx + 1);
+        break;
+    case 3:
+        term->history_count = 0;
+        term->offset = 0;
+        // fall through
+    case 2:
+        blackhat_term_clear_rows(term, 0, term->rows);
+        break;
+    }
+}
+
+static void blackhat_term_erase_line(BlackhatTerm* term, uint16_t mode)
+{
+    switch (mode) {
+    case 0:
+        blackhat_term_clear_cells(term, term->cy, term->cx, term->cols);
+        break;
+    case 1:
+        blackhat_term_clear_cells(term, term->cy, 0, term->cx + 1);
+        break;
+    case 2:
+        blackhat_term_clear_cells(term, term->cy, 0, term->cols);
+        break;
+    }
+}
+
+// Shifts the rest of the line, positive inserts blanks, negative deletes
+static void blackhat_term_shift_cells(BlackhatTerm* term, int32_t n)
+{
+    TermCell* line = term->cells[term->cy];
+    uint8_t count = term->cols - term->cx;
+    uint8_t shift = MIN((uint32_t)abs(n), count);
+
+    if (n > 0) {
+        memmove(
+            &line[term->cx + shift],
+            &line[term->cx],
+            (count - shift) * sizeof(TermCell)
+        );
+        blackhat_term_clear_cells(term, term->cy, term->cx, term->cx + shift);
+    } else {
+        memmove(
+            &line[term->cx],
+            &line[term->cx + shift],
+            (count - shift) * sizeof(TermCell)
+        );
+        blackhat_term_clear_cells(
+            term, term->cy, term->cols - shift, term->cols
+        );
+    }
+}
+
+// Insert (n > 0) or delete (n < 0) lines at the cursor, within the region
+static void blackhat_term_shift_lines(BlackhatTerm* term, int32_t n)
+{
+    if (term->cy < term->top || term->cy > term->bottom) return;
+
+    uint8_t top = term->top;
+    term->top = term->cy;
+    if (n > 0) {
+        blackhat_term_scroll_down(term, n);
+    } else {
+        blackhat_term_scroll_up(term, -n, false);
+    }
+    term->top = top;
+
+    term->cx = 0;
+    term->wrap_pending = false;
+}
+
+static void blackhat_term_sgr(BlackhatTerm* term)
+{
+    if (!term->num_params) term->attr = 0;
+
+    for (uint8_t i = 0; i < term->num_params; i++) {
+        switch (term->params[i]) {
+        case 0:
+            term->attr = 0;
+            break;
+        case 7:
+            term->attr |= TERM_ATTR_REVERSE;
+            break;
+        case 27:
+            term->attr &= ~TERM_ATTR_REVERSE;
+            break;
+        default:
+            // Colours and weights have no meaning on a 1 bit screen
+            break;
+        }
+    }
+}
+
+static void blackhat_term_set_mode(BlackhatTerm* term, bool set)
+{
+    if (!term->private_mode) return;
+
+    for (uint8_t i = 0; i < term->num_params; i++) {
+        switch (term->params[i]) {
+        case 25:
+            term->cursor_visible = set;
+            break;
+        case 47:
+        case 1047:
+        case 1049:
+            // No alternate screen, start full screen tools on a clean one
+            blackhat_term_erase_display(term, 2);
+            blackhat_term_move(term, 0, 0);
+            break;
+        }
+    }
+}
+
+static void blackhat_term_csi(BlackhatTerm* term, char final)
+{
+    uint16_t p1 = blackhat_term_param(term, 0, 1);
+
+    switch (final) {
+    case 'A':
+        blackhat_term_move(term, term->cx, term->cy - p1);
+        break;
+    case 'B':
+    case 'e':
+        blackhat_term_move(term, term->cx, term->cy + p1);
+        break;
+    case 'C':
+    case 'a':
+        blackhat_term_move(term, term->cx + p1, term->cy);
+        break;
+    case 'D':
+        blackhat_term_move(term, term->cx - p1, term->cy);
+        break;
+    case 'E':
+        blackhat_term_move(term, 0, term->cy + p1);
+        break;
+    case 'F':
+        blackhat_term_move(term, 0, term->cy - p1);
+        break;
+    case 'G':
+    case '`':
+        blackhat_term_move(term, p1 - 1, term->cy);
+        break;
+    case 'd':
+        blackhat_term_move(term, term->cx, p1 - 1);
+        break;
+    case 'H':
+    case 'f':
+        blackhat_term_move(
+            term, blackhat_term_param(term, 1, 1) - 1, p1 - 1
+        );
+        break;
+    case 'J':
+        blackhat_term_erase_display(term, blackhat_term_param(term, 0, 0));
+        break;
+    case 'K':
+        blackhat_term_erase_line(term, blackhat_term_param(term, 0, 0));
+        break;
+    case '@':
+        blackhat_term_shift_cells(term, p1);
+        break;
+    case 'P':
+        blackhat_term_shift_cells(term, -(int32_t)p1);
+        break;
+    case 'X':
+        blackhat_term_clear_cells(
+            term, term->cy, term->cx, MIN(term->cx + p1, term->cols)
+        );
+        break;
+    case 'L':
+        blackhat_term_shift_lines(term, p1);
+        break;
+    case 'M':
+        blackhat_term_shift_lines(term, -(int32_t)p1);
+        break;
+    case 'S':
+        blackhat_term_scroll_up(term, p1, false);
+        break;
+    case 'T':
+        blackhat_term_scroll_down(term, p1);
+        break;
+    case 'm':
+        blackhat_term_sgr(term);
+        break;
+    case 'h':
+        blackhat_term_set_mode(term, true);
+        break;
+    case 'l':
+        blackhat_term_set_mode(term, false);
+        break;
+    case 'r': {
+        uint16_t top = blackhat_term_param(term, 0, 1);
+        uint16_t bottom = blackhat_term_param(term, 1, term->rows);
+        if (top < bottom && bottom <= term->rows) {
+            term->top = top - 1;
+            term->bottom = bottom - 1;
+        }
+        blackhat_term_move(term, 0, 0);
+        break;
+    }
+    case 's':
+        term->saved_cx = term->cx;
+        term->saved_cy = term->cy;
+        break;
+    case 'u':
+        blackhat_term_move(term, term->saved_cx, term->saved_cy);
+        break;
+    default:
+        break;
+    }
+}
+
+static void blackhat_term_escape(BlackhatTerm* term, char c)
+{
+    term->state = TermStateGround;
+
+    switch (c) {
+    case '[':
+        term->state = TermStateCsi;
+        term->num_params = 0;
+        term->params[0] = 0;
+        term->private_mode = false;
+        break;
+    case ']':
+        term->state = TermStateOsc;
+        break;
+    case '(':
+    case ')':
+        term->state = TermStateCharset;
+        break;
+    case '7':
+        term->saved_cx = term->cx;
+        term->saved_cy = term->cy;
+        term->saved_attr = term->attr;
+        break;
+    case '8':
+        blackhat_term_move(term, term->saved_cx, term->saved_cy);
+        term->attr = term->saved_attr;
+        break;
+    case 'D':
+        blackhat_term_index(term);
+        break;
+    case 'E':
+        term->cx = 0;
+        blackhat_term_index(term);
+        break;
+    case 'M':
+        blackhat_term_reverse_index(term);
+        break;
+    case 'c':
+        blackhat_term_do_reset(term);
+        break;
+    default:
+        break;
+    }
+}
+
+static void blackhat_term_control(BlackhatTerm* term, char c)
+{
+    switch (c) {
+    case '\r':
+        term->cx = 0;
+        term->wrap_pending = false;
+        break;
+    case '\n':
+    case '\v':
+    case '\f':
+        term->cx = 0;
+        term->wrap_pending = false;
+        blackhat_term_index(term);
+        break;
+    case '\b':
+        if (term->cx) term->cx--;
+        term->wrap_pending = false;
+        break;
+    case '\t':
+        blackhat_term_move(
+            term,
+            (term->cx / BLACKHAT_TERM_TAB + 1) * BLACKHAT_TERM_TAB,
+            term->cy
+        );
+        break;
+    case 0x1b:
+        term->state = TermStateEscape;
+        break;
+    default:
+        break;
+    }
+}
+
+static void blackhat_term_input(BlackhatTerm* term, uint8_t c)
+{
+    switch (term->state) {
+    case TermStateGround:
+        if (c < 0x20 || c == 0x7f) {
+            blackhat_term_control(term, c);
+        } else if (c < 0x80) {
+            blackhat_term_put(term, c);
+        } else if (c >= 0xc0) {
+            // One cell per UTF-8 sequence, continuation bytes are skipped
+            blackhat_term_put(term, '?');
+        }
+        break;
+    case TermStateEscape:
+        blackhat_term_escape(term, c);
+        break;
+    case TermStateCharset:
+        term->state = TermStateGround;
+        break;
+    case TermStateCsi:
+        if (c >= '0' && c <= '9') {
+            if (!term->num_params) term->num_params = 1;
+            uint16_t* p = &term->params[term->num_params - 1];
+            *p = MIN(*p * 10 + (c - '0'), 9999);
+        } else if (c == ';') {
+            if (!term->num_params) term->num_params = 1;
+            if (term->num_params < BLACKHAT_TERM_MAX_PARAMS) {
+                term->params[term->num_params++] = 0;
+            }
+        } else if (c == '?' || c == '>' || c == '=') {
+            term->private_mode = true;
+        } else if (c >= 0x40 && c <= 0x7e) {
+            blackhat_term_csi(term, c);
+            term->state = TermStateGround;
+        } else if (c < 0x20) {
+            // Controls are still obeyed in the middle of a sequence
+            blackhat_term_control(term, c);
+        }
+        break;
+    case TermStateOsc:
+        // Window titles and the like, skipped up to BEL or ST
+        if (c == 0x07) {
+            term->state = TermStateGround;
+        } else if (c == 0x1b) {
+            term->state = TermStateOscEscape;
+        }
+        break;
+    case TermStateOscEscape:
+        term->state = TermStateGround;
+        break;
+    }
+}
+
+static void blackhat_term_render_row(
+    BlackhatTerm* term, BlackhatTermScreen* model, uint8_t row
+)
+{
+    char* text = model->text[row];
+    uint32_t reverse = 0;
+
+    // Viewport line, counting from the oldest history line
+    int32_t line = term->history_count - term->offset + row;
+    if (line < term->history_count) {
+        uint8_t slot = (term->history_head + BLACKHAT_TERM_HISTORY -
+                        term->history_count + line) %
+                       BLACKHAT_TERM_HISTORY;
+        memcpy(text, term->history[slot], term->cols);
+    } else {
+        const TermCell* cells = term->cells[line - term->history_count];
+        for (uint8_t col = 0; col < term->cols; col++) {
+            text[col] = cells[col].ch;
+            if (cells[col].attr & TERM_ATTR_REVERSE) reverse |= 1UL << col;
+        }
+    }
+
+    text[term->cols] = '\0';
+    model->reverse[row] = reverse;
+}
+
+bool blackhat_term_commit(BlackhatTerm* term)
+{
+    bool changed;
+
+    furi_mutex_acquire(term->mutex, FuriWaitForever);
+
+    // Any change moves every row while looking into history
+    uint32_t dirty = term->dirty;
+    if (dirty && term->offset) dirty = TERM_ALL_ROWS(term);
+    term->dirty = 0;
+
+    int8_t cursor_col = -1;
+    int8_t cursor_row = -1;
+    if (term->cursor_visible && !term->offset) {
+        cursor_col = term->cx;
+        cursor_row = term->cy;
+    }
+
+    BlackhatTermScreen* model = view_get_model(term->view);
+    changed = dirty || model->cursor_col != cursor_col ||
+              model->cursor_row != cursor_row;
+    for (uint8_t row = 0; row < term->rows; row++) {
+        if (dirty & (1UL << row)) blackhat_term_render_row(term, model, row);
+    }
+    model->cursor_col = cursor_col;
+    model->cursor_row = cursor_row;
+    view_commit_model(term->view, changed);
+
+    furi_mutex_release(term->mutex);
+
+    return changed;
+}
+
+void blackhat_term_draw_screen(
+    Canvas* canvas, const BlackhatTermScreen* model
+)
+{
+    canvas_clear(canvas);
+    canvas_set_font(canvas, BLACKHAT_TERM_FONT);
+
+    for (uint8_t row = 0; row < model->rows; row++) {
+        int32_t y = row * BLACKHAT_TERM_CELL_H;
+        for (uint8_t col = 0; col < model->cols; col++) {
+            int32_t x = col * BLACKHAT_TERM_CELL_W;
+            char ch = model->text[row][col];
+            bool reverse = model->reverse[row] & (1UL << col);
+
+            if (reverse) {
+                canvas_draw_box(
+                    canvas, x, y, BLACKHAT_TERM_CELL_W, BLACKHAT_TERM_CELL_H
+                );
+                canvas_set_color(canvas, ColorWhite);
+            }
+            if (ch != ' ') {
+                canvas_draw_glyph(canvas, x, y + BLACKHAT_TERM_CELL_H - 1, ch);
+            }
+            if (reverse) canvas_set_color(canvas, ColorBlack);
+        }
+    }
+
+    if (model->cursor_row >= 0) {
+        canvas_set_color(canvas, ColorXOR);
+        canvas_draw_box(
+            canvas,
+            model->cursor_col * BLACKHAT_TERM_CELL_W,
+            model->cursor_row * BLACKHAT_TERM_CELL_H,
+            BLACKHAT_TERM_CELL_W,
+            BLACKHAT_TERM_CELL_H
+        );
+        canvas_set_color(canvas, ColorBlack);
+    }
+}
+
+static void blackhat_term_draw_callback(Canvas* canvas, void* model)
+{
+    blackhat_term_draw_screen(canvas, model);
+}
+
+static bool blackhat_term_pass_input(BlackhatTerm* term, InputEvent* event)
+{
+    if (!term->input_callback) return false;
+    return term->input_callback(event, term->input_context);
+}
+
+static bool blackhat_term_input_callback(InputEvent* event, void* context)
+{
+    BlackhatTerm* term = context;
+
+    if (event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return blackhat_term_pass_input(term, event);
+    }
+
+    switch (event->key) {
+    case InputKeyUp:
+        blackhat_term_scroll(term, 1);
+        return true;
+    case InputKeyDown:
+        blackhat_term_scroll(term, -1);
+        return true;
+    case InputKeyLeft:
+        blackhat_term_scroll(term, term->rows);
+        return true;
+    case InputKeyRight:
+        blackhat_term_scroll(term, -(int32_t)term->rows);
+        return true;
+    case InputKeyOk:
+        blackhat_term_scroll(term, -(int32_t)BLACKHAT_TERM_HISTORY);
+        return true;
+    default:
+        return blackhat_term_pass_input(term, event);
+    }
+}
+
+void blackhat_term_set_input_callback(
+    BlackhatTerm* term, ViewInputCallback callback, void* context
+)
+{
+    term->input_callback = callback;
+    term->input_context = context;
+}
+
+void blackhat_term_scroll(BlackhatTerm* term, int32_t lines)
+{
+    furi_mutex_acquire(term->mutex, FuriWaitForever);
+    int32_t offset = CLAMP(term->offset + lines, term->history_count, 0);
+    if (offset != term->offset) {
+        term->offset = offset;
+        term->dirty = TERM_ALL_ROWS(term);
+    }
+    furi_mutex_release(term->mutex);
+
+    blackhat_term_commit(term);
+}
+
+void blackhat_term_feed(BlackhatTerm* term, const uint8_t* data, size_t len)
+{
+    furi_mutex_acquire(term->mutex, FuriWaitForever);
+    for (size_t i = 0; i < len; i++) {
+        blackhat_term_input(term, data[i]);
+    }
+    furi_mutex_release(term->mutex);
+}
+
+void blackhat_term_reset(BlackhatTerm* term)
+{
+    furi_mutex_acquire(term->mutex, FuriWaitForever);
+    blackhat_term_do_reset(term);
+    furi_mutex_release(term->mutex);
+}
+
+BlackhatTerm* blackhat_term_alloc(uint8_t cols, uint8_t rows)
+{
+    BlackhatTerm* term = malloc(sizeof(BlackhatTerm));
+    term->cols = CLAMP(cols, BLACKHAT_TERM_MAX_COLS, 1);
+    term->rows = CLAMP(rows, BLACKHAT_TERM_MAX_ROWS, 1);
+    term->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    term->dirty = 0;
+    term->input_callback = NULL;
+    term->input_context = NULL;
+    blackhat_term_do_reset(term);
+
+    term->view = view_alloc();
+    view_allocate_model(
+        term->view, ViewModelTypeLocking, sizeof(BlackhatTermScreen)
+    );
+    with_view_model(
+        term->view,
+        BlackhatTermScreen * model,
+        {
+            model->cols = term->cols;
+            model->rows = term->rows;
+            model->cursor_col = -1;
+            model->cursor_row = -1;
+            for (uint8_t row = 0; row < term->rows; row++) {
+                memset(model->text[row], ' ', term->cols);
+                model->text[row][term->cols] = '\0';
+                model->reverse[row] = 0;
+            }
+        },
+        false
+    );
+    view_set_context(term->view, term);
+    view_set_draw_callback(term->view, blackhat_term_draw_callback);
+    view_set_input_callback(term->view, blackhat_term_input_callback);
+
+    return term;
+}
+
+void blackhat_term_free(BlackhatTerm* term)
+{
+    furi_assert(term);
+
+    view_free_model(term->view);
+    view_free(term->view);
+    furi_mutex_free(term->mutex);
+    free(term);
+}
+
+View* blackhat_term_get_view(BlackhatTerm* term)
+{
+    return term->view;
+}
+
+uint8_t blackhat_term_get_cols(BlackhatTerm* term)
+{
+    return term->cols;
+}
+
+uint8_t blackhat_term_get_rows(BlackhatTerm* term)
+{
+    return term->rows;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <furi.h>
+#include <gui/canvas.h>
+#include <gui/view.h>
+
+// VT100/ANSI terminal view. Device output is parsed by an escape sequence
+// state machine into a fixed grid of character cells, with cursor
+// addressing, deferred line wrap and a scroll region. Rows that change are
+// marked dirty and only those are copied to the view on commit, lines that
+// scroll off the top are kept as history for Up/Down.
+//
+// A bare LF also returns the carriage, since scripts often print without
+// the tty adding CRs.
+
+#define BLACKHAT_TERM_MAX_COLS (32)
+#define BLACKHAT_TERM_MAX_ROWS (16)
+#define BLACKHAT_TERM_HISTORY (64)
+#define BLACKHAT_TERM_MAX_PARAMS (8)
+#define BLACKHAT_TERM_TAB (8)
+
+// 5x7 monospace glyphs in 5x8 cells, 25x8 on the 128x64 screen
+#define BLACKHAT_TERM_FONT FontBatteryPercent
+#define BLACKHAT_TERM_CELL_W (5)
+#define BLACKHAT_TERM_CELL_H (8)
+#define BLACKHAT_TERM_COLS (128 / BLACKHAT_TERM_CELL_W)
+#define BLACKHAT_TERM_ROWS (64 / BLACKHAT_TERM_CELL_H)
+
+typedef struct BlackhatTerm BlackhatTerm;
+
+// Screen contents as drawn, also used by the tty mirror view
+typedef struct {
+    char text[BLACKHAT_TERM_MAX_ROWS][BLACKHAT_TERM_MAX_COLS + 1];
+    uint32_t reverse[BLACKHAT_TERM_MAX_ROWS];
+    uint8_t cols;
+    uint8_t rows;
+    // Negative when hidden or scrolled into history
+    int8_t cursor_col;
+    int8_t cursor_row;
+} BlackhatTermScreen;
+
+BlackhatTerm* blackhat_term_alloc(uint8_t cols, uint8_t rows);
+void blackhat_term_free(BlackhatTerm* term);
+View* blackhat_term_get_view(BlackhatTerm* term);
+
+uint8_t blackhat_term_get_cols(BlackhatTerm* term);
+uint8_t blackhat_term_get_rows(BlackhatTerm* term);
+
+// Safe from any thread, the grid has its own lock
+void blackhat_term_reset(BlackhatTerm* term);
+void blackhat_term_feed(BlackhatTerm* term, const uint8_t* data, size_t len);
+
+// Copies dirty rows to the view, false when nothing on screen changed
+bool blackhat_term_commit(BlackhatTerm* term);
+
+// Gets the keys the terminal doesn't use itself, like a long OK press
+void blackhat_term_set_input_callback(
+    BlackhatTerm* term, ViewInputCallback callback, void* context
+);
+
+// Moves the viewport into history, positive is older. 0 follows output.
+void blackhat_term_scroll(BlackhatTerm* term, int32_t lines);
+
+void blackhat_term_draw_screen(
+    Canvas* canvas, const BlackhatTermScreen* model
+);
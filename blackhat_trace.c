@@ -0,0 +1,124 @@
+#include "blackhat_trace.h"
+
+#if BLACKHAT_TRACE
+
+#include <storage/storage.h>
+
+#define TAG "BlackhatTrace"
+
+BlackhatTraceRecord blackhat_trace_ring[BLACKHAT_TRACE_SLOTS];
+uint32_t blackhat_trace_head;
+volatile bool blackhat_trace_paused;
+
+typedef struct {
+    const char* name;
+    uint8_t tid;
+} BlackhatTracePoint;
+
+// Trace points on the same thread share a track, so nesting shows up
+static const BlackhatTracePoint blackhat_trace_points[] = {
+    [BlackhatTraceRxIrq] = {"rx_irq", 1},
+    [BlackhatTraceRxWorker] = {"rx_worker", 2},
+    [BlackhatTraceConsoleRx] = {"console_rx", 2},
+    [BlackhatTraceConsoleRefresh] = {"console_refresh", 3},
+    [BlackhatTraceTuiInput] = {"tui_input", 3},
+};
+
+static const char* const blackhat_trace_tracks[] = {
+    NULL,
+    "serial irq",
+    "uart worker",
+    "gui",
+};
+
+static const char blackhat_trace_phases[] = {
+    [BlackhatTracePhaseBegin] = 'B',
+    [BlackhatTracePhaseEnd] = 'E',
+    [BlackhatTracePhaseMark] = 'i',
+};
+
+static void blackhat_trace_write(File* file, FuriString* line)
+{
+    storage_file_write(
+        file, furi_string_get_cstr(line), furi_string_size(line)
+    );
+}
+
+bool blackhat_trace_dump(const char* path)
+{
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    FuriString* line = furi_string_alloc();
+    bool ok = false;
+
+    blackhat_trace_paused = true;
+
+    if (storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        furi_string_set_str(line, "{\"traceEvents\":[\n");
+        for (size_t tid = 1; tid < COUNT_OF(blackhat_trace_tracks); tid++) {
+            furi_string_cat_printf(
+                line,
+                "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n",
+                (unsigned)tid,
+                blackhat_trace_tracks[tid]
+            );
+        }
+        blackhat_trace_write(file, line);
+
+        uint32_t head = blackhat_trace_head;
+        uint32_t count = MIN(head, (uint32_t)BLACKHAT_TRACE_SLOTS);
+        uint32_t ipus = furi_hal_cortex_instructions_per_microsecond();
+        uint64_t time = 0;
+        uint32_t last = 0;
+
+        for (uint32_t i = head - count; i != head; i++) {
+            const BlackhatTraceRecord* r =
+                &blackhat_trace_ring[i % BLACKHAT_TRACE_SLOTS];
+            if (r->id >= BlackhatTraceCount) continue;
+
+            // Unwrap the 32 bit counter, records are never 60 s apart
+            if (i != head - count) time += r->cycles - last;
+            last = r->cycles;
+
+            const BlackhatTracePoint* point = &blackhat_trace_points[r->id];
+            furi_string_printf(
+                line,
+                "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu.%03lu,\"pid\":1,"
+                "\"tid\":%u,\"args\":{\"arg\":%u}},\n",
+                point->name,
+                blackhat_trace_phases[r->phase],
+                (unsigned long)(time / ipus),
+                (unsigned long)(time % ipus * 1000 / ipus),
+                point->tid,
+                r->arg
+            );
+            blackhat_trace_write(file, line);
+        }
+
+        // Closing metadata record, so the list needs no trailing comma logic
+        furi_string_printf(
+            line,
+            "{\"name\":\"dump\",\"ph\":\"M\",\"pid\":1,\"args\":"
+            "{\"records\":%lu}}\n]}\n",
+            (unsigned long)count
+        );
+        blackhat_trace_write(file, line);
+        ok = true;
+        FURI_LOG_I(TAG, "%lu records written to %s", (unsigned long)count, path);
+    } else {
+        FURI_LOG_E(TAG, "Can't open %s", path);
+    }
+
+    blackhat_trace_head = 0;
+    blackhat_trace_paused = false;
+
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_string_free(line);
+    furi_record_close(RECORD_STORAGE);
+
+    return ok;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <furi.h>
+#include <furi_hal.h>
+
+// Hot path tracing. Trace points stamp the DWT cycle counter into a fixed
+// in-RAM ring, which can be dumped to SD as Chrome trace JSON and opened in
+// chrome://tracing or Perfetto. Build with BLACKHAT_TRACE set to 1, with the
+// default of 0 the macros expand to nothing and their arguments are unused.
+
+#ifndef BLACKHAT_TRACE
+#define BLACKHAT_TRACE (0)
+#endif
+
+#define BLACKHAT_TRACE_SLOTS (1024)
+#define BLACKHAT_TRACE_PATH APP_DATA_PATH("trace.json")
+
+typedef enum {
+    BlackhatTraceRxIrq,
+    BlackhatTraceRxWorker,
+    BlackhatTraceConsoleRx,
+    BlackhatTraceConsoleRefresh,
+    BlackhatTraceTuiInput,
+    BlackhatTraceCount,
+} BlackhatTraceId;
+
+typedef enum {
+    BlackhatTracePhaseBegin,
+    BlackhatTracePhaseEnd,
+    BlackhatTracePhaseMark,
+} BlackhatTracePhase;
+
+typedef struct {
+    uint32_t cycles;
+    uint16_t arg;
+    uint8_t id;
+    uint8_t phase;
+} BlackhatTraceRecord;
+
+#if BLACKHAT_TRACE
+
+extern BlackhatTraceRecord blackhat_trace_ring[BLACKHAT_TRACE_SLOTS];
+extern uint32_t blackhat_trace_head;
+extern volatile bool blackhat_trace_paused;
+
+// Lock free, safe from interrupts and any thread
+static inline void blackhat_trace_record(
+    BlackhatTraceId id, BlackhatTracePhase phase, uint32_t arg
+)
+{
+    if (blackhat_trace_paused) return;
+
+    uint32_t slot =
+        __atomic_fetch_add(&blackhat_trace_head, 1, __ATOMIC_RELAXED) %
+        BLACKHAT_TRACE_SLOTS;
+    BlackhatTraceRecord* record = &blackhat_trace_ring[slot];
+    record->cycles = DWT->CYCCNT;
+    record->arg = arg;
+    record->id = id;
+    record->phase = phase;
+}
+
+#define BH_TRACE_BEGIN(id, arg) \
+    blackhat_trace_record((id), BlackhatTracePhaseBegin, (arg))
+#define BH_TRACE_END(id, arg) \
+    blackhat_trace_record((id), BlackhatTracePhaseEnd, (arg))
+#define BH_TRACE_MARK(id, arg) \
+    blackhat_trace_record((id), BlackhatTracePhaseMark, (arg))
+
+// Writes the ring, oldest record first
+bool blackhat_trace_dump(const char* path);
+
+#else
+
+#define BH_TRACE_BEGIN(id, arg) \
+    do {                        \
+    } while (0)
+#define BH_TRACE_END(id, arg) \
+    do {                      \
+    } while (0)
+#define BH_TRACE_MARK(id, arg) \
+    do {                       \
+    } while (0)
+
+#endif
@@ -1,13 +1,61 @@
 #include "blackhat_app_i.h"
 #include "blackhat_uart.h"
 
+#if BLACKHAT_UART_FAKE
+#include "blackhat_fake.h"
+#endif
+
+#define BLACKHAT_UART_FLUSH_TIMEOUT_MS (1000)
+#define RX_STAMP_SLOTS (32)
+
+// Queued messages, each a u16 length and the bytes. The worker fields are
+// only touched by the TX thread.
+typedef struct {
+    FuriStreamBuffer* stream;
+    FuriMutex* mutex;
+    uint16_t pending;
+    uint32_t deficit;
+} BlackhatUartLane;
+
+// Stream position after a burst and the cycle count when it arrived
+typedef struct {
+    uint32_t end;
+    uint32_t cycles;
+} BlackhatUartStamp;
+
 struct BlackhatUart {
     BlackhatApp* app;
     FuriThread* rx_thread;
     FuriStreamBuffer* rx_stream;
+    // Held by the worker while it hands a burst on
+    FuriMutex* rx_mutex;
     uint8_t rx_buf[RX_BUF_SIZE + 1];
     void (*handle_rx_data_cb)(uint8_t* buf, size_t len, void* context);
+    void (*rx_hook)(const uint8_t* buf, size_t len, void* context);
+    void* rx_hook_context;
+    void (*rx_filter)(uint8_t* buf, size_t len, void* context);
+    void* rx_filter_context;
+    void (*rx_tap)(const uint8_t* buf, size_t len, void* context);
+    void* rx_tap_context;
+    void (*rx_latency_cb)(uint32_t latency_us, void* context);
+    void* rx_latency_context;
+    BlackhatUartStamp rx_stamps[RX_STAMP_SLOTS];
+    volatile uint32_t rx_stamp_head;
+    volatile uint32_t rx_stamp_tail;
+    volatile uint32_t rx_in;
+    uint32_t rx_out;
+    volatile BlackhatUartStats stats;
     FuriHalSerialHandle* serial_handle;
+    FuriThread* tx_thread;
+    BlackhatUartLane tx_lanes[BlackhatChannelCount];
+    uint8_t tx_next;
+    FuriStreamBuffer* tx_urgent;
+    volatile bool tx_busy;
+    FuriMutex* tx_urgent_mutex;
+    uint32_t baud;
+#if BLACKHAT_UART_FAKE
+    BlackhatFake* fake;
+#endif
 };
 
 typedef enum {
@@ -24,22 +72,230 @@ void blackhat_uart_set_handle_rx_data_cb(
     uart->handle_rx_data_cb = handle_rx_data_cb;
 }
 
+void blackhat_uart_set_rx_hook(
+    BlackhatUart* uart,
+    void (*rx_hook)(const uint8_t* buf, size_t len, void* context),
+    void* context
+)
+{
+    furi_assert(uart);
+    uart->rx_hook = NULL;
+    uart->rx_hook_context = context;
+    uart->rx_hook = rx_hook;
+}
+
+void blackhat_uart_set_rx_filter(
+    BlackhatUart* uart,
+    void (*rx_filter)(uint8_t* buf, size_t len, void* context),
+    void* context
+)
+{
+    furi_assert(uart);
+    uart->rx_filter = NULL;
+    uart->rx_filter_context = context;
+    uart->rx_filter = rx_filter;
+}
+
+void blackhat_uart_set_rx_tap(
+    BlackhatUart* uart,
+    void (*rx_tap)(const uint8_t* buf, size_t len, void* context),
+    void* context
+)
+{
+    furi_assert(uart);
+    uart->rx_tap = NULL;
+    uart->rx_tap_context = context;
+    uart->rx_tap = rx_tap;
+}
+
+void blackhat_uart_set_rx_latency_cb(
+    BlackhatUart* uart,
+    void (*rx_latency_cb)(uint32_t latency_us, void* context),
+    void* context
+)
+{
+    furi_assert(uart);
+    uart->rx_latency_cb = NULL;
+    uart->rx_latency_context = context;
+    // Bursts stamped before now belong to nobody
+    uart->rx_stamp_tail = uart->rx_stamp_head;
+    uart->rx_latency_cb = rx_latency_cb;
+}
+
+void blackhat_uart_rx_sync(BlackhatUart* uart)
+{
+    furi_assert(uart);
+    furi_mutex_acquire(uart->rx_mutex, FuriWaitForever);
+    furi_mutex_release(uart->rx_mutex);
+}
+
+void blackhat_uart_rx_lock(BlackhatUart* uart)
+{
+    furi_assert(uart);
+    furi_mutex_acquire(uart->rx_mutex, FuriWaitForever);
+}
+
+void blackhat_uart_rx_unlock(BlackhatUart* uart)
+{
+    furi_assert(uart);
+    furi_mutex_release(uart->rx_mutex);
+}
+
+void blackhat_uart_deliver(BlackhatUart* uart, uint8_t* buf, size_t len)
+{
+    if (uart->rx_tap) {
+        uart->rx_tap(buf, len, uart->rx_tap_context);
+    }
+    if (uart->handle_rx_data_cb) {
+        uart->handle_rx_data_cb(buf, len, uart->app);
+    }
+}
+
 #define WORKER_ALL_RX_EVENTS (WorkerEvtStop | WorkerEvtRxDone)
 
+typedef enum {
+    TxEvtStop = (1 << 0),
+    TxEvtData = (1 << 1),
+} TxEvtFlags;
+
+#define WORKER_ALL_TX_EVENTS (TxEvtStop | TxEvtData)
+
+// The GUI thread may zero a counter at any time, a plain ++ could write the
+// old count back over it
+static inline void blackhat_uart_count(volatile uint32_t* counter, uint32_t n)
+{
+    __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+}
+
+// Producer side of rx_stream, called from the serial or fake callback
+static void blackhat_uart_rx_push(
+    BlackhatUart* uart, const uint8_t* data, size_t len
+)
+{
+    size_t sent = furi_stream_buffer_send(uart->rx_stream, data, len, 0);
+    uart->rx_in += sent;
+
+    // A full stream means the worker fell behind, the rest is lost
+    blackhat_uart_count(&uart->stats.rx_bytes, sent);
+    blackhat_uart_count(&uart->stats.rx_dropped, len - sent);
+
+    uint32_t used = furi_stream_buffer_bytes_available(uart->rx_stream);
+    if (used > uart->stats.stream_peak) uart->stats.stream_peak = used;
+}
+
+static void blackhat_uart_rx_errors(
+    BlackhatUart* uart, FuriHalSerialRxEvent event
+)
+{
+    if (event & FuriHalSerialRxEventOverrunError) {
+        blackhat_uart_count(&uart->stats.overrun_errors, 1);
+    }
+    if (event & FuriHalSerialRxEventFrameError) {
+        blackhat_uart_count(&uart->stats.framing_errors, 1);
+    }
+    if (event & FuriHalSerialRxEventNoiseError) {
+        blackhat_uart_count(&uart->stats.noise_errors, 1);
+    }
+}
+
+static void blackhat_uart_rx_wake(BlackhatUart* uart)
+{
+    if (uart->rx_latency_cb &&
+        uart->rx_stamp_head - uart->rx_stamp_tail < RX_STAMP_SLOTS) {
+        BlackhatUartStamp* stamp =
+            &uart->rx_stamps[uart->rx_stamp_head % RX_STAMP_SLOTS];
+        stamp->end = uart->rx_in;
+        stamp->cycles = DWT->CYCCNT;
+        uart->rx_stamp_head++;
+    }
+
+    furi_thread_flags_set(furi_thread_get_id(uart->rx_thread), WorkerEvtRxDone);
+}
+
+// Worker side, report every burst that has now been fully handed on
+void blackhat_uart_rx_latency_mark(BlackhatUart* uart)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    if (!uart->rx_latency_cb) return;
+
+    while (uart->rx_stamp_tail != uart->rx_stamp_head) {
+        BlackhatUartStamp* stamp =
+            &uart->rx_stamps[uart->rx_stamp_tail % RX_STAMP_SLOTS];
+        if ((int32_t)(uart->rx_out - stamp->end) < 0) break;
+
+        uart->rx_latency_cb(
+            (now - stamp->cycles) /
+                furi_hal_cortex_instructions_per_microsecond(),
+            uart->rx_latency_context
+        );
+        uart->rx_stamp_tail++;
+    }
+}
+
+#if BLACKHAT_UART_FAKE
+// Runs on the fake device thread, same contract as the serial callbacks
+static void blackhat_uart_on_fake_rx(
+    const uint8_t* data, size_t len, void* context
+)
+{
+    BlackhatUart* uart = (BlackhatUart*)context;
+
+    blackhat_uart_rx_push(uart, data, len);
+    blackhat_uart_rx_wake(uart);
+}
+#elif BLACKHAT_UART_RX_DMA
+#define DMA_BURST_SIZE (64)
+
+void blackhat_uart_on_dma_cb(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialRxEvent event,
+    size_t data_len,
+    void* context
+)
+{
+    BlackhatUart* uart = (BlackhatUart*)context;
+
+    BH_TRACE_BEGIN(BlackhatTraceRxIrq, data_len);
+    blackhat_uart_rx_errors(uart, event);
+
+    if (event & (FuriHalSerialRxEventData | FuriHalSerialRxEventIdle)) {
+        uint8_t data[DMA_BURST_SIZE];
+
+        // Move the whole burst out of the DMA ring, then wake the worker once
+        while (data_len) {
+            size_t len = furi_hal_serial_dma_rx(
+                handle, data, MIN(data_len, sizeof(data))
+            );
+            if (!len) break;
+            blackhat_uart_rx_push(uart, data, len);
+            data_len -= len;
+        }
+
+        blackhat_uart_rx_wake(uart);
+    }
+
+    BH_TRACE_END(BlackhatTraceRxIrq, data_len);
+}
+#else
 void blackhat_uart_on_irq_cb(
     FuriHalSerialHandle* handle, FuriHalSerialRxEvent event, void* context
 )
 {
     BlackhatUart* uart = (BlackhatUart*)context;
 
-    if (event == FuriHalSerialRxEventData) {
+    BH_TRACE_BEGIN(BlackhatTraceRxIrq, 1);
+    blackhat_uart_rx_errors(uart, event);
+
+    if (event & FuriHalSerialRxEventData) {
         uint8_t data = furi_hal_serial_async_rx(handle);
-        furi_stream_buffer_send(uart->rx_stream, &data, 1, 0);
-        furi_thread_flags_set(
-            furi_thread_get_id(uart->rx_thread), WorkerEvtRxDone
-        );
+        blackhat_uart_rx_push(uart, &data, 1);
+        blackhat_uart_rx_wake(uart);
     }
+
+    BH_TRACE_END(BlackhatTraceRxIrq, 1);
 }
+#endif
 
 static int32_t uart_worker(void* context)
 {
@@ -52,16 +308,33 @@ static int32_t uart_worker(void* context)
         furi_check((events & FuriFlagError) == 0);
         if (events & WorkerEvtStop) break;
         if (events & WorkerEvtRxDone) {
-            size_t len = furi_stream_buffer_receive(
-                uart->rx_stream, uart->rx_buf, RX_BUF_SIZE, 0
-            );
-
-            if (len > 0) {
-                if (uart->handle_rx_data_cb) {
-                    uart->handle_rx_data_cb(uart->rx_buf, len, uart->app);
+            // Drain everything, one flag may cover several bursts
+            size_t len;
+            while ((len = furi_stream_buffer_receive(
+                        uart->rx_stream, uart->rx_buf, RX_BUF_SIZE, 0
+                    )) > 0) {
+                furi_mutex_acquire(uart->rx_mutex, FuriWaitForever);
+                uart->rx_out += len;
+                BH_TRACE_BEGIN(BlackhatTraceRxWorker, len);
+                uint32_t start = DWT->CYCCNT;
+                if (uart->rx_hook) {
+                    uart->rx_hook(uart->rx_buf, len, uart->rx_hook_context);
+                }
+                if (uart->rx_filter) {
+                    uart->rx_filter(
+                        uart->rx_buf, len, uart->rx_filter_context
+                    );
                 } else {
-                    uart->rx_buf[len] = '\0';
+                    blackhat_uart_deliver(uart, uart->rx_buf, len);
                 }
+
+                uint32_t us = (DWT->CYCCNT - start) /
+                              furi_hal_cortex_instructions_per_microsecond();
+                blackhat_uart_count(&uart->stats.rx_chunks, 1);
+                blackhat_uart_count(&uart->stats.cb_total_us, us);
+                if (us > uart->stats.cb_max_us) uart->stats.cb_max_us = us;
+                BH_TRACE_END(BlackhatTraceRxWorker, len);
+                furi_mutex_release(uart->rx_mutex);
             }
         }
     }
@@ -71,31 +344,303 @@ static int32_t uart_worker(void* context)
     return 0;
 }
 
+static void uart_tx_write(BlackhatUart* uart, const uint8_t* buf, size_t len)
+{
+#if BLACKHAT_UART_FAKE
+    blackhat_fake_write(uart->fake, buf, len);
+#else
+    furi_hal_serial_tx(uart->serial_handle, buf, len);
+#endif
+}
+
+// Waits for the rest of a message its sender is still queueing
+static void uart_tx_lane_read(BlackhatUartLane* lane, void* data, size_t len)
+{
+    uint8_t* bytes = data;
+    while (len) {
+        size_t got = furi_stream_buffer_receive(
+            lane->stream, bytes, len, FuriWaitForever
+        );
+        bytes += got;
+        len -= got;
+    }
+}
+
+// Sends at most one message, false once every lane is empty
+static bool uart_tx_lane_turn(BlackhatUart* uart, uint8_t* buf)
+{
+    bool busy = false;
+
+    for (size_t i = 0; i < BlackhatChannelCount; i++) {
+        BlackhatUartLane* lane = &uart->tx_lanes[uart->tx_next];
+        uart->tx_next = (uart->tx_next + 1) % BlackhatChannelCount;
+
+        if (!lane->pending) {
+            if (furi_stream_buffer_is_empty(lane->stream)) {
+                lane->deficit = 0;
+                continue;
+            }
+            uart_tx_lane_read(lane, &lane->pending, sizeof(lane->pending));
+        }
+
+        // A long message waits until the lane has saved up enough turns
+        busy = true;
+        lane->deficit += TX_QUANTUM;
+        if (lane->deficit < lane->pending) continue;
+        lane->deficit -= lane->pending;
+
+        while (lane->pending) {
+            size_t len = MIN(lane->pending, TX_CHUNK_SIZE);
+            uart_tx_lane_read(lane, buf, len);
+            uart_tx_write(uart, buf, len);
+            lane->pending -= len;
+        }
+        return true;
+    }
+
+    return busy;
+}
+
+static int32_t uart_tx_worker(void* context)
+{
+    BlackhatUart* uart = (void*)context;
+    uint8_t buf[TX_CHUNK_SIZE];
+
+    while (1) {
+        uint32_t events = furi_thread_flags_wait(
+            WORKER_ALL_TX_EVENTS, FuriFlagWaitAny, FuriWaitForever
+        );
+        furi_check((events & FuriFlagError) == 0);
+        if (events & TxEvtStop) break;
+
+        uart->tx_busy = true;
+        while (1) {
+            // Urgent bytes go first, between whole messages
+            size_t len = furi_stream_buffer_receive(
+                uart->tx_urgent, buf, sizeof(buf), 0
+            );
+            if (len) {
+                uart_tx_write(uart, buf, len);
+            } else if (!uart_tx_lane_turn(uart, buf)) {
+                break;
+            }
+        }
+        uart->tx_busy = false;
+    }
+
+    return 0;
+}
+
+static void blackhat_uart_enqueue(
+    BlackhatUart* uart, FuriStreamBuffer* stream, const void* data, size_t len
+)
+{
+    const uint8_t* bytes = data;
+    while (len) {
+        // Only blocks when the queue is full, the writer is already awake
+        size_t sent = furi_stream_buffer_send(
+            stream, bytes, MIN(len, TX_URGENT_SIZE), FuriWaitForever
+        );
+        furi_thread_flags_set(furi_thread_get_id(uart->tx_thread), TxEvtData);
+        bytes += sent;
+        len -= sent;
+    }
+}
+
+void blackhat_uart_tx_channel(
+    BlackhatUart* uart, BlackhatChannel channel, const void* data, size_t len
+)
+{
+    furi_assert(channel < BlackhatChannelCount);
+    BlackhatUartLane* lane = &uart->tx_lanes[channel];
+    const uint8_t* bytes = data;
+
+    // Each channel has its own lock, a sender stuck on a full lane only
+    // holds up its own channel
+    furi_mutex_acquire(lane->mutex, FuriWaitForever);
+    while (len) {
+        uint16_t size = MIN(len, (size_t)TX_MESSAGE_MAX);
+        blackhat_uart_enqueue(uart, lane->stream, &size, sizeof(size));
+        blackhat_uart_enqueue(uart, lane->stream, bytes, size);
+        bytes += size;
+        len -= size;
+    }
+    furi_mutex_release(lane->mutex);
+}
+
 void blackhat_uart_tx(BlackhatUart* uart, char* data, size_t len)
 {
-    furi_hal_serial_tx(uart->serial_handle, (uint8_t*)data, len);
+    blackhat_uart_tx_channel(uart, BlackhatChannelConsole, data, len);
+}
+
+void blackhat_uart_tx_urgent(BlackhatUart* uart, char* data, size_t len)
+{
+    furi_mutex_acquire(uart->tx_urgent_mutex, FuriWaitForever);
+    blackhat_uart_enqueue(uart, uart->tx_urgent, data, len);
+    furi_mutex_release(uart->tx_urgent_mutex);
+}
+
+static bool blackhat_uart_tx_idle(BlackhatUart* uart)
+{
+    if (uart->tx_busy || !furi_stream_buffer_is_empty(uart->tx_urgent)) {
+        return false;
+    }
+    for (size_t i = 0; i < BlackhatChannelCount; i++) {
+        if (!furi_stream_buffer_is_empty(uart->tx_lanes[i].stream)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool blackhat_uart_tx_flush(BlackhatUart* uart, uint32_t timeout_ms)
+{
+    uint32_t start = furi_get_tick();
+
+    while (!blackhat_uart_tx_idle(uart)) {
+        if (furi_get_tick() - start >= furi_ms_to_ticks(timeout_ms)) {
+            return false;
+        }
+        furi_delay_tick(1);
+    }
+
+#if !BLACKHAT_UART_FAKE
+    furi_hal_serial_tx_wait_complete(uart->serial_handle);
+#endif
+    return true;
+}
+
+void blackhat_uart_tx_lock(BlackhatUart* uart)
+{
+    for (size_t i = 0; i < BlackhatChannelCount; i++) {
+        furi_mutex_acquire(uart->tx_lanes[i].mutex, FuriWaitForever);
+    }
+    furi_mutex_acquire(uart->tx_urgent_mutex, FuriWaitForever);
+}
+
+void blackhat_uart_tx_unlock(BlackhatUart* uart)
+{
+    furi_mutex_release(uart->tx_urgent_mutex);
+    for (size_t i = BlackhatChannelCount; i--;) {
+        furi_mutex_release(uart->tx_lanes[i].mutex);
+    }
+}
+
+void blackhat_uart_get_stats(BlackhatUart* uart, BlackhatUartStats* stats)
+{
+    FURI_CRITICAL_ENTER();
+    memcpy(stats, (const void*)&uart->stats, sizeof(*stats));
+    FURI_CRITICAL_EXIT();
+}
+
+void blackhat_uart_reset_stats(BlackhatUart* uart)
+{
+    volatile uint32_t* words = (volatile uint32_t*)&uart->stats;
+    for (size_t i = 0; i < sizeof(uart->stats) / sizeof(*words); i++) {
+        __atomic_store_n(&words[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+bool blackhat_uart_is_baud_supported(BlackhatUart* uart, uint32_t baud)
+{
+#if BLACKHAT_UART_FAKE
+    UNUSED(uart);
+    UNUSED(baud);
+    return true;
+#else
+    return furi_hal_serial_is_baud_rate_supported(uart->serial_handle, baud);
+#endif
+}
+
+void blackhat_uart_set_baud(BlackhatUart* uart, uint32_t baud)
+{
+    // Never switch with bytes still queued or in the shift register
+    blackhat_uart_tx_flush(uart, BLACKHAT_UART_FLUSH_TIMEOUT_MS);
+#if BLACKHAT_UART_FAKE
+    blackhat_fake_set_baud(uart->fake, baud);
+#else
+    furi_hal_serial_set_br(uart->serial_handle, baud);
+#endif
+    uart->baud = baud;
+}
+
+uint32_t blackhat_uart_get_baud(BlackhatUart* uart)
+{
+    return uart->baud;
+}
+
+FuriThreadId blackhat_uart_get_rx_thread_id(BlackhatUart* uart)
+{
+    return furi_thread_get_id(uart->rx_thread);
+}
+
+FuriThreadId blackhat_uart_get_tx_thread_id(BlackhatUart* uart)
+{
+    return furi_thread_get_id(uart->tx_thread);
 }
 
 BlackhatUart* blackhat_uart_init(BlackhatApp* app)
 {
     BlackhatUart* uart = malloc(sizeof(BlackhatUart));
     uart->app = app;
+    uart->handle_rx_data_cb = NULL;
+    uart->rx_hook = NULL;
+    uart->rx_filter = NULL;
+    uart->rx_tap = NULL;
+    uart->rx_latency_cb = NULL;
+    uart->rx_stamp_head = 0;
+    uart->rx_stamp_tail = 0;
+    uart->rx_in = 0;
+    uart->rx_out = 0;
+    memset((void*)&uart->stats, 0, sizeof(uart->stats));
+    for (size_t i = 0; i < BlackhatChannelCount; i++) {
+        BlackhatUartLane* lane = &uart->tx_lanes[i];
+        lane->stream = furi_stream_buffer_alloc(TX_LANE_SIZE, 1);
+        lane->mutex = furi_mutex_alloc(FuriMutexTypeRecursive);
+        lane->pending = 0;
+        lane->deficit = 0;
+    }
+    uart->tx_next = 0;
+    uart->tx_urgent_mutex = furi_mutex_alloc(FuriMutexTypeRecursive);
     // Init all rx stream and thread early to avoid crashes
-    uart->rx_stream = furi_stream_buffer_alloc(RX_BUF_SIZE, 1);
+    uart->rx_stream = furi_stream_buffer_alloc(RX_STREAM_SIZE, 1);
+    uart->rx_mutex = furi_mutex_alloc(FuriMutexTypeRecursive);
     uart->rx_thread = furi_thread_alloc();
     furi_thread_set_name(uart->rx_thread, "BlackhatUartRxThread");
-    furi_thread_set_stack_size(uart->rx_thread, 1024);
+    furi_thread_set_stack_size(uart->rx_thread, BLACKHAT_UART_STACK_SIZE);
     furi_thread_set_context(uart->rx_thread, uart);
     furi_thread_set_callback(uart->rx_thread, uart_worker);
 
     furi_thread_start(uart->rx_thread);
 
+    uart->tx_urgent = furi_stream_buffer_alloc(TX_URGENT_SIZE, 1);
+    uart->tx_busy = false;
+    uart->tx_thread = furi_thread_alloc();
+    furi_thread_set_name(uart->tx_thread, "BlackhatUartTxThread");
+    furi_thread_set_stack_size(uart->tx_thread, BLACKHAT_UART_STACK_SIZE);
+    furi_thread_set_context(uart->tx_thread, uart);
+    furi_thread_set_callback(uart->tx_thread, uart_tx_worker);
+
+    uart->baud = BLACKHAT_UART_BAUD;
+#if BLACKHAT_UART_FAKE
+    uart->serial_handle = NULL;
+    uart->fake = blackhat_fake_alloc(blackhat_uart_on_fake_rx, uart);
+    furi_thread_start(uart->tx_thread);
+#else
     uart->serial_handle = furi_hal_serial_control_acquire(UART_CH);
     furi_check(uart->serial_handle);
-    furi_hal_serial_init(uart->serial_handle, 115200);
+    furi_hal_serial_init(uart->serial_handle, BLACKHAT_UART_BAUD);
+    furi_thread_start(uart->tx_thread);
+#if BLACKHAT_UART_RX_DMA
+    furi_hal_serial_dma_rx_start(
+        uart->serial_handle, blackhat_uart_on_dma_cb, uart, true
+    );
+#else
     furi_hal_serial_async_rx_start(
-        uart->serial_handle, blackhat_uart_on_irq_cb, uart, false
+        uart->serial_handle, blackhat_uart_on_irq_cb, uart, true
     );
+#endif
+#endif
 
     return uart;
 }
@@ -104,13 +649,33 @@ void blackhat_uart_free(BlackhatUart* uart)
 {
     furi_assert(uart);
 
+    blackhat_uart_tx_flush(uart, BLACKHAT_UART_FLUSH_TIMEOUT_MS);
+    furi_thread_flags_set(furi_thread_get_id(uart->tx_thread), TxEvtStop);
+    furi_thread_join(uart->tx_thread);
+    furi_thread_free(uart->tx_thread);
+    furi_stream_buffer_free(uart->tx_urgent);
+
+#if BLACKHAT_UART_FAKE
+    blackhat_fake_free(uart->fake);
+#else
+#if BLACKHAT_UART_RX_DMA
+    furi_hal_serial_dma_rx_stop(uart->serial_handle);
+#else
     furi_hal_serial_async_rx_stop(uart->serial_handle);
+#endif
     furi_hal_serial_deinit(uart->serial_handle);
     furi_hal_serial_control_release(uart->serial_handle);
+#endif
 
     furi_thread_flags_set(furi_thread_get_id(uart->rx_thread), WorkerEvtStop);
     furi_thread_join(uart->rx_thread);
     furi_thread_free(uart->rx_thread);
+    furi_mutex_free(uart->rx_mutex);
 
+    for (size_t i = 0; i < BlackhatChannelCount; i++) {
+        furi_stream_buffer_free(uart->tx_lanes[i].stream);
+        furi_mutex_free(uart->tx_lanes[i].mutex);
+    }
+    furi_mutex_free(uart->tx_urgent_mutex);
     free(uart);
 }
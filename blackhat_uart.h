@@ -2,14 +2,129 @@
 
 #include "furi_hal.h"
 
+#include "blackhat_app.h"
+#include "blackhat_proto.h"
+
+#define BLACKHAT_UART_BAUD (115200)
+
 #define RX_BUF_SIZE (320)
+#define RX_STREAM_SIZE (RX_BUF_SIZE * 4)
+
+// Receive through the HAL DMA ring and wake the worker on idle-line and
+// half/full transfer events. Set to 0 to fall back to one IRQ per byte.
+#ifndef BLACKHAT_UART_RX_DMA
+#define BLACKHAT_UART_RX_DMA (1)
+#endif
+
+// Talk to the scripted fake device in blackhat_fake.c instead of the
+// serial port, for soak runs on a Flipper with no Blackhat attached
+#ifndef BLACKHAT_UART_FAKE
+#define BLACKHAT_UART_FAKE (0)
+#endif
+
+// Transmit is asynchronous: messages are queued per channel and a writer
+// thread puts them on the wire whole, taking the channels in deficit round
+// robin turns of TX_QUANTUM bytes. Urgent bytes (game input) skip ahead
+// between messages.
+// Longer console text is queued as several messages
+#define TX_MESSAGE_MAX (BLACKHAT_PROTO_MAX_FRAME)
+// Room for one whole message and its length
+#define TX_LANE_SIZE (TX_MESSAGE_MAX + 2)
+#define TX_URGENT_SIZE (64)
+#define TX_CHUNK_SIZE (32)
+#define TX_QUANTUM (64)
+
+// Both worker threads
+#define BLACKHAT_UART_STACK_SIZE (1024)
 
 typedef struct BlackhatUart BlackhatUart;
 
+// Link health counters. The serial callback and the worker each own their
+// fields and count with atomic adds, so a reset from the GUI thread is never
+// lost. Readers take a snapshot.
+typedef struct {
+    // Serial callback
+    uint32_t rx_bytes;
+    uint32_t rx_dropped;
+    uint32_t overrun_errors;
+    uint32_t framing_errors;
+    uint32_t noise_errors;
+    uint32_t stream_peak;
+
+    // Worker
+    uint32_t rx_chunks;
+    uint32_t cb_max_us;
+    uint32_t cb_total_us;
+} BlackhatUartStats;
+
 void blackhat_uart_set_handle_rx_data_cb(
     BlackhatUart* uart,
     void (*handle_rx_data_cb)(uint8_t* buf, size_t len, void* context)
 );
+// Waits for the worker to finish the burst it is handing on, after which a
+// callback that was just cleared is no longer running
+void blackhat_uart_rx_sync(BlackhatUart* uart);
+// Holds the worker off between bursts, for resetting state it hands RX to
+void blackhat_uart_rx_lock(BlackhatUart* uart);
+void blackhat_uart_rx_unlock(BlackhatUart* uart);
+// Console text
 void blackhat_uart_tx(BlackhatUart* uart, char* data, size_t len);
+void blackhat_uart_tx_urgent(BlackhatUart* uart, char* data, size_t len);
+// One message, such as an encoded frame, never interleaved with others
+void blackhat_uart_tx_channel(
+    BlackhatUart* uart, BlackhatChannel channel, const void* data, size_t len
+);
+
+// Wait until everything queued so far has left the shift register
+bool blackhat_uart_tx_flush(BlackhatUart* uart, uint32_t timeout_ms);
+
+// Extra observer that sees every RX chunk before the scene callback
+void blackhat_uart_set_rx_hook(
+    BlackhatUart* uart,
+    void (*rx_hook)(const uint8_t* buf, size_t len, void* context),
+    void* context
+);
+
+// Optional decoding stage between the worker and the scene callback, it
+// passes plain console bytes on with blackhat_uart_deliver()
+void blackhat_uart_set_rx_filter(
+    BlackhatUart* uart,
+    void (*rx_filter)(uint8_t* buf, size_t len, void* context),
+    void* context
+);
+void blackhat_uart_deliver(BlackhatUart* uart, uint8_t* buf, size_t len);
+
+// Sees all console bytes that are delivered, whichever scene is active
+void blackhat_uart_set_rx_tap(
+    BlackhatUart* uart,
+    void (*rx_tap)(const uint8_t* buf, size_t len, void* context),
+    void* context
+);
+
+// Reports how long each received burst took from the serial callback to
+// its consumer, in microseconds. The consumer calls
+// blackhat_uart_rx_latency_mark() from its handle_rx_data_cb once it has the
+// bytes, the report runs there on the worker thread.
+void blackhat_uart_set_rx_latency_cb(
+    BlackhatUart* uart,
+    void (*rx_latency_cb)(uint32_t latency_us, void* context),
+    void* context
+);
+void blackhat_uart_rx_latency_mark(BlackhatUart* uart);
+
+void blackhat_uart_get_stats(BlackhatUart* uart, BlackhatUartStats* stats);
+void blackhat_uart_reset_stats(BlackhatUart* uart);
+
+// Hold off other senders while the link is being reconfigured
+void blackhat_uart_tx_lock(BlackhatUart* uart);
+void blackhat_uart_tx_unlock(BlackhatUart* uart);
+
+bool blackhat_uart_is_baud_supported(BlackhatUart* uart, uint32_t baud);
+void blackhat_uart_set_baud(BlackhatUart* uart, uint32_t baud);
+uint32_t blackhat_uart_get_baud(BlackhatUart* uart);
+
+FuriThreadId blackhat_uart_get_rx_thread_id(BlackhatUart* uart);
+FuriThreadId blackhat_uart_get_tx_thread_id(BlackhatUart* uart);
+
 BlackhatUart* blackhat_uart_init(BlackhatApp* app);
 void blackhat_uart_free(BlackhatUart* uart);
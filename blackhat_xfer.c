@@ -0,0 +1,560 @@
+#include "blackhat_xfer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <storage/storage.h>
+
+#include "blackhat_crc.h"
+#include "blackhat_proto.h"
+
+#define TAG "BlackhatXfer"
+
+typedef enum {
+    XferEvtStop = (1 << 0),
+    XferEvtAnswer = (1 << 1),
+    XferEvtAck = (1 << 2),
+    XferEvtData = (1 << 3),
+    XferEvtDone = (1 << 4),
+    XferEvtResult = (1 << 5),
+} XferEvtFlags;
+
+#define XFER_WINDOW_BYTES (BLACKHAT_XFER_WINDOW * BLACKHAT_XFER_BLOCK)
+// A receiver answers a repeated DONE for this long after the verdict
+#define XFER_LINGER_MS (2000)
+
+struct BlackhatXfer {
+    BlackhatRpc* rpc;
+    BlackhatUart* uart;
+    FuriThread* thread;
+    volatile bool running;
+    volatile bool cancel;
+
+    Storage* storage;
+    File* file;
+    bool push;
+    char local[BLACKHAT_XFER_PATH_SIZE];
+    char remote[BLACKHAT_XFER_PATH_SIZE];
+
+    FuriMutex* mutex;
+    BlackhatXferStatus status;
+    uint32_t started_at;
+
+    // Filled on the UART worker, read by the transfer thread once flagged
+    char answer[16];
+    size_t answer_len;
+    // Push: highest ack and how often it came again
+    volatile uint32_t ack;
+    volatile uint32_t dup_acks;
+    volatile uint8_t result;
+    // Pull: in order data, waiting to be written
+    FuriStreamBuffer* rx;
+    volatile uint32_t expected;
+    volatile uint32_t done_size;
+    volatile uint32_t done_crc;
+
+    uint8_t block[4 + BLACKHAT_XFER_BLOCK];
+    uint8_t frame[BLACKHAT_PROTO_MAX_FRAME];
+};
+
+static void blackhat_xfer_put_u32(uint8_t* out, uint32_t value)
+{
+    out[0] = value;
+    out[1] = value >> 8;
+    out[2] = value >> 16;
+    out[3] = value >> 24;
+}
+
+static uint32_t blackhat_xfer_get_u32(const uint8_t* data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) |
+           ((uint32_t)data[3] << 24);
+}
+
+static void blackhat_xfer_signal(BlackhatXfer* xfer, uint32_t flags)
+{
+    furi_thread_flags_set(furi_thread_get_id(xfer->thread), flags);
+}
+
+// Returns the events that came in, 0 on timeout or when cancelled
+static uint32_t blackhat_xfer_wait(
+    BlackhatXfer* xfer, uint32_t flags, uint32_t timeout_ms
+)
+{
+    uint32_t events = furi_thread_flags_wait(
+        flags | XferEvtStop, FuriFlagWaitAny, furi_ms_to_ticks(timeout_ms)
+    );
+    if (events & FuriFlagError) return 0;
+    if (events & XferEvtStop) xfer->cancel = true;
+    return xfer->cancel ? 0 : events;
+}
+
+static void blackhat_xfer_send(
+    BlackhatXfer* xfer, uint8_t kind, const void* data, size_t len
+)
+{
+    size_t size = blackhat_proto_encode(
+        xfer->frame, sizeof(xfer->frame), BlackhatProtoBulk, kind, data, len
+    );
+    // Blocks while the bulk lane is full, which paces the window to the baud
+    blackhat_uart_tx_channel(
+        xfer->uart, BlackhatChannelBulk, xfer->frame, size
+    );
+}
+
+static void blackhat_xfer_send_u32(
+    BlackhatXfer* xfer, uint8_t kind, uint32_t value
+)
+{
+    uint8_t data[4];
+    blackhat_xfer_put_u32(data, value);
+    blackhat_xfer_send(xfer, kind, data, sizeof(data));
+}
+
+static void blackhat_xfer_set_state(BlackhatXfer* xfer, BlackhatXferState state)
+{
+    furi_mutex_acquire(xfer->mutex, FuriWaitForever);
+    xfer->status.state = state;
+    furi_mutex_release(xfer->mutex);
+}
+
+static void blackhat_xfer_progress(BlackhatXfer* xfer, uint32_t done)
+{
+    uint32_t ms = (furi_get_tick() - xfer->started_at) * 1000 /
+                  furi_kernel_get_tick_frequency();
+
+    furi_mutex_acquire(xfer->mutex, FuriWaitForever);
+    xfer->status.done = done;
+    if (ms) {
+        xfer->status.bytes_per_s =
+            (uint64_t)(done - xfer->status.offset) * 1000 / ms;
+    }
+    furi_mutex_release(xfer->mutex);
+}
+
+static void blackhat_xfer_rpc_callback(
+    BlackhatRpcEvent event, const uint8_t* data, size_t len, void* context
+)
+{
+    BlackhatXfer* xfer = context;
+
+    if (event == BlackhatRpcEventData) {
+        size_t n = MIN(len, sizeof(xfer->answer) - 1 - xfer->answer_len);
+        memcpy(&xfer->answer[xfer->answer_len], data, n);
+        xfer->answer_len += n;
+    } else {
+        xfer->answer[xfer->answer_len] = '\0';
+        blackhat_xfer_signal(xfer, XferEvtAnswer);
+    }
+}
+
+// Sends an open request, the answer is a number or an error message
+static const char* blackhat_xfer_open(
+    BlackhatXfer* xfer, const char* cmd, uint32_t* value
+)
+{
+    xfer->answer_len = 0;
+
+    uint8_t id = blackhat_rpc_request(
+        xfer->rpc, cmd, blackhat_xfer_rpc_callback, xfer
+    );
+    if (!id) return "Link is busy";
+
+    if (!blackhat_xfer_wait(xfer, XferEvtAnswer, BLACKHAT_RPC_TIMEOUT_MS)) {
+        blackhat_rpc_cancel(xfer->rpc, id);
+        return xfer->cancel ? "Stopped" : "No answer";
+    }
+
+    char* end;
+    *value = strtoul(xfer->answer, &end, 10);
+    if (end == xfer->answer) {
+        FURI_LOG_E(TAG, "\"%s\": %s", cmd, xfer->answer);
+        return "Device refused";
+    }
+
+    return NULL;
+}
+
+// CRC-32 of the first `len` bytes of the open file, leaves it at `len`
+static bool blackhat_xfer_crc_prefix(
+    BlackhatXfer* xfer, uint32_t len, uint32_t* crc
+)
+{
+    *crc = 0;
+    if (!storage_file_seek(xfer->file, 0, true)) return false;
+
+    while (len) {
+        size_t n = storage_file_read(
+            xfer->file, xfer->block, MIN(len, BLACKHAT_XFER_BLOCK)
+        );
+        if (!n) return false;
+        *crc = blackhat_crc32(*crc, xfer->block, n);
+        len -= n;
+    }
+
+    return true;
+}
+
+static const char* blackhat_xfer_push(BlackhatXfer* xfer)
+{
+    char cmd[32 + BLACKHAT_XFER_PATH_SIZE];
+    uint32_t size, offset, crc;
+
+    if (!storage_file_open(
+            xfer->file, xfer->local, FSAM_READ, FSOM_OPEN_EXISTING
+        )) {
+        return "Can't open file";
+    }
+    size = storage_file_size(xfer->file);
+
+    snprintf(
+        cmd,
+        sizeof(cmd),
+        BLACKHAT_XFER_CMD " put %lu %s",
+        (unsigned long)size,
+        xfer->remote
+    );
+    const char* error = blackhat_xfer_open(xfer, cmd, &offset);
+    if (error) return error;
+    if (offset > size) return "Device copy is bigger";
+
+    // The device checks the whole file, the part it already had included
+    if (!blackhat_xfer_crc_prefix(xfer, offset, &crc)) return "Read error";
+
+    furi_mutex_acquire(xfer->mutex, FuriWaitForever);
+    xfer->status.state = BlackhatXferRunning;
+    xfer->status.size = size;
+    xfer->status.offset = offset;
+    xfer->status.done = offset;
+    furi_mutex_release(xfer->mutex);
+    xfer->started_at = furi_get_tick();
+
+    xfer->ack = offset;
+    xfer->dup_acks = 0;
+
+    uint32_t acked = offset;
+    uint32_t next = offset;
+    uint32_t crc_end = offset;
+    // After going back, acks for frames already on the way repeat too
+    uint32_t rewound_at = UINT32_MAX;
+    uint32_t retries = 0;
+
+    while (acked < size) {
+        while (next < size && next - acked < XFER_WINDOW_BYTES) {
+            size_t n = storage_file_read(
+                xfer->file,
+                xfer->block + 4,
+                MIN(size - next, BLACKHAT_XFER_BLOCK)
+            );
+            if (!n) return "Read error";
+
+            // Resent blocks were counted the first time
+            if (next + n > crc_end) {
+                uint32_t skip = crc_end - next;
+                crc = blackhat_crc32(crc, xfer->block + 4 + skip, n - skip);
+                crc_end = next + n;
+            }
+
+            blackhat_xfer_put_u32(xfer->block, next);
+            blackhat_xfer_send(xfer, XFER_DATA, xfer->block, 4 + n);
+            next += n;
+        }
+
+        uint32_t events =
+            blackhat_xfer_wait(xfer, XferEvtAck, BLACKHAT_XFER_TIMEOUT_MS);
+        if (xfer->cancel) return "Stopped";
+
+        uint32_t ack, dups;
+        FURI_CRITICAL_ENTER();
+        ack = xfer->ack;
+        dups = xfer->dup_acks;
+        FURI_CRITICAL_EXIT();
+
+        if (ack > acked && ack <= next) {
+            acked = ack;
+            retries = 0;
+            blackhat_xfer_progress(xfer, acked);
+            continue;
+        }
+
+        if (events) {
+            // A repeated ack means a block went missing
+            if (dups < 2 || rewound_at == acked) continue;
+        } else if (++retries > BLACKHAT_XFER_RETRIES) {
+            return "Device stopped acking";
+        }
+
+        FURI_LOG_D(TAG, "Back to %lu", (unsigned long)acked);
+        FURI_CRITICAL_ENTER();
+        xfer->dup_acks = 0;
+        FURI_CRITICAL_EXIT();
+        rewound_at = acked;
+
+        furi_mutex_acquire(xfer->mutex, FuriWaitForever);
+        xfer->status.resent +=
+            (next - acked + BLACKHAT_XFER_BLOCK - 1) / BLACKHAT_XFER_BLOCK;
+        furi_mutex_release(xfer->mutex);
+
+        next = acked;
+        if (!storage_file_seek(xfer->file, next, true)) return "Seek error";
+    }
+
+    blackhat_xfer_set_state(xfer, BlackhatXferVerifying);
+
+    uint8_t done[8];
+    blackhat_xfer_put_u32(done, size);
+    blackhat_xfer_put_u32(done + 4, crc);
+
+    for (retries = 0; retries <= BLACKHAT_XFER_RETRIES; retries++) {
+        blackhat_xfer_send(xfer, XFER_DONE, done, sizeof(done));
+        if (blackhat_xfer_wait(
+                xfer, XferEvtResult, BLACKHAT_XFER_TIMEOUT_MS
+            )) {
+            return xfer->result ? "CRC mismatch" : NULL;
+        }
+        if (xfer->cancel) return "Stopped";
+    }
+
+    return "No result";
+}
+
+static const char* blackhat_xfer_pull(BlackhatXfer* xfer)
+{
+    char cmd[32 + BLACKHAT_XFER_PATH_SIZE];
+    uint32_t size, offset, crc;
+
+    storage_simply_mkdir(xfer->storage, BLACKHAT_XFER_DIR);
+    if (!storage_file_open(
+            xfer->file, xfer->local, FSAM_READ_WRITE, FSOM_OPEN_ALWAYS
+        )) {
+        return "Can't open file";
+    }
+
+    // Whatever an earlier attempt saved is kept and checked at the end
+    offset = storage_file_size(xfer->file);
+    if (!blackhat_xfer_crc_prefix(xfer, offset, &crc)) return "Read error";
+
+    furi_stream_buffer_reset(xfer->rx);
+    xfer->expected = offset;
+    xfer->done_size = UINT32_MAX;
+
+    snprintf(
+        cmd,
+        sizeof(cmd),
+        BLACKHAT_XFER_CMD " get %lu %s",
+        (unsigned long)offset,
+        xfer->remote
+    );
+    const char* error = blackhat_xfer_open(xfer, cmd, &size);
+    if (error) return error;
+    if (offset > size) return "Local copy is bigger";
+
+    furi_mutex_acquire(xfer->mutex, FuriWaitForever);
+    xfer->status.state = BlackhatXferRunning;
+    xfer->status.size = size;
+    xfer->status.offset = offset;
+    xfer->status.done = offset;
+    furi_mutex_release(xfer->mutex);
+    xfer->started_at = furi_get_tick();
+
+    uint32_t written = offset;
+    uint32_t retries = 0;
+
+    while (written < size || xfer->done_size == UINT32_MAX) {
+        uint32_t events = blackhat_xfer_wait(
+            xfer, XferEvtData | XferEvtDone, BLACKHAT_XFER_TIMEOUT_MS
+        );
+        if (xfer->cancel) return "Stopped";
+
+        size_t n;
+        while ((n = furi_stream_buffer_receive(
+                    xfer->rx, xfer->block, BLACKHAT_XFER_BLOCK, 0
+                ))) {
+            if (storage_file_write(xfer->file, xfer->block, n) != n) {
+                return "Write error";
+            }
+            crc = blackhat_crc32(crc, xfer->block, n);
+            written += n;
+        }
+        if (written > size) return "Device sent too much";
+        blackhat_xfer_progress(xfer, written);
+
+        if (events) {
+            retries = 0;
+        } else if (++retries > BLACKHAT_XFER_RETRIES) {
+            return "Device stopped sending";
+        }
+
+        // New data gets an ack, a quiet link gets a reminder
+        blackhat_xfer_send_u32(xfer, XFER_ACK, xfer->expected);
+    }
+
+    blackhat_xfer_set_state(xfer, BlackhatXferVerifying);
+
+    uint8_t result = xfer->done_size != size || xfer->done_crc != crc;
+    do {
+        blackhat_xfer_send(xfer, XFER_RESULT, &result, sizeof(result));
+    } while (blackhat_xfer_wait(xfer, XferEvtDone, XFER_LINGER_MS));
+
+    if (result) {
+        // Resuming on top of a bad copy would only fail again
+        storage_file_close(xfer->file);
+        storage_simply_remove(xfer->storage, xfer->local);
+        return "CRC mismatch";
+    }
+
+    return NULL;
+}
+
+static int32_t blackhat_xfer_worker(void* context)
+{
+    BlackhatXfer* xfer = context;
+
+    const char* error =
+        xfer->push ? blackhat_xfer_push(xfer) : blackhat_xfer_pull(xfer);
+    storage_file_close(xfer->file);
+
+    furi_mutex_acquire(xfer->mutex, FuriWaitForever);
+    xfer->status.state = error ? BlackhatXferFailed : BlackhatXferDone;
+    xfer->status.error = error;
+    furi_mutex_release(xfer->mutex);
+
+    if (error) {
+        FURI_LOG_E(TAG, "%s: %s", xfer->local, error);
+    } else {
+        FURI_LOG_I(
+            TAG,
+            "%s: %lu bytes, %lu B/s",
+            xfer->local,
+            (unsigned long)xfer->status.size,
+            (unsigned long)xfer->status.bytes_per_s
+        );
+    }
+
+    // Stays until stopped, the UART worker may still flag it
+    if (!xfer->cancel) {
+        furi_thread_flags_wait(XferEvtStop, FuriFlagWaitAny, FuriWaitForever);
+    }
+
+    return 0;
+}
+
+void blackhat_xfer_feed(
+    BlackhatXfer* xfer, uint8_t kind, const uint8_t* data, size_t len
+)
+{
+    if (!xfer->running) return;
+
+    switch (kind) {
+    case XFER_DATA:
+        if (xfer->push || len < 4) break;
+        // Only the next block in order is kept, the sender repeats the rest
+        if (blackhat_xfer_get_u32(data) == xfer->expected &&
+            furi_stream_buffer_spaces_available(xfer->rx) >= len - 4) {
+            furi_stream_buffer_send(xfer->rx, data + 4, len - 4, 0);
+            xfer->expected += len - 4;
+        }
+        blackhat_xfer_signal(xfer, XferEvtData);
+        break;
+    case XFER_ACK: {
+        if (!xfer->push || len < 4) break;
+        uint32_t ack = blackhat_xfer_get_u32(data);
+        FURI_CRITICAL_ENTER();
+        if (ack > xfer->ack) {
+            xfer->ack = ack;
+            xfer->dup_acks = 0;
+        } else if (ack == xfer->ack) {
+            xfer->dup_acks++;
+        }
+        FURI_CRITICAL_EXIT();
+        blackhat_xfer_signal(xfer, XferEvtAck);
+        break;
+    }
+    case XFER_DONE:
+        if (xfer->push || len < 8) break;
+        xfer->done_crc = blackhat_xfer_get_u32(data + 4);
+        xfer->done_size = blackhat_xfer_get_u32(data);
+        blackhat_xfer_signal(xfer, XferEvtDone);
+        break;
+    case XFER_RESULT:
+        if (!xfer->push || len < 1) break;
+        xfer->result = data[0];
+        blackhat_xfer_signal(xfer, XferEvtResult);
+        break;
+    default:
+        break;
+    }
+}
+
+void blackhat_xfer_start(
+    BlackhatXfer* xfer, bool push, const char* local, const char* remote
+)
+{
+    blackhat_xfer_stop(xfer);
+
+    xfer->push = push;
+    strlcpy(xfer->local, local, sizeof(xfer->local));
+    strlcpy(xfer->remote, remote, sizeof(xfer->remote));
+
+    furi_mutex_acquire(xfer->mutex, FuriWaitForever);
+    memset(&xfer->status, 0, sizeof(xfer->status));
+    xfer->status.state = BlackhatXferOpening;
+    xfer->status.push = push;
+    furi_mutex_release(xfer->mutex);
+
+    FURI_LOG_I(TAG, "%s %s %s", push ? "Push" : "Pull", local, remote);
+
+    // Set first, the device may answer before the worker is scheduled again
+    xfer->cancel = false;
+    xfer->running = true;
+    furi_thread_start(xfer->thread);
+}
+
+void blackhat_xfer_stop(BlackhatXfer* xfer)
+{
+    if (!xfer->running) return;
+
+    xfer->running = false;
+    blackhat_xfer_signal(xfer, XferEvtStop);
+    furi_thread_join(xfer->thread);
+}
+
+void blackhat_xfer_get_status(BlackhatXfer* xfer, BlackhatXferStatus* status)
+{
+    furi_mutex_acquire(xfer->mutex, FuriWaitForever);
+    *status = xfer->status;
+    furi_mutex_release(xfer->mutex);
+}
+
+BlackhatXfer* blackhat_xfer_alloc(BlackhatRpc* rpc, BlackhatUart* uart)
+{
+    BlackhatXfer* xfer = malloc(sizeof(BlackhatXfer));
+    memset(xfer, 0, sizeof(BlackhatXfer));
+    xfer->rpc = rpc;
+    xfer->uart = uart;
+    xfer->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    xfer->rx = furi_stream_buffer_alloc(XFER_WINDOW_BYTES, 1);
+    xfer->storage = furi_record_open(RECORD_STORAGE);
+    xfer->file = storage_file_alloc(xfer->storage);
+
+    xfer->thread = furi_thread_alloc();
+    furi_thread_set_name(xfer->thread, "BlackhatXferThread");
+    furi_thread_set_stack_size(xfer->thread, 2048);
+    furi_thread_set_priority(xfer->thread, FuriThreadPriorityLow);
+    furi_thread_set_context(xfer->thread, xfer);
+    furi_thread_set_callback(xfer->thread, blackhat_xfer_worker);
+
+    return xfer;
+}
+
+void blackhat_xfer_free(BlackhatXfer* xfer)
+{
+    furi_assert(xfer);
+
+    blackhat_xfer_stop(xfer);
+    storage_file_free(xfer->file);
+    furi_record_close(RECORD_STORAGE);
+    furi_stream_buffer_free(xfer->rx);
+    furi_mutex_free(xfer->mutex);
+    furi_thread_free(xfer->thread);
+    free(xfer);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <furi.h>
+
+#include "blackhat_rpc.h"
+#include "blackhat_uart.h"
+
+// File transfer over the bulk channel, to push portal pages or scripts to
+// the device and pull captures off it. A transfer is opened with an RPC
+// request whose answer is a decimal number, the path goes last:
+//
+//   bh xfer put <size> <path>     -> bytes of <path> the device already has
+//   bh xfer get <offset> <path>   -> size of <path>, data follows
+//   bh xfer ls                    -> the files in BLACKHAT_XFER_REMOTE_DIR
+//
+// Data then flows as BlackhatProtoBulk frames, the frame id is the kind and
+// numbers are u32 little endian:
+//
+//   XFER_DATA    offset | data           at most BLACKHAT_XFER_BLOCK bytes
+//   XFER_ACK     offset                  everything before it is kept
+//   XFER_DONE    size | crc32            the sender is through
+//   XFER_RESULT  status                  0 when the CRC-32 matched
+//
+// The sender keeps up to BLACKHAT_XFER_WINDOW blocks in flight so the link
+// never idles on a round trip. The receiver acks what it got with the next
+// offset it wants and drops anything out of order, so repeated acks or a
+// quiet link send the sender back to the last acked offset. The CRC-32 at
+// the end covers the whole file, a resumed part that differs is caught too.
+
+#define BLACKHAT_XFER_CMD "bh xfer"
+#define BLACKHAT_XFER_DIR APP_DATA_PATH("xfer")
+#define BLACKHAT_XFER_REMOTE_DIR "/root/xfer"
+#define BLACKHAT_XFER_PATH_SIZE (128)
+
+#define XFER_DATA (0x01)
+#define XFER_ACK (0x02)
+#define XFER_DONE (0x03)
+#define XFER_RESULT (0x04)
+
+#define BLACKHAT_XFER_BLOCK (256)
+#define BLACKHAT_XFER_WINDOW (8)
+#define BLACKHAT_XFER_TIMEOUT_MS (1000)
+#define BLACKHAT_XFER_RETRIES (10)
+
+typedef enum {
+    BlackhatXferIdle,
+    BlackhatXferOpening,
+    BlackhatXferRunning,
+    BlackhatXferVerifying,
+    BlackhatXferDone,
+    BlackhatXferFailed,
+} BlackhatXferState;
+
+typedef struct {
+    BlackhatXferState state;
+    bool push;
+    uint32_t size;
+    // Where it resumed, and how far it got
+    uint32_t offset;
+    uint32_t done;
+    uint32_t bytes_per_s;
+    uint32_t resent;
+    const char* error;
+} BlackhatXferStatus;
+
+typedef struct BlackhatXfer BlackhatXfer;
+
+BlackhatXfer* blackhat_xfer_alloc(BlackhatRpc* rpc, BlackhatUart* uart);
+void blackhat_xfer_free(BlackhatXfer* xfer);
+
+// Runs on its own thread until done, failed or stopped. A stopped transfer
+// resumes where it left off when started again with the same paths.
+void blackhat_xfer_start(
+    BlackhatXfer* xfer, bool push, const char* local, const char* remote
+);
+void blackhat_xfer_stop(BlackhatXfer* xfer);
+
+// Called with every bulk frame from the UART worker, never blocks
+void blackhat_xfer_feed(
+    BlackhatXfer* xfer, uint8_t kind, const uint8_t* data, size_t len
+);
+
+void blackhat_xfer_get_status(BlackhatXfer* xfer, BlackhatXferStatus* status);
@@ -0,0 +1,116 @@
+#include "../blackhat_fake.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Serves the scripted device on a PTY, for blackhat_host or a terminal
+
+#define TAG "FakePty"
+
+#define PTY_READ_SIZE (256)
+#define PTY_POLL_MS (20)
+
+typedef struct {
+    speed_t speed;
+    uint32_t baud;
+} FakePtySpeed;
+
+static const FakePtySpeed fake_pty_speeds[] = {
+    {B9600, 9600},
+    {B19200, 19200},
+    {B38400, 38400},
+    {B57600, 57600},
+    {B115200, 115200},
+    {B230400, 230400},
+    {B460800, 460800},
+    {B500000, 500000},
+    {B576000, 576000},
+    {B921600, 921600},
+    {B1000000, 1000000},
+    {B1152000, 1152000},
+    {B1500000, 1500000},
+    {B2000000, 2000000},
+    {B3000000, 3000000},
+    {B4000000, 4000000},
+};
+
+static void fake_pty_rx_callback(const uint8_t* data, size_t len, void* context)
+{
+    int master = *(int*)context;
+    while (len) {
+        ssize_t written = write(master, data, len);
+        if (written < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            return;
+        }
+        data += written;
+        len -= written;
+    }
+}
+
+// The app sets the rate on its end, the fake paces its answers to match
+static uint32_t fake_pty_baud(int slave)
+{
+    struct termios tio;
+    if (tcgetattr(slave, &tio)) return 0;
+
+    speed_t speed = cfgetospeed(&tio);
+    for (size_t i = 0; i < COUNT_OF(fake_pty_speeds); i++) {
+        if (fake_pty_speeds[i].speed == speed) return fake_pty_speeds[i].baud;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) || unlockpt(master)) {
+        perror("posix_openpt");
+        return 1;
+    }
+
+    // Held open so the PTY outlives each run of the app
+    const char* name = ptsname(master);
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave < 0) {
+        perror(name);
+        return 1;
+    }
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B115200);
+    cfsetospeed(&tio, B115200);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    printf("%s\n", name);
+    fflush(stdout);
+
+    BlackhatFake* fake = blackhat_fake_alloc(fake_pty_rx_callback, &master);
+    uint32_t baud = 0;
+    uint8_t buf[PTY_READ_SIZE];
+
+    while (1) {
+        uint32_t now_baud = fake_pty_baud(slave);
+        if (now_baud && now_baud != baud) {
+            baud = now_baud;
+            blackhat_fake_set_baud(fake, baud);
+            FURI_LOG_I(TAG, "%lu baud", (unsigned long)baud);
+        }
+
+        struct pollfd pfd = {.fd = master, .events = POLLIN};
+        if (poll(&pfd, 1, PTY_POLL_MS) <= 0) continue;
+
+        ssize_t len = read(master, buf, sizeof(buf));
+        if (len < 0 && errno != EINTR && errno != EAGAIN) break;
+        if (len > 0) blackhat_fake_write(fake, buf, len);
+    }
+
+    blackhat_fake_free(fake);
+    close(slave);
+    close(master);
+    return 0;
+}
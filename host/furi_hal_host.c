@@ -0,0 +1,370 @@
+#include <furi_hal.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TAG "FuriHalHost"
+
+#define SERIAL_READ_SIZE (64)
+#define SERIAL_DMA_SIZE (2048)
+#define SERIAL_POLL_MS (20)
+
+struct FuriHalSerialHandle {
+    FuriHalSerialId id;
+    int fd;
+    uint32_t baud;
+
+    pthread_t rx_thread;
+    volatile bool rx_running;
+    FuriHalSerialAsyncRxCallback async_cb;
+    FuriHalSerialDmaRxCallback dma_cb;
+    void* context;
+
+    // The byte handed to the async callback, or the DMA ring
+    uint8_t rx_byte;
+    pthread_mutex_t dma_lock;
+    uint8_t dma[SERIAL_DMA_SIZE];
+    size_t dma_head;
+    size_t dma_used;
+};
+
+typedef struct {
+    uint32_t baud;
+    speed_t speed;
+} FuriHalSerialSpeed;
+
+static const FuriHalSerialSpeed furi_hal_serial_speeds[] = {
+    {9600, B9600},
+    {19200, B19200},
+    {38400, B38400},
+    {57600, B57600},
+    {115200, B115200},
+    {230400, B230400},
+    {460800, B460800},
+    {500000, B500000},
+    {576000, B576000},
+    {921600, B921600},
+    {1000000, B1000000},
+    {1152000, B1152000},
+    {1500000, B1500000},
+    {2000000, B2000000},
+    {3000000, B3000000},
+    {4000000, B4000000},
+};
+
+static const FuriHalSerialSpeed* furi_hal_serial_find_speed(uint32_t baud)
+{
+    for (size_t i = 0; i < COUNT_OF(furi_hal_serial_speeds); i++) {
+        if (furi_hal_serial_speeds[i].baud == baud) {
+            return &furi_hal_serial_speeds[i];
+        }
+    }
+    return NULL;
+}
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId id)
+{
+    const char* path = getenv("BLACKHAT_HOST_SERIAL");
+    if (!path) {
+        FURI_LOG_E(TAG, "BLACKHAT_HOST_SERIAL is not set");
+        return NULL;
+    }
+
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        FURI_LOG_E(TAG, "%s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    FuriHalSerialHandle* handle = malloc(sizeof(FuriHalSerialHandle));
+    memset(handle, 0, sizeof(FuriHalSerialHandle));
+    handle->id = id;
+    handle->fd = fd;
+    pthread_mutex_init(&handle->dma_lock, NULL);
+    FURI_LOG_I(TAG, "Serial on %s", path);
+    return handle;
+}
+
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle)
+{
+    furi_check(!handle->rx_running);
+    close(handle->fd);
+    pthread_mutex_destroy(&handle->dma_lock);
+    free(handle);
+}
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud)
+{
+    struct termios tio;
+    furi_check(!tcgetattr(handle->fd, &tio));
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    furi_check(!tcsetattr(handle->fd, TCSANOW, &tio));
+
+    furi_hal_serial_set_br(handle, baud);
+}
+
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle)
+{
+    tcdrain(handle->fd);
+}
+
+bool furi_hal_serial_is_baud_rate_supported(
+    FuriHalSerialHandle* handle, uint32_t baud
+)
+{
+    UNUSED(handle);
+    return furi_hal_serial_find_speed(baud) != NULL;
+}
+
+void furi_hal_serial_set_br(FuriHalSerialHandle* handle, uint32_t baud)
+{
+    const FuriHalSerialSpeed* speed = furi_hal_serial_find_speed(baud);
+    furi_check(speed);
+
+    struct termios tio;
+    furi_check(!tcgetattr(handle->fd, &tio));
+    cfsetispeed(&tio, speed->speed);
+    cfsetospeed(&tio, speed->speed);
+    furi_check(!tcsetattr(handle->fd, TCSADRAIN, &tio));
+    handle->baud = baud;
+}
+
+void furi_hal_serial_tx(
+    FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size
+)
+{
+    while (buffer_size) {
+        ssize_t written = write(handle->fd, buffer, buffer_size);
+        if (written < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            FURI_LOG_E(TAG, "TX: %s", strerror(errno));
+            return;
+        }
+        buffer += written;
+        buffer_size -= written;
+    }
+}
+
+void furi_hal_serial_tx_wait_complete(FuriHalSerialHandle* handle)
+{
+    tcdrain(handle->fd);
+}
+
+// Stands in for the UART interrupt, callbacks run here
+static void* furi_hal_serial_rx_body(void* context)
+{
+    FuriHalSerialHandle* handle = context;
+    uint8_t buf[SERIAL_READ_SIZE];
+    bool hung_up = false;
+
+    pthread_setname_np(pthread_self(), "SerialRxIrq");
+    while (handle->rx_running) {
+        struct pollfd pfd = {.fd = handle->fd, .events = POLLIN};
+        if (poll(&pfd, 1, SERIAL_POLL_MS) <= 0) continue;
+
+        ssize_t len = read(handle->fd, buf, sizeof(buf));
+        if (len <= 0) {
+            // The far end closed the PTY, wait for it to come back
+            if (!hung_up) FURI_LOG_W(TAG, "Serial hung up");
+            hung_up = true;
+            furi_delay_ms(100);
+            continue;
+        }
+        hung_up = false;
+
+        if (handle->async_cb) {
+            for (ssize_t i = 0; i < len; i++) {
+                handle->rx_byte = buf[i];
+                handle->async_cb(
+                    handle, FuriHalSerialRxEventData, handle->context
+                );
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&handle->dma_lock);
+        size_t free_space = SERIAL_DMA_SIZE - handle->dma_used;
+        size_t n = MIN((size_t)len, free_space);
+        for (size_t i = 0; i < n; i++) {
+            handle->dma[(handle->dma_head + handle->dma_used++) %
+                        SERIAL_DMA_SIZE] = buf[i];
+        }
+        size_t avail = handle->dma_used;
+        pthread_mutex_unlock(&handle->dma_lock);
+
+        FuriHalSerialRxEvent event =
+            FuriHalSerialRxEventData | FuriHalSerialRxEventIdle;
+        if (n < (size_t)len) event |= FuriHalSerialRxEventOverrunError;
+        handle->dma_cb(handle, event, avail, handle->context);
+    }
+
+    return NULL;
+}
+
+static void furi_hal_serial_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback async_cb,
+    FuriHalSerialDmaRxCallback dma_cb,
+    void* context
+)
+{
+    furi_check(!handle->rx_running);
+    handle->async_cb = async_cb;
+    handle->dma_cb = dma_cb;
+    handle->context = context;
+    handle->dma_head = 0;
+    handle->dma_used = 0;
+    handle->rx_running = true;
+    furi_check(
+        !pthread_create(
+            &handle->rx_thread, NULL, furi_hal_serial_rx_body, handle
+        )
+    );
+}
+
+static void furi_hal_serial_rx_stop(FuriHalSerialHandle* handle)
+{
+    if (!handle->rx_running) return;
+    handle->rx_running = false;
+    pthread_join(handle->rx_thread, NULL);
+    handle->async_cb = NULL;
+    handle->dma_cb = NULL;
+}
+
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback callback,
+    void* context,
+    bool report_errors
+)
+{
+    UNUSED(report_errors);
+    furi_hal_serial_rx_start(handle, callback, NULL, context);
+}
+
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle)
+{
+    furi_hal_serial_rx_stop(handle);
+}
+
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle)
+{
+    return handle->rx_byte;
+}
+
+void furi_hal_serial_dma_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialDmaRxCallback callback,
+    void* context,
+    bool report_errors
+)
+{
+    UNUSED(report_errors);
+    furi_hal_serial_rx_start(handle, NULL, callback, context);
+}
+
+void furi_hal_serial_dma_rx_stop(FuriHalSerialHandle* handle)
+{
+    furi_hal_serial_rx_stop(handle);
+}
+
+size_t furi_hal_serial_dma_rx(
+    FuriHalSerialHandle* handle, uint8_t* data, size_t len
+)
+{
+    pthread_mutex_lock(&handle->dma_lock);
+    size_t n = MIN(len, handle->dma_used);
+    for (size_t i = 0; i < n; i++) {
+        data[i] = handle->dma[handle->dma_head];
+        handle->dma_head = (handle->dma_head + 1) % SERIAL_DMA_SIZE;
+    }
+    handle->dma_used -= n;
+    pthread_mutex_unlock(&handle->dma_lock);
+    return n;
+}
+
+// Power
+
+static bool furi_hal_power_otg;
+
+bool furi_hal_power_is_otg_enabled(void)
+{
+    return furi_hal_power_otg;
+}
+
+bool furi_hal_power_enable_otg(void)
+{
+    furi_hal_power_otg = true;
+    return true;
+}
+
+void furi_hal_power_disable_otg(void)
+{
+    furi_hal_power_otg = false;
+}
+
+// RTC, random, cycle counter
+
+void furi_hal_rtc_get_datetime(DateTime* datetime)
+{
+    time_t now = time(NULL);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    datetime->hour = tm.tm_hour;
+    datetime->minute = tm.tm_min;
+    datetime->second = tm.tm_sec;
+    datetime->day = tm.tm_mday;
+    datetime->month = tm.tm_mon + 1;
+    datetime->year = tm.tm_year + 1900;
+    datetime->weekday = tm.tm_wday ? tm.tm_wday : 7;
+}
+
+uint32_t furi_hal_random_get(void)
+{
+    static __thread unsigned int seed;
+    if (!seed) seed = (unsigned int)time(NULL) ^ (uintptr_t)&seed;
+    return ((uint32_t)rand_r(&seed) << 16) ^ (uint32_t)rand_r(&seed);
+}
+
+#define HOST_CPU_MHZ (64)
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void)
+{
+    return HOST_CPU_MHZ;
+}
+
+DWT_Type* furi_host_dwt(void)
+{
+    static __thread DWT_Type dwt;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    dwt.CYCCNT = (uint32_t)(ns * HOST_CPU_MHZ / 1000);
+    return &dwt;
+}
+
+// Version
+
+struct Version {
+    const char* version;
+};
+
+static const Version furi_hal_version_host = {.version = "host"};
+
+const Version* furi_hal_version_get_firmware_version(void)
+{
+    return &furi_hal_version_host;
+}
+
+const char* version_get_version(const Version* version)
+{
+    return version->version;
+}
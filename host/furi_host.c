@@ -0,0 +1,790 @@
+#include <furi.h>
+
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOST_HEAP_SIZE (16 * 1024 * 1024)
+// stack_size in application.fam, reported for the thread running the app
+#define HOST_MAIN_STACK_SIZE (2 * 1024)
+
+struct FuriThread {
+    char* name;
+    FuriThreadCallback callback;
+    void* context;
+    size_t stack_size;
+    pthread_t pthread;
+    bool started;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t flags;
+};
+
+struct FuriMutex {
+    pthread_mutex_t mutex;
+};
+
+struct FuriStreamBuffer {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t* data;
+    size_t size;
+    size_t trigger;
+    size_t head;
+    size_t used;
+};
+
+struct FuriTimer {
+    FuriTimerCallback func;
+    FuriTimerType type;
+    void* context;
+    pthread_t pthread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t period;
+    uint32_t due;
+    bool running;
+    bool firing;
+    bool quit;
+};
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+static __thread FuriThread* furi_host_current;
+static pthread_mutex_t furi_host_critical =
+    PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+void furi_crash(const char* message)
+{
+    fprintf(stderr, "furi_crash: %s\n", message);
+    abort();
+}
+
+void furi_host_critical_enter(void)
+{
+    pthread_mutex_lock(&furi_host_critical);
+}
+
+void furi_host_critical_exit(void)
+{
+    pthread_mutex_unlock(&furi_host_critical);
+}
+
+// Kernel
+
+static uint64_t furi_host_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void furi_host_deadline(struct timespec* ts, uint32_t timeout)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += timeout / 1000;
+    ts->tv_nsec += (long)(timeout % 1000) * 1000000;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+static void furi_host_cond_init(pthread_cond_t* cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// False once the timeout has passed
+static bool furi_host_cond_wait(
+    pthread_cond_t* cond,
+    pthread_mutex_t* lock,
+    uint32_t timeout,
+    const struct timespec* deadline
+)
+{
+    if (timeout == FuriWaitForever) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    if (!timeout) return false;
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+uint32_t furi_get_tick(void)
+{
+    static uint64_t start;
+    if (!start) start = furi_host_now_ms() - 1;
+    return (uint32_t)(furi_host_now_ms() - start);
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds)
+{
+    return milliseconds;
+}
+
+uint32_t furi_kernel_get_tick_frequency(void)
+{
+    return 1000;
+}
+
+void furi_delay_us(uint32_t microseconds)
+{
+    struct timespec ts = {
+        .tv_sec = microseconds / 1000000,
+        .tv_nsec = (long)(microseconds % 1000000) * 1000,
+    };
+    while (nanosleep(&ts, &ts) && errno == EINTR) {
+    }
+}
+
+void furi_delay_tick(uint32_t ticks)
+{
+    furi_delay_us(ticks * 1000);
+}
+
+void furi_delay_ms(uint32_t milliseconds)
+{
+    furi_delay_us(milliseconds * 1000);
+}
+
+// Threads
+
+static FuriThread* furi_host_thread_new(void)
+{
+    FuriThread* thread = malloc(sizeof(FuriThread));
+    memset(thread, 0, sizeof(FuriThread));
+    pthread_mutex_init(&thread->lock, NULL);
+    furi_host_cond_init(&thread->cond);
+    return thread;
+}
+
+FuriThread* furi_thread_alloc(void)
+{
+    return furi_host_thread_new();
+}
+
+void furi_thread_free(FuriThread* thread)
+{
+    furi_assert(thread);
+    pthread_mutex_destroy(&thread->lock);
+    pthread_cond_destroy(&thread->cond);
+    free(thread->name);
+    free(thread);
+}
+
+void furi_thread_set_name(FuriThread* thread, const char* name)
+{
+    free(thread->name);
+    thread->name = name ? strdup(name) : NULL;
+}
+
+void furi_thread_set_stack_size(FuriThread* thread, size_t stack_size)
+{
+    thread->stack_size = stack_size;
+}
+
+void furi_thread_set_context(FuriThread* thread, void* context)
+{
+    thread->context = context;
+}
+
+void furi_thread_set_callback(FuriThread* thread, FuriThreadCallback callback)
+{
+    thread->callback = callback;
+}
+
+void furi_thread_set_priority(FuriThread* thread, FuriThreadPriority priority)
+{
+    UNUSED(thread);
+    UNUSED(priority);
+}
+
+static void* furi_host_thread_body(void* context)
+{
+    FuriThread* thread = context;
+    furi_host_current = thread;
+    if (thread->name) {
+        char name[16];
+        strlcpy(name, thread->name, sizeof(name));
+        pthread_setname_np(pthread_self(), name);
+    }
+    thread->callback(thread->context);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread)
+{
+    furi_check(thread->callback);
+    furi_check(!thread->started);
+
+    pthread_mutex_lock(&thread->lock);
+    thread->flags = 0;
+    pthread_mutex_unlock(&thread->lock);
+
+    thread->started = true;
+    furi_check(
+        !pthread_create(
+            &thread->pthread, NULL, furi_host_thread_body, thread
+        )
+    );
+}
+
+bool furi_thread_join(FuriThread* thread)
+{
+    furi_check(thread->started);
+    pthread_join(thread->pthread, NULL);
+    thread->started = false;
+    return true;
+}
+
+FuriThreadId furi_thread_get_id(FuriThread* thread)
+{
+    return thread;
+}
+
+FuriThreadId furi_thread_get_current_id(void)
+{
+    // Threads furi didn't start, main among them, get one on first use
+    if (!furi_host_current) {
+        furi_host_current = furi_host_thread_new();
+        furi_thread_set_name(furi_host_current, "main");
+        furi_host_current->stack_size = HOST_MAIN_STACK_SIZE;
+    }
+    return furi_host_current;
+}
+
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id)
+{
+    return thread_id ? thread_id->stack_size : 0;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags)
+{
+    furi_check(thread_id);
+    pthread_mutex_lock(&thread_id->lock);
+    thread_id->flags |= flags;
+    uint32_t result = thread_id->flags;
+    pthread_cond_broadcast(&thread_id->cond);
+    pthread_mutex_unlock(&thread_id->lock);
+    return result;
+}
+
+uint32_t furi_thread_flags_clear(uint32_t flags)
+{
+    FuriThread* thread = furi_thread_get_current_id();
+    pthread_mutex_lock(&thread->lock);
+    uint32_t result = thread->flags;
+    thread->flags &= ~flags;
+    pthread_mutex_unlock(&thread->lock);
+    return result;
+}
+
+uint32_t furi_thread_flags_wait(
+    uint32_t flags, uint32_t options, uint32_t timeout
+)
+{
+    FuriThread* thread = furi_thread_get_current_id();
+    struct timespec deadline;
+    furi_host_deadline(&deadline, timeout);
+
+    pthread_mutex_lock(&thread->lock);
+    uint32_t result;
+    while (1) {
+        result = thread->flags & flags;
+        bool done = (options & FuriFlagWaitAll) ? result == flags : result;
+        if (done) {
+            if (!(options & FuriFlagNoClear)) thread->flags &= ~result;
+            break;
+        }
+        if (!furi_host_cond_wait(
+                &thread->cond, &thread->lock, timeout, &deadline
+            )) {
+            result = timeout ? FuriFlagErrorTimeout : FuriFlagErrorResource;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&thread->lock);
+
+    return result;
+}
+
+// Mutex
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type)
+{
+    FuriMutex* instance = malloc(sizeof(FuriMutex));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(
+        &attr,
+        type == FuriMutexTypeRecursive ? PTHREAD_MUTEX_RECURSIVE :
+                                         PTHREAD_MUTEX_ERRORCHECK
+    );
+    pthread_mutex_init(&instance->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return instance;
+}
+
+void furi_mutex_free(FuriMutex* instance)
+{
+    furi_assert(instance);
+    pthread_mutex_destroy(&instance->mutex);
+    free(instance);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout)
+{
+    int err;
+    if (timeout == FuriWaitForever) {
+        err = pthread_mutex_lock(&instance->mutex);
+    } else if (!timeout) {
+        err = pthread_mutex_trylock(&instance->mutex);
+    } else {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        err = pthread_mutex_timedlock(&instance->mutex, &deadline);
+    }
+
+    // Locking a normal mutex twice would hang the firmware too
+    furi_check(err != EDEADLK);
+    if (err == EBUSY || err == ETIMEDOUT) return FuriStatusErrorTimeout;
+    return err ? FuriStatusError : FuriStatusOk;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* instance)
+{
+    return pthread_mutex_unlock(&instance->mutex) ? FuriStatusErrorResource :
+                                                     FuriStatusOk;
+}
+
+// Stream buffer
+
+FuriStreamBuffer* furi_stream_buffer_alloc(size_t size, size_t trigger_level)
+{
+    FuriStreamBuffer* stream_buffer = malloc(sizeof(FuriStreamBuffer));
+    pthread_mutex_init(&stream_buffer->lock, NULL);
+    furi_host_cond_init(&stream_buffer->cond);
+    stream_buffer->data = malloc(size);
+    stream_buffer->size = size;
+    stream_buffer->trigger = trigger_level ? trigger_level : 1;
+    stream_buffer->head = 0;
+    stream_buffer->used = 0;
+    return stream_buffer;
+}
+
+void furi_stream_buffer_free(FuriStreamBuffer* stream_buffer)
+{
+    furi_assert(stream_buffer);
+    pthread_mutex_destroy(&stream_buffer->lock);
+    pthread_cond_destroy(&stream_buffer->cond);
+    free(stream_buffer->data);
+    free(stream_buffer);
+}
+
+size_t furi_stream_buffer_send(
+    FuriStreamBuffer* stream_buffer,
+    const void* data,
+    size_t length,
+    uint32_t timeout
+)
+{
+    FuriStreamBuffer* sb = stream_buffer;
+    const uint8_t* bytes = data;
+    size_t sent = 0;
+    struct timespec deadline;
+    furi_host_deadline(&deadline, timeout);
+
+    pthread_mutex_lock(&sb->lock);
+    while (1) {
+        while (sent < length && sb->used < sb->size) {
+            sb->data[(sb->head + sb->used) % sb->size] = bytes[sent++];
+            sb->used++;
+        }
+        if (sent) pthread_cond_broadcast(&sb->cond);
+        if (sent == length) break;
+        if (!furi_host_cond_wait(&sb->cond, &sb->lock, timeout, &deadline)) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sb->lock);
+
+    return sent;
+}
+
+size_t furi_stream_buffer_receive(
+    FuriStreamBuffer* stream_buffer,
+    void* data,
+    size_t length,
+    uint32_t timeout
+)
+{
+    FuriStreamBuffer* sb = stream_buffer;
+    uint8_t* bytes = data;
+    size_t received = 0;
+    struct timespec deadline;
+    furi_host_deadline(&deadline, timeout);
+
+    pthread_mutex_lock(&sb->lock);
+    while (sb->used < MIN(sb->trigger, length)) {
+        if (!furi_host_cond_wait(&sb->cond, &sb->lock, timeout, &deadline)) {
+            break;
+        }
+    }
+    while (received < length && sb->used) {
+        bytes[received++] = sb->data[sb->head];
+        sb->head = (sb->head + 1) % sb->size;
+        sb->used--;
+    }
+    if (received) pthread_cond_broadcast(&sb->cond);
+    pthread_mutex_unlock(&sb->lock);
+
+    return received;
+}
+
+size_t furi_stream_buffer_bytes_available(FuriStreamBuffer* stream_buffer)
+{
+    pthread_mutex_lock(&stream_buffer->lock);
+    size_t used = stream_buffer->used;
+    pthread_mutex_unlock(&stream_buffer->lock);
+    return used;
+}
+
+size_t furi_stream_buffer_spaces_available(FuriStreamBuffer* stream_buffer)
+{
+    return stream_buffer->size -
+           furi_stream_buffer_bytes_available(stream_buffer);
+}
+
+bool furi_stream_buffer_is_empty(FuriStreamBuffer* stream_buffer)
+{
+    return !furi_stream_buffer_bytes_available(stream_buffer);
+}
+
+FuriStatus furi_stream_buffer_reset(FuriStreamBuffer* stream_buffer)
+{
+    pthread_mutex_lock(&stream_buffer->lock);
+    stream_buffer->head = 0;
+    stream_buffer->used = 0;
+    pthread_cond_broadcast(&stream_buffer->cond);
+    pthread_mutex_unlock(&stream_buffer->lock);
+    return FuriStatusOk;
+}
+
+// Timers
+
+static void* furi_host_timer_body(void* context)
+{
+    FuriTimer* timer = context;
+
+    pthread_setname_np(pthread_self(), "FuriTimer");
+    pthread_mutex_lock(&timer->lock);
+    while (!timer->quit) {
+        if (!timer->running) {
+            pthread_cond_wait(&timer->cond, &timer->lock);
+            continue;
+        }
+
+        int32_t wait = (int32_t)(timer->due - furi_get_tick());
+        if (wait > 0) {
+            struct timespec deadline;
+            furi_host_deadline(&deadline, wait);
+            pthread_cond_timedwait(&timer->cond, &timer->lock, &deadline);
+            continue;
+        }
+
+        if (timer->type == FuriTimerTypePeriodic) {
+            timer->due += timer->period;
+        } else {
+            timer->running = false;
+        }
+        timer->firing = true;
+        pthread_mutex_unlock(&timer->lock);
+        timer->func(timer->context);
+        pthread_mutex_lock(&timer->lock);
+        timer->firing = false;
+        pthread_cond_broadcast(&timer->cond);
+    }
+    pthread_mutex_unlock(&timer->lock);
+
+    return NULL;
+}
+
+FuriTimer* furi_timer_alloc(
+    FuriTimerCallback func, FuriTimerType type, void* context
+)
+{
+    FuriTimer* timer = malloc(sizeof(FuriTimer));
+    memset(timer, 0, sizeof(FuriTimer));
+    timer->func = func;
+    timer->type = type;
+    timer->context = context;
+    pthread_mutex_init(&timer->lock, NULL);
+    furi_host_cond_init(&timer->cond);
+    furi_check(
+        !pthread_create(&timer->pthread, NULL, furi_host_timer_body, timer)
+    );
+    return timer;
+}
+
+void furi_timer_free(FuriTimer* instance)
+{
+    pthread_mutex_lock(&instance->lock);
+    instance->quit = true;
+    pthread_cond_broadcast(&instance->cond);
+    pthread_mutex_unlock(&instance->lock);
+    pthread_join(instance->pthread, NULL);
+
+    pthread_mutex_destroy(&instance->lock);
+    pthread_cond_destroy(&instance->cond);
+    free(instance);
+}
+
+FuriStatus furi_timer_start(FuriTimer* instance, uint32_t ticks)
+{
+    pthread_mutex_lock(&instance->lock);
+    instance->period = ticks;
+    instance->due = furi_get_tick() + ticks;
+    instance->running = true;
+    pthread_cond_broadcast(&instance->cond);
+    pthread_mutex_unlock(&instance->lock);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_timer_restart(FuriTimer* instance, uint32_t ticks)
+{
+    return furi_timer_start(instance, ticks);
+}
+
+FuriStatus furi_timer_stop(FuriTimer* instance)
+{
+    pthread_mutex_lock(&instance->lock);
+    instance->running = false;
+    pthread_cond_broadcast(&instance->cond);
+
+    // Like the timer service, a callback already running is waited for
+    if (!pthread_equal(pthread_self(), instance->pthread)) {
+        while (instance->firing) {
+            pthread_cond_wait(&instance->cond, &instance->lock);
+        }
+    }
+    pthread_mutex_unlock(&instance->lock);
+    return FuriStatusOk;
+}
+
+uint32_t furi_timer_is_running(FuriTimer* instance)
+{
+    pthread_mutex_lock(&instance->lock);
+    uint32_t running = instance->running;
+    pthread_mutex_unlock(&instance->lock);
+    return running;
+}
+
+// Records, every service is a stateless stand-in so any pointer will do
+
+void* furi_record_open(const char* name)
+{
+    return (void*)name;
+}
+
+void furi_record_close(const char* name)
+{
+    UNUSED(name);
+}
+
+// Log
+
+void furi_log_print_format(
+    FuriLogLevel level, const char* tag, const char* format, ...
+)
+{
+    static const char letters[] = "??EWIDT";
+    static int debug = -1;
+    if (debug < 0) debug = getenv("BLACKHAT_HOST_DEBUG") != NULL;
+    if (level > FuriLogLevelInfo && !debug) return;
+
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    fprintf(
+        stderr,
+        "%lu [%c][%s] %s\n",
+        (unsigned long)furi_get_tick(),
+        letters[level],
+        tag,
+        line
+    );
+}
+
+// Strings
+
+static void furi_host_string_reserve(FuriString* string, size_t size)
+{
+    if (size + 1 <= string->capacity) return;
+    string->capacity = MAX(size + 1, string->capacity * 2);
+    string->data = realloc(string->data, string->capacity);
+}
+
+FuriString* furi_string_alloc(void)
+{
+    FuriString* string = malloc(sizeof(FuriString));
+    string->size = 0;
+    string->capacity = 16;
+    string->data = malloc(string->capacity);
+    string->data[0] = '\0';
+    return string;
+}
+
+FuriString* furi_string_alloc_set(const char* cstr)
+{
+    FuriString* string = furi_string_alloc();
+    furi_string_set_str(string, cstr);
+    return string;
+}
+
+static int furi_host_string_vcat(
+    FuriString* string, const char* format, va_list args
+)
+{
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if (len < 0) return len;
+
+    furi_host_string_reserve(string, string->size + len);
+    vsnprintf(string->data + string->size, len + 1, format, args);
+    string->size += len;
+    return len;
+}
+
+FuriString* furi_string_alloc_printf(const char* format, ...)
+{
+    FuriString* string = furi_string_alloc();
+    va_list args;
+    va_start(args, format);
+    furi_host_string_vcat(string, format, args);
+    va_end(args);
+    return string;
+}
+
+void furi_string_free(FuriString* string)
+{
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string)
+{
+    string->size = 0;
+    string->data[0] = '\0';
+}
+
+void furi_string_set(FuriString* string, FuriString* source)
+{
+    furi_string_set_str(string, source->data);
+}
+
+void furi_string_set_str(FuriString* string, const char* cstr)
+{
+    furi_string_reset(string);
+    furi_string_cat_str(string, cstr);
+}
+
+bool furi_string_empty(const FuriString* string)
+{
+    return !string->size;
+}
+
+size_t furi_string_size(const FuriString* string)
+{
+    return string->size;
+}
+
+const char* furi_string_get_cstr(const FuriString* string)
+{
+    return string->data;
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...)
+{
+    furi_string_reset(string);
+    va_list args;
+    va_start(args, format);
+    int len = furi_host_string_vcat(string, format, args);
+    va_end(args);
+    return len;
+}
+
+int furi_string_cat_printf(FuriString* string, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int len = furi_host_string_vcat(string, format, args);
+    va_end(args);
+    return len;
+}
+
+void furi_string_cat_str(FuriString* string, const char* cstr)
+{
+    size_t len = strlen(cstr);
+    furi_host_string_reserve(string, string->size + len);
+    memcpy(string->data + string->size, cstr, len + 1);
+    string->size += len;
+}
+
+// Heap
+
+size_t memmgr_get_total_heap(void)
+{
+    return HOST_HEAP_SIZE;
+}
+
+size_t memmgr_get_free_heap(void)
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - info.uordblks :
+                                            0;
+}
+
+size_t memmgr_get_minimum_free_heap(void)
+{
+    return memmgr_get_free_heap();
+}
+
+size_t memmgr_heap_get_max_free_block(void)
+{
+    return memmgr_get_free_heap();
+}
+
+size_t strlcpy(char* dst, const char* src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = MIN(len, size - 1);
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
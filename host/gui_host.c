@@ -0,0 +1,1654 @@
+#include <gui/elements.h>
+#include <gui/modules/loading.h>
+#include <gui/modules/text_box.h>
+#include <gui/modules/text_input.h>
+#include <gui/modules/variable_item_list.h>
+#include <gui/scene_manager.h>
+#include <gui/view_dispatcher.h>
+
+#include <dialogs/dialogs.h>
+#include <expansion/expansion.h>
+#include <toolbox/path.h>
+
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+
+// The screen is kept as text, one cell per 5x8 pixels
+#define CELL_W (5)
+#define CELL_H (8)
+#define SCREEN_COLS (32)
+#define SCREEN_ROWS (64 / CELL_H)
+
+#define VIEW_MAX (24)
+#define SCENE_STACK_SIZE (32)
+#define KEY_QUEUE_SIZE (256)
+#define EVENT_QUEUE_SIZE (64)
+#define FRAME_MIN_MS (30)
+#define INPUT_POLL_MS (50)
+#define ESCAPE_WAIT_MS (30)
+#define SCRIPT_PAUSE_MS (1000)
+// As the firmware input service, Long comes after half a second
+#define LONG_PRESS_MS (500)
+
+// Keys read from stdin are plain characters, or one of these
+#define KEY_SPECIAL (0x100)
+
+#define KEY_BACKSPACE (0x7f)
+
+// Canvas
+
+struct Canvas {
+    char text[SCREEN_ROWS][SCREEN_COLS + 1];
+    Font font;
+    Color color;
+};
+
+size_t canvas_width(const Canvas* canvas)
+{
+    UNUSED(canvas);
+    return 128;
+}
+
+size_t canvas_height(const Canvas* canvas)
+{
+    UNUSED(canvas);
+    return 64;
+}
+
+size_t canvas_current_font_height(const Canvas* canvas)
+{
+    return canvas->font == FontBigNumbers ? 2 * CELL_H : CELL_H;
+}
+
+void canvas_clear(Canvas* canvas)
+{
+    for (size_t row = 0; row < SCREEN_ROWS; row++) {
+        memset(canvas->text[row], ' ', SCREEN_COLS);
+        canvas->text[row][SCREEN_COLS] = '\0';
+    }
+    canvas->font = FontSecondary;
+    canvas->color = ColorBlack;
+}
+
+void canvas_set_color(Canvas* canvas, Color color)
+{
+    canvas->color = color;
+}
+
+void canvas_set_font(Canvas* canvas, Font font)
+{
+    canvas->font = font;
+}
+
+static void canvas_put(
+    Canvas* canvas, int32_t col, int32_t row, const char* str
+)
+{
+    if (row < 0 || row >= SCREEN_ROWS) return;
+    for (; *str && col < SCREEN_COLS; str++, col++) {
+        if (col < 0) continue;
+        char ch = *str;
+        canvas->text[row][col] = (ch >= ' ' && ch < 0x7f) ? ch : '?';
+    }
+}
+
+// y is the baseline, as on the device
+static int32_t canvas_row(int32_t y)
+{
+    return y > 0 ? (y - 1) / CELL_H : 0;
+}
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str)
+{
+    canvas_put(canvas, x / CELL_W, canvas_row(y), str);
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str
+)
+{
+    int32_t len = strlen(str);
+    int32_t col = x / CELL_W;
+    if (horizontal == AlignRight) col -= len;
+    if (horizontal == AlignCenter) col -= len / 2;
+
+    int32_t row = canvas_row(y);
+    if (vertical == AlignTop) row = y / CELL_H;
+    if (vertical == AlignCenter) row = (y - CELL_H / 2) / CELL_H;
+    canvas_put(canvas, col, row, str);
+}
+
+void canvas_draw_glyph(Canvas* canvas, int32_t x, int32_t y, uint16_t ch)
+{
+    char str[2] = {(char)ch, '\0'};
+    canvas_put(canvas, x / CELL_W, canvas_row(y), str);
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str)
+{
+    UNUSED(canvas);
+    return strlen(str) * CELL_W;
+}
+
+size_t canvas_glyph_width(Canvas* canvas, uint16_t symbol)
+{
+    UNUSED(canvas);
+    UNUSED(symbol);
+    return CELL_W;
+}
+
+void canvas_draw_box(
+    Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height
+)
+{
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+}
+
+void canvas_draw_frame(
+    Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height
+)
+{
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+}
+
+void canvas_draw_line(
+    Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2
+)
+{
+    UNUSED(canvas);
+    UNUSED(x1);
+    UNUSED(y1);
+    UNUSED(x2);
+    UNUSED(y2);
+}
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y)
+{
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+}
+
+void canvas_draw_xbm(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height,
+    const uint8_t* bitmap
+)
+{
+    UNUSED(canvas);
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+    UNUSED(bitmap);
+}
+
+void elements_progress_bar_with_text(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    float progress,
+    const char* text
+)
+{
+    char bar[SCREEN_COLS + 1];
+    size_t cells = MIN(width / CELL_W, (size_t)SCREEN_COLS);
+    if (cells < 3) return;
+
+    size_t inner = cells - 2;
+    size_t done = CLAMP(progress, 1.0f, 0.0f) * inner;
+    bar[0] = '[';
+    for (size_t i = 0; i < inner; i++) bar[i + 1] = i < done ? '#' : '.';
+    bar[cells - 1] = ']';
+    bar[cells] = '\0';
+
+    size_t len = text ? MIN(strlen(text), inner) : 0;
+    if (len) memcpy(&bar[1 + (inner - len) / 2], text, len);
+
+    // The bar is 11 pixels tall below y
+    canvas_put(canvas, x / CELL_W, canvas_row(y + CELL_H), bar);
+}
+
+void elements_progress_bar(
+    Canvas* canvas, int32_t x, int32_t y, size_t width, float progress
+)
+{
+    elements_progress_bar_with_text(canvas, x, y, width, progress, NULL);
+}
+
+// View
+
+struct View {
+    ViewDrawCallback draw_callback;
+    ViewInputCallback input_callback;
+    ViewCustomCallback custom_callback;
+    ViewCallback enter_callback;
+    ViewCallback exit_callback;
+    void* context;
+
+    ViewModelType model_type;
+    void* model;
+    pthread_mutex_t model_lock;
+
+    // Typed characters, for the text input
+    bool (*char_callback)(int ch, void* context);
+};
+
+static void gui_host_request_redraw(void);
+
+View* view_alloc(void)
+{
+    View* view = malloc(sizeof(View));
+    memset(view, 0, sizeof(View));
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&view->model_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return view;
+}
+
+void view_free(View* view)
+{
+    furi_assert(view);
+    view_free_model(view);
+    pthread_mutex_destroy(&view->model_lock);
+    free(view);
+}
+
+void view_set_context(View* view, void* context)
+{
+    view->context = context;
+}
+
+void view_set_draw_callback(View* view, ViewDrawCallback callback)
+{
+    view->draw_callback = callback;
+}
+
+void view_set_input_callback(View* view, ViewInputCallback callback)
+{
+    view->input_callback = callback;
+}
+
+void view_set_custom_callback(View* view, ViewCustomCallback callback)
+{
+    view->custom_callback = callback;
+}
+
+void view_set_enter_callback(View* view, ViewCallback callback)
+{
+    view->enter_callback = callback;
+}
+
+void view_set_exit_callback(View* view, ViewCallback callback)
+{
+    view->exit_callback = callback;
+}
+
+void view_allocate_model(View* view, ViewModelType type, size_t size)
+{
+    furi_check(view->model_type == ViewModelTypeNone);
+    view->model_type = type;
+    view->model = malloc(size);
+    memset(view->model, 0, size);
+}
+
+void view_free_model(View* view)
+{
+    free(view->model);
+    view->model = NULL;
+    view->model_type = ViewModelTypeNone;
+}
+
+void* view_get_model(View* view)
+{
+    if (view->model_type == ViewModelTypeLocking) {
+        pthread_mutex_lock(&view->model_lock);
+    }
+    return view->model;
+}
+
+void view_commit_model(View* view, bool update)
+{
+    if (view->model_type == ViewModelTypeLocking) {
+        pthread_mutex_unlock(&view->model_lock);
+    }
+    if (update) gui_host_request_redraw();
+}
+
+static void view_draw(View* view, Canvas* canvas)
+{
+    if (!view->draw_callback) return;
+    void* model = view_get_model(view);
+    view->draw_callback(canvas, model);
+    view_commit_model(view, false);
+}
+
+// Event queue shared by the dispatcher, the stdin reader and the dialogs
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    int keys[KEY_QUEUE_SIZE];
+    size_t key_head;
+    size_t key_used;
+    uint32_t events[EVENT_QUEUE_SIZE];
+    size_t event_head;
+    size_t event_used;
+    bool redraw;
+    bool quit;
+
+    pthread_t input_thread;
+    volatile bool input_running;
+    bool tty;
+    struct termios saved_tio;
+
+    SceneManager* scene_manager;
+} gui_host = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void gui_host_request_redraw(void)
+{
+    pthread_mutex_lock(&gui_host.lock);
+    gui_host.redraw = true;
+    pthread_cond_broadcast(&gui_host.cond);
+    pthread_mutex_unlock(&gui_host.lock);
+}
+
+static void gui_host_push_key(int key)
+{
+    pthread_mutex_lock(&gui_host.lock);
+    while (gui_host.key_used == KEY_QUEUE_SIZE) {
+        pthread_cond_wait(&gui_host.cond, &gui_host.lock);
+    }
+    gui_host.keys[(gui_host.key_head + gui_host.key_used++) %
+                  KEY_QUEUE_SIZE] = key;
+    pthread_cond_broadcast(&gui_host.cond);
+    pthread_mutex_unlock(&gui_host.lock);
+}
+
+// Under gui_host.lock
+static int gui_host_pop_key(void)
+{
+    int key = gui_host.keys[gui_host.key_head];
+    gui_host.key_head = (gui_host.key_head + 1) % KEY_QUEUE_SIZE;
+    gui_host.key_used--;
+    pthread_cond_broadcast(&gui_host.cond);
+    return key;
+}
+
+static void gui_host_quit(void)
+{
+    pthread_mutex_lock(&gui_host.lock);
+    gui_host.quit = true;
+    pthread_cond_broadcast(&gui_host.cond);
+    pthread_mutex_unlock(&gui_host.lock);
+}
+
+static int gui_host_read_byte(int timeout_ms)
+{
+    struct pollfd pfd = {.fd = STDIN_FILENO, .events = POLLIN};
+    if (poll(&pfd, 1, timeout_ms) <= 0) return -1;
+
+    uint8_t byte;
+    ssize_t len = read(STDIN_FILENO, &byte, 1);
+    if (len <= 0) return -2;
+    return byte;
+}
+
+// Escape sequences for the arrows, a lone escape is Back
+static int gui_host_read_escape(void)
+{
+    if (gui_host_read_byte(ESCAPE_WAIT_MS) != '[') {
+        return KEY_SPECIAL | InputKeyBack;
+    }
+
+    switch (gui_host_read_byte(ESCAPE_WAIT_MS)) {
+    case 'A':
+        return KEY_SPECIAL | InputKeyUp;
+    case 'B':
+        return KEY_SPECIAL | InputKeyDown;
+    case 'C':
+        return KEY_SPECIAL | InputKeyRight;
+    case 'D':
+        return KEY_SPECIAL | InputKeyLeft;
+    default:
+        return -1;
+    }
+}
+
+static void* gui_host_input_body(void* context)
+{
+    UNUSED(context);
+
+    pthread_setname_np(pthread_self(), "HostInput");
+    while (gui_host.input_running) {
+        int byte = gui_host_read_byte(INPUT_POLL_MS);
+        if (byte == -1) continue;
+        if (byte == -2 || byte == 0x03) {
+            // End of a script or Ctrl-C
+            gui_host_quit();
+            break;
+        }
+
+        if (byte == '~') {
+            furi_delay_ms(SCRIPT_PAUSE_MS);
+        } else if (byte == 0x1b) {
+            int key = gui_host_read_escape();
+            if (key >= 0) gui_host_push_key(key);
+        } else {
+            gui_host_push_key(byte);
+        }
+    }
+
+    return NULL;
+}
+
+static void gui_host_input_start(void)
+{
+    gui_host.tty = isatty(STDIN_FILENO);
+    if (gui_host.tty) {
+        struct termios tio;
+        tcgetattr(STDIN_FILENO, &gui_host.saved_tio);
+        tio = gui_host.saved_tio;
+        tio.c_lflag &= ~(ICANON | ECHO | ISIG);
+        tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+    }
+
+    gui_host.input_running = true;
+    pthread_create(&gui_host.input_thread, NULL, gui_host_input_body, NULL);
+}
+
+static void gui_host_input_stop(void)
+{
+    gui_host.input_running = false;
+    pthread_join(gui_host.input_thread, NULL);
+    if (gui_host.tty) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &gui_host.saved_tio);
+    }
+}
+
+// Frame output
+
+static void gui_host_print_frame(const Canvas* canvas)
+{
+    static char last[SCREEN_ROWS][SCREEN_COLS + 1];
+    static bool quiet, checked;
+    if (!checked) {
+        quiet = getenv("BLACKHAT_HOST_QUIET") != NULL;
+        checked = true;
+    }
+    if (quiet || !memcmp(last, canvas->text, sizeof(last))) return;
+    memcpy(last, canvas->text, sizeof(last));
+
+    if (isatty(STDOUT_FILENO)) {
+        printf("\033[H\033[2J+");
+        for (size_t i = 0; i < SCREEN_COLS; i++) putchar('-');
+        printf("+\r\n");
+        for (size_t row = 0; row < SCREEN_ROWS; row++) {
+            printf("|%s|\r\n", canvas->text[row]);
+        }
+        putchar('+');
+        for (size_t i = 0; i < SCREEN_COLS; i++) putchar('-');
+        printf("+\r\n");
+    } else {
+        printf("--- %lu\n", (unsigned long)furi_get_tick());
+        for (size_t row = 0; row < SCREEN_ROWS; row++) {
+            size_t len = SCREEN_COLS;
+            while (len && canvas->text[row][len - 1] == ' ') len--;
+            printf("%.*s\n", (int)len, canvas->text[row]);
+        }
+    }
+    fflush(stdout);
+}
+
+// View dispatcher
+
+typedef struct {
+    uint32_t id;
+    View* view;
+} ViewDispatcherSlot;
+
+struct ViewDispatcher {
+    ViewDispatcherSlot views[VIEW_MAX];
+    size_t view_count;
+    View* current;
+
+    void* context;
+    ViewDispatcherCustomEventCallback custom_callback;
+    ViewDispatcherNavigationEventCallback navigation_callback;
+    ViewDispatcherTickEventCallback tick_callback;
+    uint32_t tick_period;
+
+    bool running;
+    uint32_t input_sequence;
+    // A capital holds its key down until LONG_PRESS_MS has passed
+    bool holding;
+    InputKey held;
+    uint32_t release_at;
+    Canvas canvas;
+};
+
+ViewDispatcher* view_dispatcher_alloc(void)
+{
+    ViewDispatcher* view_dispatcher = malloc(sizeof(ViewDispatcher));
+    memset(view_dispatcher, 0, sizeof(ViewDispatcher));
+    view_dispatcher->tick_period = FuriWaitForever;
+    return view_dispatcher;
+}
+
+void view_dispatcher_free(ViewDispatcher* view_dispatcher)
+{
+    furi_check(!view_dispatcher->view_count);
+    free(view_dispatcher);
+}
+
+void view_dispatcher_set_event_callback_context(
+    ViewDispatcher* view_dispatcher, void* context
+)
+{
+    view_dispatcher->context = context;
+}
+
+void view_dispatcher_set_custom_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherCustomEventCallback callback
+)
+{
+    view_dispatcher->custom_callback = callback;
+}
+
+void view_dispatcher_set_navigation_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherNavigationEventCallback callback
+)
+{
+    view_dispatcher->navigation_callback = callback;
+}
+
+void view_dispatcher_set_tick_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherTickEventCallback callback,
+    uint32_t tick_period
+)
+{
+    view_dispatcher->tick_callback = callback;
+    view_dispatcher->tick_period = tick_period;
+}
+
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher, Gui* gui, ViewDispatcherType type
+)
+{
+    UNUSED(view_dispatcher);
+    UNUSED(gui);
+    UNUSED(type);
+}
+
+void view_dispatcher_send_custom_event(
+    ViewDispatcher* view_dispatcher, uint32_t event
+)
+{
+    UNUSED(view_dispatcher);
+
+    // Waits for room like furi_message_queue_put(..., FuriWaitForever)
+    pthread_mutex_lock(&gui_host.lock);
+    while (gui_host.event_used == EVENT_QUEUE_SIZE) {
+        pthread_cond_wait(&gui_host.cond, &gui_host.lock);
+    }
+    gui_host.events[(gui_host.event_head + gui_host.event_used++) %
+                    EVENT_QUEUE_SIZE] = event;
+    pthread_cond_broadcast(&gui_host.cond);
+    pthread_mutex_unlock(&gui_host.lock);
+}
+
+void view_dispatcher_add_view(
+    ViewDispatcher* view_dispatcher, uint32_t view_id, View* view
+)
+{
+    furi_check(view_dispatcher->view_count < VIEW_MAX);
+    for (size_t i = 0; i < view_dispatcher->view_count; i++) {
+        furi_check(view_dispatcher->views[i].id != view_id);
+    }
+    view_dispatcher->views[view_dispatcher->view_count++] =
+        (ViewDispatcherSlot){.id = view_id, .view = view};
+}
+
+void view_dispatcher_remove_view(
+    ViewDispatcher* view_dispatcher, uint32_t view_id
+)
+{
+    for (size_t i = 0; i < view_dispatcher->view_count; i++) {
+        ViewDispatcherSlot* slot = &view_dispatcher->views[i];
+        if (slot->id != view_id) continue;
+
+        if (view_dispatcher->current == slot->view) {
+            view_dispatcher->current = NULL;
+        }
+        *slot = view_dispatcher->views[--view_dispatcher->view_count];
+        return;
+    }
+    furi_crash("view_dispatcher_remove_view: unknown view");
+}
+
+void view_dispatcher_switch_to_view(
+    ViewDispatcher* view_dispatcher, uint32_t view_id
+)
+{
+    View* view = NULL;
+    for (size_t i = 0; i < view_dispatcher->view_count; i++) {
+        if (view_dispatcher->views[i].id == view_id) {
+            view = view_dispatcher->views[i].view;
+        }
+    }
+    furi_check(view);
+
+    View* previous = view_dispatcher->current;
+    if (previous == view) return;
+    if (previous && previous->exit_callback) {
+        previous->exit_callback(previous->context);
+    }
+    view_dispatcher->current = view;
+    if (view->enter_callback) view->enter_callback(view->context);
+    gui_host_request_redraw();
+}
+
+void view_dispatcher_stop(ViewDispatcher* view_dispatcher)
+{
+    view_dispatcher->running = false;
+    gui_host_request_redraw();
+}
+
+static void view_dispatcher_input(
+    ViewDispatcher* view_dispatcher, InputKey key, InputType type
+)
+{
+    View* view = view_dispatcher->current;
+    InputEvent event = {
+        .sequence = view_dispatcher->input_sequence,
+        .key = key,
+        .type = type,
+    };
+
+    bool consumed = false;
+    if (view && view->input_callback) {
+        consumed = view->input_callback(&event, view->context);
+    }
+
+    if (!consumed && key == InputKeyBack && type == InputTypeShort &&
+        view_dispatcher->navigation_callback &&
+        !view_dispatcher->navigation_callback(view_dispatcher->context)) {
+        view_dispatcher_stop(view_dispatcher);
+    }
+}
+
+static bool view_dispatcher_map_key(int key, InputKey* input, bool* hold)
+{
+    *hold = false;
+    if (key & KEY_SPECIAL) {
+        *input = key & 0xff;
+        return true;
+    }
+
+    switch (key) {
+    case 'w':
+    case 'W':
+        *input = InputKeyUp;
+        break;
+    case 's':
+    case 'S':
+        *input = InputKeyDown;
+        break;
+    case 'a':
+    case 'A':
+        *input = InputKeyLeft;
+        break;
+    case 'd':
+    case 'D':
+        *input = InputKeyRight;
+        break;
+    case '\r':
+    case '\n':
+    case ' ':
+    case 'o':
+    case 'O':
+        *input = InputKeyOk;
+        break;
+    case KEY_BACKSPACE:
+    case '\b':
+    case 'b':
+    case 'B':
+        *input = InputKeyBack;
+        break;
+    default:
+        return false;
+    }
+
+    // Capitals are held down
+    *hold = key >= 'A' && key <= 'Z';
+    return true;
+}
+
+static void view_dispatcher_key(ViewDispatcher* view_dispatcher, int key)
+{
+    View* view = view_dispatcher->current;
+    if (view && view->char_callback && !(key & KEY_SPECIAL) &&
+        view->char_callback(key, view->context)) {
+        return;
+    }
+
+    InputKey input;
+    bool hold;
+    if (!view_dispatcher_map_key(key, &input, &hold)) return;
+
+    view_dispatcher->input_sequence++;
+    view_dispatcher_input(view_dispatcher, input, InputTypePress);
+    if (hold) {
+        view_dispatcher->holding = true;
+        view_dispatcher->held = input;
+        view_dispatcher->release_at = furi_get_tick() + LONG_PRESS_MS;
+        return;
+    }
+    view_dispatcher_input(view_dispatcher, input, InputTypeShort);
+    view_dispatcher_input(view_dispatcher, input, InputTypeRelease);
+}
+
+static void view_dispatcher_release(ViewDispatcher* view_dispatcher)
+{
+    view_dispatcher->holding = false;
+    view_dispatcher_input(
+        view_dispatcher, view_dispatcher->held, InputTypeLong
+    );
+    view_dispatcher_input(
+        view_dispatcher, view_dispatcher->held, InputTypeRelease
+    );
+}
+
+static void view_dispatcher_custom(
+    ViewDispatcher* view_dispatcher, uint32_t event
+)
+{
+    View* view = view_dispatcher->current;
+    if (view && view->custom_callback &&
+        view->custom_callback(event, view->context)) {
+        return;
+    }
+    if (view_dispatcher->custom_callback) {
+        view_dispatcher->custom_callback(view_dispatcher->context, event);
+    }
+}
+
+static void view_dispatcher_render(ViewDispatcher* view_dispatcher)
+{
+    Canvas* canvas = &view_dispatcher->canvas;
+    canvas_clear(canvas);
+    if (view_dispatcher->current) view_draw(view_dispatcher->current, canvas);
+    gui_host_print_frame(canvas);
+}
+
+static void scene_manager_stop(SceneManager* scene_manager);
+
+void view_dispatcher_run(ViewDispatcher* view_dispatcher)
+{
+    uint32_t next_tick = furi_get_tick() + view_dispatcher->tick_period;
+    uint32_t last_frame = furi_get_tick() - FRAME_MIN_MS;
+    bool dirty = true;
+
+    gui_host_input_start();
+    view_dispatcher->running = true;
+
+    while (view_dispatcher->running) {
+        int key = -1;
+        bool have_event = false;
+        uint32_t event = 0;
+        bool quit;
+
+        pthread_mutex_lock(&gui_host.lock);
+        while (1) {
+            uint32_t now = furi_get_tick();
+            if (gui_host.redraw) {
+                dirty = true;
+                gui_host.redraw = false;
+            }
+            // Keys wait while one is held
+            bool key_ready = gui_host.key_used && !view_dispatcher->holding;
+            if (gui_host.quit || gui_host.event_used || key_ready ||
+                !view_dispatcher->running) {
+                break;
+            }
+
+            int32_t wait = view_dispatcher->tick_callback ?
+                               (int32_t)(next_tick - now) :
+                               INPUT_POLL_MS;
+            if (dirty) {
+                wait = MIN(wait, (int32_t)(last_frame + FRAME_MIN_MS - now));
+            }
+            if (view_dispatcher->holding) {
+                wait = MIN(wait, (int32_t)(view_dispatcher->release_at - now));
+            }
+            if (wait <= 0) break;
+
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += (long)wait * 1000000;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            pthread_cond_timedwait(&gui_host.cond, &gui_host.lock, &deadline);
+        }
+
+        quit = gui_host.quit;
+        if (gui_host.event_used) {
+            event = gui_host.events[gui_host.event_head];
+            gui_host.event_head = (gui_host.event_head + 1) % EVENT_QUEUE_SIZE;
+            gui_host.event_used--;
+            have_event = true;
+            pthread_cond_broadcast(&gui_host.cond);
+        } else if (gui_host.key_used && !view_dispatcher->holding) {
+            key = gui_host_pop_key();
+        }
+        pthread_mutex_unlock(&gui_host.lock);
+
+        if (quit) {
+            // Scenes exit as if Back took the app all the way out
+            if (gui_host.scene_manager) {
+                scene_manager_stop(gui_host.scene_manager);
+            }
+            break;
+        }
+
+        if (have_event) {
+            view_dispatcher_custom(view_dispatcher, event);
+            dirty = true;
+        } else if (key >= 0) {
+            view_dispatcher_key(view_dispatcher, key);
+            dirty = true;
+        }
+
+        uint32_t now = furi_get_tick();
+        if (view_dispatcher->holding &&
+            (int32_t)(now - view_dispatcher->release_at) >= 0) {
+            view_dispatcher_release(view_dispatcher);
+            dirty = true;
+        }
+        if (view_dispatcher->tick_callback &&
+            (int32_t)(now - next_tick) >= 0) {
+            next_tick = now + view_dispatcher->tick_period;
+            view_dispatcher->tick_callback(view_dispatcher->context);
+            dirty = true;
+        }
+        if (dirty && now - last_frame >= FRAME_MIN_MS) {
+            view_dispatcher_render(view_dispatcher);
+            last_frame = now;
+            dirty = false;
+        }
+    }
+
+    gui_host_input_stop();
+}
+
+// Scene manager
+
+struct SceneManager {
+    const SceneManagerHandlers* handlers;
+    void* context;
+    uint32_t* states;
+    uint32_t stack[SCENE_STACK_SIZE];
+    size_t depth;
+};
+
+SceneManager* scene_manager_alloc(
+    const SceneManagerHandlers* app_scene_handlers, void* context
+)
+{
+    SceneManager* scene_manager = malloc(sizeof(SceneManager));
+    scene_manager->handlers = app_scene_handlers;
+    scene_manager->context = context;
+    scene_manager->states =
+        calloc(app_scene_handlers->scene_num, sizeof(uint32_t));
+    scene_manager->depth = 0;
+    gui_host.scene_manager = scene_manager;
+    return scene_manager;
+}
+
+void scene_manager_free(SceneManager* scene_manager)
+{
+    if (gui_host.scene_manager == scene_manager) {
+        gui_host.scene_manager = NULL;
+    }
+    free(scene_manager->states);
+    free(scene_manager);
+}
+
+void scene_manager_set_scene_state(
+    SceneManager* scene_manager, uint32_t scene_id, uint32_t state
+)
+{
+    furi_check(scene_id < scene_manager->handlers->scene_num);
+    scene_manager->states[scene_id] = state;
+}
+
+uint32_t scene_manager_get_scene_state(
+    const SceneManager* scene_manager, uint32_t scene_id
+)
+{
+    furi_check(scene_id < scene_manager->handlers->scene_num);
+    return scene_manager->states[scene_id];
+}
+
+static bool scene_manager_event(
+    SceneManager* scene_manager, SceneManagerEventType type, uint32_t event
+)
+{
+    if (!scene_manager->depth) return false;
+    uint32_t scene_id = scene_manager->stack[scene_manager->depth - 1];
+    SceneManagerEvent scene_event = {.type = type, .event = event};
+    return scene_manager->handlers->on_event_handlers[scene_id](
+        scene_manager->context, scene_event
+    );
+}
+
+bool scene_manager_handle_custom_event(
+    SceneManager* scene_manager, uint32_t custom_event
+)
+{
+    return scene_manager_event(
+        scene_manager, SceneManagerEventTypeCustom, custom_event
+    );
+}
+
+bool scene_manager_handle_back_event(SceneManager* scene_manager)
+{
+    if (scene_manager_event(scene_manager, SceneManagerEventTypeBack, 0)) {
+        return true;
+    }
+    return scene_manager_previous_scene(scene_manager);
+}
+
+void scene_manager_handle_tick_event(SceneManager* scene_manager)
+{
+    scene_manager_event(scene_manager, SceneManagerEventTypeTick, 0);
+}
+
+void scene_manager_next_scene(
+    SceneManager* scene_manager, uint32_t next_scene_id
+)
+{
+    furi_check(next_scene_id < scene_manager->handlers->scene_num);
+    furi_check(scene_manager->depth < SCENE_STACK_SIZE);
+
+    if (scene_manager->depth) {
+        uint32_t current = scene_manager->stack[scene_manager->depth - 1];
+        scene_manager->handlers->on_exit_handlers[current](
+            scene_manager->context
+        );
+    }
+    scene_manager->stack[scene_manager->depth++] = next_scene_id;
+    scene_manager->handlers->on_enter_handlers[next_scene_id](
+        scene_manager->context
+    );
+}
+
+bool scene_manager_previous_scene(SceneManager* scene_manager)
+{
+    if (!scene_manager->depth) return false;
+
+    uint32_t current = scene_manager->stack[--scene_manager->depth];
+    scene_manager->handlers->on_exit_handlers[current](scene_manager->context);
+    if (!scene_manager->depth) return false;
+
+    uint32_t previous = scene_manager->stack[scene_manager->depth - 1];
+    scene_manager->handlers->on_enter_handlers[previous](
+        scene_manager->context
+    );
+    return true;
+}
+
+bool scene_manager_has_previous_scene(
+    const SceneManager* scene_manager, uint32_t scene_id
+)
+{
+    for (size_t i = 0; i + 1 < scene_manager->depth; i++) {
+        if (scene_manager->stack[i] == scene_id) return true;
+    }
+    return false;
+}
+
+bool scene_manager_search_and_switch_to_previous_scene(
+    SceneManager* scene_manager, uint32_t scene_id
+)
+{
+    if (!scene_manager_has_previous_scene(scene_manager, scene_id)) {
+        return false;
+    }
+
+    uint32_t current = scene_manager->stack[--scene_manager->depth];
+    while (scene_manager->stack[scene_manager->depth - 1] != scene_id) {
+        scene_manager->depth--;
+    }
+    scene_manager->handlers->on_exit_handlers[current](scene_manager->context);
+    scene_manager->handlers->on_enter_handlers[scene_id](
+        scene_manager->context
+    );
+    return true;
+}
+
+static void scene_manager_stop(SceneManager* scene_manager)
+{
+    if (!scene_manager->depth) return;
+    uint32_t current = scene_manager->stack[scene_manager->depth - 1];
+    scene_manager->depth = 0;
+    scene_manager->handlers->on_exit_handlers[current](scene_manager->context);
+}
+
+// Variable item list
+
+struct VariableItem {
+    const char* label;
+    uint8_t current_value_index;
+    char current_value_text[32];
+    uint8_t values_count;
+    VariableItemChangeCallback change_callback;
+    void* context;
+};
+
+struct VariableItemList {
+    View* view;
+    VariableItem** items;
+    size_t count;
+    size_t capacity;
+    uint8_t selected;
+    uint8_t window;
+    VariableItemListEnterCallback enter_callback;
+    void* enter_context;
+};
+
+static void variable_item_list_draw(Canvas* canvas, void* model)
+{
+    VariableItemList* list = *(VariableItemList**)model;
+
+    if (list->selected < list->window) list->window = list->selected;
+    if (list->selected >= list->window + SCREEN_ROWS) {
+        list->window = list->selected - SCREEN_ROWS + 1;
+    }
+
+    for (size_t row = 0; row < SCREEN_ROWS; row++) {
+        size_t index = list->window + row;
+        if (index >= list->count) break;
+        VariableItem* item = list->items[index];
+
+        char line[SCREEN_COLS + 1];
+        snprintf(
+            line,
+            sizeof(line),
+            "%c%s",
+            index == list->selected ? '>' : ' ',
+            item->label ? item->label : ""
+        );
+        canvas_put(canvas, 0, row, line);
+
+        if (item->values_count > 1 || item->current_value_text[0]) {
+            snprintf(
+                line,
+                sizeof(line),
+                item->values_count > 1 ? "<%s>" : "%s",
+                item->current_value_text
+            );
+            canvas_put(canvas, SCREEN_COLS - strlen(line), row, line);
+        }
+    }
+}
+
+static bool variable_item_list_input(InputEvent* event, void* context)
+{
+    VariableItemList* list = context;
+    if (event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return event->key != InputKeyBack;
+    }
+    if (!list->count) return event->key != InputKeyBack;
+
+    VariableItem* item = list->items[list->selected];
+    switch (event->key) {
+    case InputKeyUp:
+        list->selected =
+            list->selected ? list->selected - 1u : list->count - 1;
+        return true;
+    case InputKeyDown:
+        list->selected = (list->selected + 1) % list->count;
+        return true;
+    case InputKeyLeft:
+    case InputKeyRight:
+        if (item->values_count < 2) return true;
+        if (event->key == InputKeyLeft && item->current_value_index) {
+            item->current_value_index--;
+        } else if (
+            event->key == InputKeyRight &&
+            item->current_value_index + 1 < item->values_count) {
+            item->current_value_index++;
+        } else {
+            return true;
+        }
+        if (item->change_callback) item->change_callback(item);
+        return true;
+    case InputKeyOk:
+        if (list->enter_callback) {
+            list->enter_callback(list->enter_context, list->selected);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+VariableItemList* variable_item_list_alloc(void)
+{
+    VariableItemList* list = malloc(sizeof(VariableItemList));
+    memset(list, 0, sizeof(VariableItemList));
+    list->view = view_alloc();
+    view_allocate_model(
+        list->view, ViewModelTypeLockFree, sizeof(VariableItemList*)
+    );
+    *(VariableItemList**)list->view->model = list;
+    view_set_context(list->view, list);
+    view_set_draw_callback(list->view, variable_item_list_draw);
+    view_set_input_callback(list->view, variable_item_list_input);
+    return list;
+}
+
+void variable_item_list_reset(VariableItemList* variable_item_list)
+{
+    for (size_t i = 0; i < variable_item_list->count; i++) {
+        free(variable_item_list->items[i]);
+    }
+    variable_item_list->count = 0;
+    variable_item_list->selected = 0;
+    variable_item_list->window = 0;
+    variable_item_list->enter_callback = NULL;
+}
+
+void variable_item_list_free(VariableItemList* variable_item_list)
+{
+    variable_item_list_reset(variable_item_list);
+    free(variable_item_list->items);
+    view_free(variable_item_list->view);
+    free(variable_item_list);
+}
+
+View* variable_item_list_get_view(VariableItemList* variable_item_list)
+{
+    return variable_item_list->view;
+}
+
+VariableItem* variable_item_list_add(
+    VariableItemList* variable_item_list,
+    const char* label,
+    uint8_t values_count,
+    VariableItemChangeCallback change_callback,
+    void* context
+)
+{
+    VariableItemList* list = variable_item_list;
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 8;
+        list->items =
+            realloc(list->items, list->capacity * sizeof(VariableItem*));
+    }
+
+    VariableItem* item = malloc(sizeof(VariableItem));
+    memset(item, 0, sizeof(VariableItem));
+    item->label = label;
+    item->values_count = values_count;
+    item->change_callback = change_callback;
+    item->context = context;
+    list->items[list->count++] = item;
+    return item;
+}
+
+VariableItem* variable_item_list_get(
+    VariableItemList* variable_item_list, uint8_t position
+)
+{
+    if (position >= variable_item_list->count) return NULL;
+    return variable_item_list->items[position];
+}
+
+void variable_item_list_set_enter_callback(
+    VariableItemList* variable_item_list,
+    VariableItemListEnterCallback callback,
+    void* context
+)
+{
+    variable_item_list->enter_callback = callback;
+    variable_item_list->enter_context = context;
+}
+
+void variable_item_list_set_selected_item(
+    VariableItemList* variable_item_list, uint8_t index
+)
+{
+    if (index < variable_item_list->count) {
+        variable_item_list->selected = index;
+    }
+}
+
+uint8_t variable_item_list_get_selected_item_index(
+    VariableItemList* variable_item_list
+)
+{
+    return variable_item_list->selected;
+}
+
+void variable_item_set_current_value_index(
+    VariableItem* item, uint8_t current_value_index
+)
+{
+    item->current_value_index = current_value_index;
+}
+
+void variable_item_set_values_count(VariableItem* item, uint8_t values_count)
+{
+    item->values_count = values_count;
+}
+
+void variable_item_set_current_value_text(
+    VariableItem* item, const char* current_value_text
+)
+{
+    strlcpy(
+        item->current_value_text,
+        current_value_text,
+        sizeof(item->current_value_text)
+    );
+}
+
+uint8_t variable_item_get_current_value_index(VariableItem* item)
+{
+    return item->current_value_index;
+}
+
+void* variable_item_get_context(VariableItem* item)
+{
+    return item->context;
+}
+
+// Text box
+
+struct TextBox {
+    View* view;
+    const char* text;
+    TextBoxFocus focus;
+    // Lines scrolled away from the focused end
+    size_t scroll;
+};
+
+// Starts of the wrapped lines, returns how many there are
+static size_t text_box_wrap(const char* text, const char** starts, size_t max)
+{
+    size_t count = 0;
+    const char* p = text;
+
+    while (*p) {
+        if (starts && count < max) starts[count] = p;
+        count++;
+        size_t col = 0;
+        while (*p && *p != '\n' && col < SCREEN_COLS) {
+            p++;
+            col++;
+        }
+        if (*p == '\n') p++;
+    }
+    return count;
+}
+
+static void text_box_draw(Canvas* canvas, void* model)
+{
+    TextBox* text_box = *(TextBox**)model;
+    if (!text_box->text) return;
+
+    size_t count = text_box_wrap(text_box->text, NULL, 0);
+    const char** starts = malloc(MAX(count, 1) * sizeof(char*));
+    text_box_wrap(text_box->text, starts, count);
+
+    size_t max_scroll = count > SCREEN_ROWS ? count - SCREEN_ROWS : 0;
+    text_box->scroll = MIN(text_box->scroll, max_scroll);
+    size_t first = text_box->focus == TextBoxFocusEnd ?
+                       max_scroll - text_box->scroll :
+                       text_box->scroll;
+
+    for (size_t row = 0; row < SCREEN_ROWS && first + row < count; row++) {
+        const char* start = starts[first + row];
+        char line[SCREEN_COLS + 1];
+        size_t len = 0;
+        while (start[len] && start[len] != '\n' && len < SCREEN_COLS) {
+            line[len] = start[len];
+            len++;
+        }
+        line[len] = '\0';
+        canvas_put(canvas, 0, row, line);
+    }
+    free(starts);
+}
+
+static bool text_box_input(InputEvent* event, void* context)
+{
+    TextBox* text_box = context;
+    if (event->type != InputTypeShort && event->type != InputTypeRepeat) {
+        return false;
+    }
+
+    bool toward_start = event->key == InputKeyUp;
+    if (event->key != InputKeyUp && event->key != InputKeyDown) return false;
+    if (text_box->focus == TextBoxFocusStart) toward_start = !toward_start;
+    if (toward_start) {
+        text_box->scroll++;
+    } else if (text_box->scroll) {
+        text_box->scroll--;
+    }
+    return true;
+}
+
+TextBox* text_box_alloc(void)
+{
+    TextBox* text_box = malloc(sizeof(TextBox));
+    memset(text_box, 0, sizeof(TextBox));
+    text_box->view = view_alloc();
+    view_allocate_model(
+        text_box->view, ViewModelTypeLockFree, sizeof(TextBox*)
+    );
+    *(TextBox**)text_box->view->model = text_box;
+    view_set_context(text_box->view, text_box);
+    view_set_draw_callback(text_box->view, text_box_draw);
+    view_set_input_callback(text_box->view, text_box_input);
+    return text_box;
+}
+
+void text_box_free(TextBox* text_box)
+{
+    view_free(text_box->view);
+    free(text_box);
+}
+
+View* text_box_get_view(TextBox* text_box)
+{
+    return text_box->view;
+}
+
+void text_box_reset(TextBox* text_box)
+{
+    text_box->text = NULL;
+    text_box->focus = TextBoxFocusStart;
+    text_box->scroll = 0;
+    gui_host_request_redraw();
+}
+
+void text_box_set_text(TextBox* text_box, const char* text)
+{
+    text_box->text = text;
+    gui_host_request_redraw();
+}
+
+void text_box_set_font(TextBox* text_box, TextBoxFont font)
+{
+    UNUSED(text_box);
+    UNUSED(font);
+}
+
+void text_box_set_focus(TextBox* text_box, TextBoxFocus focus)
+{
+    text_box->focus = focus;
+    text_box->scroll = 0;
+}
+
+// Text input
+
+struct TextInput {
+    View* view;
+    const char* header;
+    TextInputCallback callback;
+    void* callback_context;
+    char* buffer;
+    size_t buffer_size;
+};
+
+static void text_input_draw(Canvas* canvas, void* model)
+{
+    TextInput* text_input = *(TextInput**)model;
+    char line[SCREEN_COLS + 1];
+
+    canvas_put(canvas, 0, 0, text_input->header ? text_input->header : "");
+    snprintf(
+        line,
+        sizeof(line),
+        "> %s_",
+        text_input->buffer ? text_input->buffer : ""
+    );
+    canvas_put(canvas, 0, 2, line);
+    canvas_put(canvas, 0, SCREEN_ROWS - 1, "Type, Enter saves, Esc backs");
+}
+
+static bool text_input_char(int ch, void* context)
+{
+    TextInput* text_input = context;
+    if (!text_input->buffer) return false;
+
+    size_t len = strlen(text_input->buffer);
+    if (ch == '\r' || ch == '\n') {
+        if (text_input->callback) {
+            text_input->callback(text_input->callback_context);
+        }
+    } else if (ch == KEY_BACKSPACE || ch == '\b') {
+        if (len) text_input->buffer[len - 1] = '\0';
+    } else if (ch >= ' ' && ch < 0x7f) {
+        if (len + 1 < text_input->buffer_size) {
+            text_input->buffer[len] = ch;
+            text_input->buffer[len + 1] = '\0';
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+TextInput* text_input_alloc(void)
+{
+    TextInput* text_input = malloc(sizeof(TextInput));
+    memset(text_input, 0, sizeof(TextInput));
+    text_input->view = view_alloc();
+    view_allocate_model(
+        text_input->view, ViewModelTypeLockFree, sizeof(TextInput*)
+    );
+    *(TextInput**)text_input->view->model = text_input;
+    view_set_context(text_input->view, text_input);
+    view_set_draw_callback(text_input->view, text_input_draw);
+    text_input->view->char_callback = text_input_char;
+    return text_input;
+}
+
+void text_input_free(TextInput* text_input)
+{
+    view_free(text_input->view);
+    free(text_input);
+}
+
+View* text_input_get_view(TextInput* text_input)
+{
+    return text_input->view;
+}
+
+void text_input_reset(TextInput* text_input)
+{
+    text_input->header = NULL;
+    text_input->callback = NULL;
+    text_input->buffer = NULL;
+    text_input->buffer_size = 0;
+}
+
+void text_input_set_header_text(TextInput* text_input, const char* text)
+{
+    text_input->header = text;
+}
+
+void text_input_set_result_callback(
+    TextInput* text_input,
+    TextInputCallback callback,
+    void* callback_context,
+    char* text_buffer,
+    size_t text_buffer_size,
+    bool clear_default_text
+)
+{
+    text_input->callback = callback;
+    text_input->callback_context = callback_context;
+    text_input->buffer = text_buffer;
+    text_input->buffer_size = text_buffer_size;
+    if (clear_default_text && text_buffer_size) text_buffer[0] = '\0';
+}
+
+// Loading
+
+struct Loading {
+    View* view;
+};
+
+static void loading_draw(Canvas* canvas, void* model)
+{
+    UNUSED(model);
+    canvas_draw_str_aligned(
+        canvas, 64, 32, AlignCenter, AlignCenter, "Loading..."
+    );
+}
+
+Loading* loading_alloc(void)
+{
+    Loading* loading = malloc(sizeof(Loading));
+    loading->view = view_alloc();
+    view_set_draw_callback(loading->view, loading_draw);
+    return loading;
+}
+
+void loading_free(Loading* instance)
+{
+    view_free(instance->view);
+    free(instance);
+}
+
+View* loading_get_view(Loading* instance)
+{
+    return instance->view;
+}
+
+// File browser, a path typed under /ext. Runs on the GUI thread like the
+// firmware dialog, so it reads the key queue itself.
+
+void dialog_file_browser_set_basic_options(
+    DialogsFileBrowserOptions* options, const char* extension, const Icon* icon
+)
+{
+    memset(options, 0, sizeof(DialogsFileBrowserOptions));
+    options->extension = extension;
+    options->icon = icon;
+    options->hide_dot_files = true;
+}
+
+bool dialog_file_browser_show(
+    DialogsApp* context,
+    FuriString* result_path,
+    FuriString* path,
+    const DialogsFileBrowserOptions* options
+)
+{
+    UNUSED(context);
+    UNUSED(path);
+
+    const char* base = options->base_path ? options->base_path : "/ext";
+    char typed[128] = "";
+    size_t len = 0;
+
+    printf("\r\nFile under %s (Enter picks, Esc cancels): ", base);
+    fflush(stdout);
+
+    bool picked = false;
+    pthread_mutex_lock(&gui_host.lock);
+    while (!gui_host.quit) {
+        if (!gui_host.key_used) {
+            pthread_cond_wait(&gui_host.cond, &gui_host.lock);
+            continue;
+        }
+        int key = gui_host_pop_key();
+        if (key == '\r' || key == '\n') {
+            picked = len > 0;
+            break;
+        }
+        if (key & KEY_SPECIAL) break;
+        if ((key == KEY_BACKSPACE || key == '\b') && len) {
+            typed[--len] = '\0';
+        } else if (key >= ' ' && key < 0x7f && len + 1 < sizeof(typed)) {
+            typed[len++] = key;
+            typed[len] = '\0';
+        } else {
+            continue;
+        }
+        printf(
+            "\rFile under %s (Enter picks, Esc cancels): %s\033[K",
+            base,
+            typed
+        );
+        fflush(stdout);
+    }
+    pthread_mutex_unlock(&gui_host.lock);
+
+    printf("\r\n");
+    if (picked) furi_string_printf(result_path, "%s/%s", base, typed);
+    gui_host_request_redraw();
+    return picked;
+}
+
+void path_extract_filename(
+    FuriString* path, FuriString* filename, bool trim_ext
+)
+{
+    const char* full = furi_string_get_cstr(path);
+    const char* name = strrchr(full, '/');
+    name = name ? name + 1 : full;
+
+    char copy[256];
+    strlcpy(copy, name, sizeof(copy));
+    if (trim_ext) {
+        char* dot = strrchr(copy, '.');
+        if (dot) *dot = '\0';
+    }
+    furi_string_set_str(filename, copy);
+}
+
+void expansion_disable(Expansion* instance)
+{
+    UNUSED(instance);
+}
+
+void expansion_enable(Expansion* instance)
+{
+    UNUSED(instance);
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+// Host stand-in for the parts of furi the app uses, on top of pthreads.
+// One tick is one millisecond.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UNUSED(x) (void)(x)
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define CLAMP(x, upper, lower) (MIN(upper, MAX(x, lower)))
+#define FURI_PACKED __attribute__((packed))
+#define FURI_ALWAYS_INLINE inline __attribute__((always_inline))
+
+void furi_crash(const char* message) __attribute__((noreturn));
+
+#define furi_check(x)                                                   \
+    do {                                                                \
+        if (!(x)) furi_crash(__FILE__ ": furi_check failed: " #x);      \
+    } while (0)
+#define furi_assert(x)                                                  \
+    do {                                                                \
+        if (!(x)) furi_crash(__FILE__ ": furi_assert failed: " #x);     \
+    } while (0)
+
+// Every furi critical section shares one recursive lock
+void furi_host_critical_enter(void);
+void furi_host_critical_exit(void);
+#define FURI_CRITICAL_ENTER() furi_host_critical_enter()
+#define FURI_CRITICAL_EXIT() furi_host_critical_exit()
+
+typedef enum {
+    FuriLogLevelDefault = 0,
+    FuriLogLevelNone = 1,
+    FuriLogLevelError = 2,
+    FuriLogLevelWarn = 3,
+    FuriLogLevelInfo = 4,
+    FuriLogLevelDebug = 5,
+    FuriLogLevelTrace = 6,
+} FuriLogLevel;
+
+// To stderr, debug and trace only with BLACKHAT_HOST_DEBUG set
+void furi_log_print_format(
+    FuriLogLevel level, const char* tag, const char* format, ...
+) __attribute__((format(printf, 3, 4)));
+
+#define FURI_LOG_E(tag, ...) \
+    furi_log_print_format(FuriLogLevelError, tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) \
+    furi_log_print_format(FuriLogLevelWarn, tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) \
+    furi_log_print_format(FuriLogLevelInfo, tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) \
+    furi_log_print_format(FuriLogLevelDebug, tag, __VA_ARGS__)
+#define FURI_LOG_T(tag, ...) \
+    furi_log_print_format(FuriLogLevelTrace, tag, __VA_ARGS__)
+
+typedef enum {
+    FuriWaitForever = 0xFFFFFFFFU,
+} FuriWait;
+
+typedef enum {
+    FuriFlagWaitAny = 0x00000000U,
+    FuriFlagWaitAll = 0x00000001U,
+    FuriFlagNoClear = 0x00000002U,
+    FuriFlagError = 0x80000000U,
+    FuriFlagErrorUnknown = 0xFFFFFFFFU,
+    FuriFlagErrorTimeout = 0xFFFFFFFEU,
+    FuriFlagErrorResource = 0xFFFFFFFDU,
+    FuriFlagErrorParameter = 0xFFFFFFFCU,
+} FuriFlag;
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+    FuriStatusErrorResource = -3,
+    FuriStatusErrorParameter = -4,
+} FuriStatus;
+
+// Kernel
+
+uint32_t furi_get_tick(void);
+uint32_t furi_ms_to_ticks(uint32_t milliseconds);
+uint32_t furi_kernel_get_tick_frequency(void);
+void furi_delay_tick(uint32_t ticks);
+void furi_delay_ms(uint32_t milliseconds);
+void furi_delay_us(uint32_t microseconds);
+
+// Threads, with 32 event flags each
+
+typedef struct FuriThread FuriThread;
+typedef FuriThread* FuriThreadId;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+typedef enum {
+    FuriThreadPriorityNone = 0,
+    FuriThreadPriorityIdle = 1,
+    FuriThreadPriorityLowest = 14,
+    FuriThreadPriorityLow = 15,
+    FuriThreadPriorityNormal = 16,
+    FuriThreadPriorityHigh = 17,
+    FuriThreadPriorityHighest = 18,
+    FuriThreadPriorityIsr = 32,
+} FuriThreadPriority;
+
+FuriThread* furi_thread_alloc(void);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_set_name(FuriThread* thread, const char* name);
+void furi_thread_set_stack_size(FuriThread* thread, size_t stack_size);
+void furi_thread_set_context(FuriThread* thread, void* context);
+void furi_thread_set_callback(FuriThread* thread, FuriThreadCallback callback);
+void furi_thread_set_priority(FuriThread* thread, FuriThreadPriority priority);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+FuriThreadId furi_thread_get_id(FuriThread* thread);
+FuriThreadId furi_thread_get_current_id(void);
+// Host threads have no high water mark, this is the size asked for
+uint32_t furi_thread_get_stack_space(FuriThreadId thread_id);
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags);
+uint32_t furi_thread_flags_clear(uint32_t flags);
+uint32_t furi_thread_flags_wait(
+    uint32_t flags, uint32_t options, uint32_t timeout
+);
+
+// Mutex
+
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+
+typedef struct FuriMutex FuriMutex;
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* instance);
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* instance);
+
+// Stream buffer, one reader and one writer like FreeRTOS
+
+typedef struct FuriStreamBuffer FuriStreamBuffer;
+
+FuriStreamBuffer* furi_stream_buffer_alloc(size_t size, size_t trigger_level);
+void furi_stream_buffer_free(FuriStreamBuffer* stream_buffer);
+size_t furi_stream_buffer_send(
+    FuriStreamBuffer* stream_buffer,
+    const void* data,
+    size_t length,
+    uint32_t timeout
+);
+size_t furi_stream_buffer_receive(
+    FuriStreamBuffer* stream_buffer,
+    void* data,
+    size_t length,
+    uint32_t timeout
+);
+size_t furi_stream_buffer_bytes_available(FuriStreamBuffer* stream_buffer);
+size_t furi_stream_buffer_spaces_available(FuriStreamBuffer* stream_buffer);
+bool furi_stream_buffer_is_empty(FuriStreamBuffer* stream_buffer);
+FuriStatus furi_stream_buffer_reset(FuriStreamBuffer* stream_buffer);
+
+// Timers, each fires on a thread of its own
+
+typedef void (*FuriTimerCallback)(void* context);
+
+typedef enum {
+    FuriTimerTypeOnce = 0,
+    FuriTimerTypePeriodic = 1,
+} FuriTimerType;
+
+typedef struct FuriTimer FuriTimer;
+
+FuriTimer* furi_timer_alloc(
+    FuriTimerCallback func, FuriTimerType type, void* context
+);
+void furi_timer_free(FuriTimer* instance);
+FuriStatus furi_timer_start(FuriTimer* instance, uint32_t ticks);
+FuriStatus furi_timer_restart(FuriTimer* instance, uint32_t ticks);
+FuriStatus furi_timer_stop(FuriTimer* instance);
+uint32_t furi_timer_is_running(FuriTimer* instance);
+
+// Records
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+// Strings
+
+typedef struct FuriString FuriString;
+
+FuriString* furi_string_alloc(void);
+FuriString* furi_string_alloc_set(const char* cstr);
+FuriString* furi_string_alloc_printf(const char* format, ...)
+    __attribute__((format(printf, 1, 2)));
+void furi_string_free(FuriString* string);
+void furi_string_reset(FuriString* string);
+void furi_string_set(FuriString* string, FuriString* source);
+void furi_string_set_str(FuriString* string, const char* cstr);
+bool furi_string_empty(const FuriString* string);
+size_t furi_string_size(const FuriString* string);
+const char* furi_string_get_cstr(const FuriString* string);
+int furi_string_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+int furi_string_cat_printf(FuriString* string, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+void furi_string_cat_str(FuriString* string, const char* cstr);
+
+// Heap figures come from mallinfo2() against a nominal heap size
+
+size_t memmgr_get_free_heap(void);
+size_t memmgr_get_total_heap(void);
+size_t memmgr_get_minimum_free_heap(void);
+size_t memmgr_heap_get_max_free_block(void);
+
+// The firmware libc has it, glibc before 2.38 does not
+size_t strlcpy(char* dst, const char* src, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
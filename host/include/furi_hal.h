@@ -0,0 +1,110 @@
+#pragma once
+
+// Host stand-in for furi_hal. The serial port is a tty, normally the slave
+// end of the PTY that blackhat_fake_pty serves, named by BLACKHAT_HOST_SERIAL.
+// Its callbacks run on a reader thread in place of the UART interrupt.
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    FuriHalSerialIdUsart,
+    FuriHalSerialIdLpuart,
+} FuriHalSerialId;
+
+typedef enum {
+    FuriHalSerialRxEventData = (1 << 0),
+    FuriHalSerialRxEventIdle = (1 << 1),
+    FuriHalSerialRxEventFrameError = (1 << 2),
+    FuriHalSerialRxEventNoiseError = (1 << 3),
+    FuriHalSerialRxEventOverrunError = (1 << 4),
+} FuriHalSerialRxEvent;
+
+typedef struct FuriHalSerialHandle FuriHalSerialHandle;
+
+typedef void (*FuriHalSerialAsyncRxCallback)(
+    FuriHalSerialHandle* handle, FuriHalSerialRxEvent event, void* context
+);
+typedef void (*FuriHalSerialDmaRxCallback)(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialRxEvent event,
+    size_t data_len,
+    void* context
+);
+
+FuriHalSerialHandle* furi_hal_serial_control_acquire(FuriHalSerialId id);
+void furi_hal_serial_control_release(FuriHalSerialHandle* handle);
+
+void furi_hal_serial_init(FuriHalSerialHandle* handle, uint32_t baud);
+void furi_hal_serial_deinit(FuriHalSerialHandle* handle);
+bool furi_hal_serial_is_baud_rate_supported(
+    FuriHalSerialHandle* handle, uint32_t baud
+);
+void furi_hal_serial_set_br(FuriHalSerialHandle* handle, uint32_t baud);
+
+void furi_hal_serial_tx(
+    FuriHalSerialHandle* handle, const uint8_t* buffer, size_t buffer_size
+);
+void furi_hal_serial_tx_wait_complete(FuriHalSerialHandle* handle);
+
+void furi_hal_serial_async_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialAsyncRxCallback callback,
+    void* context,
+    bool report_errors
+);
+void furi_hal_serial_async_rx_stop(FuriHalSerialHandle* handle);
+uint8_t furi_hal_serial_async_rx(FuriHalSerialHandle* handle);
+
+void furi_hal_serial_dma_rx_start(
+    FuriHalSerialHandle* handle,
+    FuriHalSerialDmaRxCallback callback,
+    void* context,
+    bool report_errors
+);
+void furi_hal_serial_dma_rx_stop(FuriHalSerialHandle* handle);
+size_t furi_hal_serial_dma_rx(
+    FuriHalSerialHandle* handle, uint8_t* data, size_t len
+);
+
+// 5V on the GPIO header, only remembered here
+bool furi_hal_power_is_otg_enabled(void);
+bool furi_hal_power_enable_otg(void);
+void furi_hal_power_disable_otg(void);
+
+typedef struct {
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    uint8_t weekday;
+} DateTime;
+
+void furi_hal_rtc_get_datetime(DateTime* datetime);
+
+uint32_t furi_hal_random_get(void);
+
+// A 64 MHz cycle counter derived from CLOCK_MONOTONIC, read as DWT->CYCCNT
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+DWT_Type* furi_host_dwt(void);
+#define DWT (furi_host_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+
+typedef struct Version Version;
+
+const Version* furi_hal_version_get_firmware_version(void);
+const char* version_get_version(const Version* version);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "canvas.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void elements_progress_bar(
+    Canvas* canvas, int32_t x, int32_t y, size_t width, float progress
+);
+void elements_progress_bar_with_text(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    float progress,
+    const char* text
+);
+
+#ifdef __cplusplus
+}
+#endif
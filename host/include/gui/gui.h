@@ -0,0 +1,15 @@
+#pragma once
+
+#include "canvas.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_GUI "gui"
+
+typedef struct Gui Gui;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <gui/view.h>
+
+typedef struct Loading Loading;
+
+Loading* loading_alloc(void);
+void loading_free(Loading* instance);
+View* loading_get_view(Loading* instance);
@@ -0,0 +1,68 @@
+#pragma once
+
+// The frame is printed to stdout whenever it changes, keys are read from
+// stdin. See readme.md for the key map.
+
+#include "gui.h"
+#include "view.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ViewDispatcherTypeDesktop,
+    ViewDispatcherTypeWindow,
+    ViewDispatcherTypeFullscreen,
+} ViewDispatcherType;
+
+typedef struct ViewDispatcher ViewDispatcher;
+
+typedef bool (*ViewDispatcherCustomEventCallback)(
+    void* context, uint32_t event
+);
+typedef bool (*ViewDispatcherNavigationEventCallback)(void* context);
+typedef void (*ViewDispatcherTickEventCallback)(void* context);
+
+ViewDispatcher* view_dispatcher_alloc(void);
+void view_dispatcher_free(ViewDispatcher* view_dispatcher);
+
+void view_dispatcher_set_event_callback_context(
+    ViewDispatcher* view_dispatcher, void* context
+);
+void view_dispatcher_set_custom_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherCustomEventCallback callback
+);
+void view_dispatcher_set_navigation_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherNavigationEventCallback callback
+);
+void view_dispatcher_set_tick_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherTickEventCallback callback,
+    uint32_t tick_period
+);
+
+void view_dispatcher_send_custom_event(
+    ViewDispatcher* view_dispatcher, uint32_t event
+);
+void view_dispatcher_run(ViewDispatcher* view_dispatcher);
+void view_dispatcher_stop(ViewDispatcher* view_dispatcher);
+
+void view_dispatcher_add_view(
+    ViewDispatcher* view_dispatcher, uint32_t view_id, View* view
+);
+void view_dispatcher_remove_view(
+    ViewDispatcher* view_dispatcher, uint32_t view_id
+);
+void view_dispatcher_switch_to_view(
+    ViewDispatcher* view_dispatcher, uint32_t view_id
+);
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher, Gui* gui, ViewDispatcherType type
+);
+
+#ifdef __cplusplus
+}
+#endif
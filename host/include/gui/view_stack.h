@@ -0,0 +1,5 @@
+#pragma once
+
+#include "view.h"
+
+typedef struct ViewStack ViewStack;
@@ -0,0 +1,5 @@
+#pragma once
+
+#define RECORD_NOTIFICATION "notification"
+
+typedef struct NotificationApp NotificationApp;
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void path_extract_filename(
+    FuriString* path, FuriString* filename, bool trim_ext
+);
+
+#ifdef __cplusplus
+}
+#endif
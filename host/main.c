@@ -0,0 +1,16 @@
+#include <furi.h>
+
+// Runs the app against a tty, normally the PTY from blackhat_fake_pty
+
+int32_t blackhat_app(void* p);
+
+int main(int argc, char** argv)
+{
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [serial device]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2) setenv("BLACKHAT_HOST_SERIAL", argv[1], 1);
+
+    return blackhat_app(NULL);
+}
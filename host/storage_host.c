@@ -0,0 +1,177 @@
+#include <storage/storage.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define TAG "StorageHost"
+
+#define HOST_PATH_MAX (512)
+
+struct File {
+    int fd;
+};
+
+void storage_host_path(const char* path, char* out, size_t size)
+{
+    const char* root = getenv("BLACKHAT_HOST_SD");
+    if (!root) root = "sd";
+
+    size_t prefix = strlen(STORAGE_EXT_PATH_PREFIX);
+    if (!strncmp(path, STORAGE_EXT_PATH_PREFIX, prefix)) {
+        snprintf(out, size, "%s%s", root, path + prefix);
+    } else {
+        snprintf(out, size, "%s", path);
+    }
+}
+
+File* storage_file_alloc(Storage* storage)
+{
+    UNUSED(storage);
+    File* file = malloc(sizeof(File));
+    file->fd = -1;
+    return file;
+}
+
+void storage_file_free(File* file)
+{
+    if (file->fd >= 0) storage_file_close(file);
+    free(file);
+}
+
+bool storage_file_open(
+    File* file,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode
+)
+{
+    char host_path[HOST_PATH_MAX];
+    storage_host_path(path, host_path, sizeof(host_path));
+
+    int flags = access_mode == FSAM_READ_WRITE ? O_RDWR :
+                access_mode == FSAM_WRITE      ? O_WRONLY :
+                                                 O_RDONLY;
+    switch (open_mode) {
+    case FSOM_OPEN_ALWAYS:
+        flags |= O_CREAT;
+        break;
+    case FSOM_OPEN_APPEND:
+        flags |= O_CREAT | O_APPEND;
+        break;
+    case FSOM_CREATE_NEW:
+        flags |= O_CREAT | O_EXCL;
+        break;
+    case FSOM_CREATE_ALWAYS:
+        flags |= O_CREAT | O_TRUNC;
+        break;
+    default:
+        break;
+    }
+
+    file->fd = open(host_path, flags, 0644);
+    if (file->fd < 0) {
+        FURI_LOG_D(TAG, "%s: %s", host_path, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool storage_file_close(File* file)
+{
+    if (file->fd < 0) return false;
+    bool ok = !close(file->fd);
+    file->fd = -1;
+    return ok;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read)
+{
+    ssize_t len = read(file->fd, buff, bytes_to_read);
+    return len > 0 ? (size_t)len : 0;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write)
+{
+    ssize_t len = write(file->fd, buff, bytes_to_write);
+    return len > 0 ? (size_t)len : 0;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start)
+{
+    return lseek(file->fd, offset, from_start ? SEEK_SET : SEEK_CUR) >= 0;
+}
+
+uint64_t storage_file_tell(File* file)
+{
+    off_t offset = lseek(file->fd, 0, SEEK_CUR);
+    return offset > 0 ? (uint64_t)offset : 0;
+}
+
+uint64_t storage_file_size(File* file)
+{
+    struct stat st;
+    if (fstat(file->fd, &st)) return 0;
+    return st.st_size;
+}
+
+bool storage_file_sync(File* file)
+{
+    return !fsync(file->fd);
+}
+
+bool storage_file_truncate(File* file)
+{
+    off_t offset = lseek(file->fd, 0, SEEK_CUR);
+    return offset >= 0 && !ftruncate(file->fd, offset);
+}
+
+bool storage_file_exists(Storage* storage, const char* path)
+{
+    UNUSED(storage);
+    char host_path[HOST_PATH_MAX];
+    struct stat st;
+    storage_host_path(path, host_path, sizeof(host_path));
+    return !stat(host_path, &st) && S_ISREG(st.st_mode);
+}
+
+FS_Error storage_common_mkdir(Storage* storage, const char* path)
+{
+    UNUSED(storage);
+    char host_path[HOST_PATH_MAX];
+    storage_host_path(path, host_path, sizeof(host_path));
+    if (!mkdir(host_path, 0755)) return FSE_OK;
+    return errno == EEXIST ? FSE_EXIST : FSE_INTERNAL;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path)
+{
+    UNUSED(storage);
+    char host_path[HOST_PATH_MAX];
+    storage_host_path(path, host_path, sizeof(host_path));
+    if (!remove(host_path)) return FSE_OK;
+    return errno == ENOENT ? FSE_NOT_EXIST : FSE_INTERNAL;
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path)
+{
+    UNUSED(storage);
+    char host_path[HOST_PATH_MAX];
+    storage_host_path(path, host_path, sizeof(host_path));
+
+    // Each parent in turn, then the folder itself
+    for (char* p = host_path + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        mkdir(host_path, 0755);
+        *p = '/';
+    }
+    return !mkdir(host_path, 0755) || errno == EEXIST;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path)
+{
+    FS_Error error = storage_common_remove(storage, path);
+    return error == FSE_OK || error == FSE_NOT_EXIST;
+}
@@ -1,7 +1,19 @@
 #include "blackhat_scene.h"
 
+static BlackhatScene blackhat_scene_current = BlackhatSceneNum;
+
+// Generate scene on_enter wrappers that note the scene on screen
+#define ADD_SCENE(prefix, name, id)                                     \
+    static void prefix##_scene_##name##_on_enter_current(void* context) \
+    {                                                                   \
+        blackhat_scene_current = BlackhatScene##id;                     \
+        prefix##_scene_##name##_on_enter(context);                      \
+    }
+#include "blackhat_scene_config.h"
+#undef ADD_SCENE
+
 // Generate scene on_enter handlers array
-#define ADD_SCENE(prefix, name, id) prefix##_scene_##name##_on_enter,
+#define ADD_SCENE(prefix, name, id) prefix##_scene_##name##_on_enter_current,
 void (*const blackhat_scene_on_enter_handlers[])(void*) = {
 #include "blackhat_scene_config.h"
 };
@@ -23,6 +35,23 @@ void (*const blackhat_scene_on_exit_handlers[])(void* context) = {
 };
 #undef ADD_SCENE
 
+// Generate scene names
+#define ADD_SCENE(prefix, name, id) #name,
+static const char* const blackhat_scene_names[] = {
+#include "blackhat_scene_config.h"
+};
+#undef ADD_SCENE
+
+BlackhatScene blackhat_scene_get_current(void)
+{
+    return blackhat_scene_current;
+}
+
+const char* blackhat_scene_get_name(BlackhatScene scene)
+{
+    return scene < BlackhatSceneNum ? blackhat_scene_names[scene] : "none";
+}
+
 // Initialize scene handlers configuration structure
 const SceneManagerHandlers blackhat_scene_handlers = {
     .on_enter_handlers = blackhat_scene_on_enter_handlers,
@@ -12,6 +12,10 @@ typedef enum {
 
 extern const SceneManagerHandlers blackhat_scene_handlers;
 
+// The scene entered last, BlackhatSceneNum before the first one
+BlackhatScene blackhat_scene_get_current(void);
+const char* blackhat_scene_get_name(BlackhatScene scene);
+
 // Generate scene on_enter handlers declaration
 #define ADD_SCENE(prefix, name, id) \
     void prefix##_scene_##name##_on_enter(void*);
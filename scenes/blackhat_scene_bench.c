@@ -0,0 +1,61 @@
+#include "../blackhat_app_i.h"
+
+static void blackhat_scene_bench_update(BlackhatApp* app, bool done)
+{
+    text_box_set_text(
+        app->text_box, blackhat_bench_get_report(app->bench, done)
+    );
+}
+
+void blackhat_scene_bench_on_enter(void* context)
+{
+    BlackhatApp* app = context;
+
+    text_box_reset(app->text_box);
+    text_box_set_font(app->text_box, TextBoxFontText);
+    text_box_set_focus(app->text_box, TextBoxFocusEnd);
+
+    // Consumers under test must not treat the pattern as a script listing
+    app->rx_lines = NULL;
+
+    blackhat_bench_start(app, BlackhatEventBenchStep, BlackhatEventBenchDone);
+    blackhat_scene_bench_update(app, false);
+
+    view_dispatcher_switch_to_view(
+        app->view_dispatcher, BlackhatAppViewConsoleOutput
+    );
+}
+
+bool blackhat_scene_bench_on_event(void* context, SceneManagerEvent event)
+{
+    BlackhatApp* app = context;
+    bool consumed = false;
+
+    if (event.type == SceneManagerEventTypeCustom) {
+        if (event.event == BlackhatEventBenchStep) {
+            blackhat_scene_bench_update(app, false);
+        } else if (event.event == BlackhatEventBenchDone) {
+            blackhat_scene_bench_update(app, true);
+        }
+        // Console consumer refreshes are swallowed, it isn't on screen
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+void blackhat_scene_bench_on_exit(void* context)
+{
+    BlackhatApp* app = context;
+
+    // The text box still points at the report the bench owns
+    text_box_reset(app->text_box);
+    blackhat_bench_stop(app->bench);
+
+    // The console consumer filled the terminal with pattern lines
+    furi_mutex_acquire(app->console_mutex, FuriWaitForever);
+    blackhat_term_reset(app->term);
+    app->console_pending = 0;
+    app->console_refresh_queued = false;
+    furi_mutex_release(app->console_mutex);
+}
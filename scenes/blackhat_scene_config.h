@@ -3,3 +3,8 @@ ADD_SCENE(blackhat, scripts, Scripts)
 ADD_SCENE(blackhat, console_output, ConsoleOutput)
 ADD_SCENE(blackhat, tui, Tui)
 ADD_SCENE(blackhat, rename, Rename)
+ADD_SCENE(blackhat, bench, Bench)
+ADD_SCENE(blackhat, diagnostics, Diagnostics)
+ADD_SCENE(blackhat, dashboard, Dashboard)
+ADD_SCENE(blackhat, profile, Profile)
+ADD_SCENE(blackhat, xfer, Xfer)
@@ -1,5 +1,37 @@
 #include "../blackhat_app_i.h"
 
+// Runs on the GUI thread, at most once per frame interval
+static void blackhat_console_output_refresh(BlackhatApp* app)
+{
+    furi_mutex_acquire(app->console_mutex, FuriWaitForever);
+    BH_TRACE_BEGIN(BlackhatTraceConsoleRefresh, app->console_pending);
+
+    // Slow down while the device floods us, speed back up once it calms
+    if (app->console_pending > BLACKHAT_CONSOLE_HEAVY_RX_BYTES) {
+        app->console_frame_ms =
+            MIN(app->console_frame_ms * 2, BLACKHAT_CONSOLE_FRAME_MAX_MS);
+    } else if (app->console_pending < BLACKHAT_CONSOLE_HEAVY_RX_BYTES / 4) {
+        app->console_frame_ms =
+            MAX(app->console_frame_ms / 2, BLACKHAT_CONSOLE_FRAME_MS);
+    }
+
+    app->console_pending = 0;
+    app->console_refresh_queued = false;
+    app->console_last_frame = furi_get_tick();
+
+    // Only rows the device touched since the last frame are copied
+    blackhat_term_commit(app->term);
+
+    BH_TRACE_END(BlackhatTraceConsoleRefresh, 0);
+    furi_mutex_release(app->console_mutex);
+}
+
+static bool blackhat_console_output_frame_due(BlackhatApp* app)
+{
+    return furi_get_tick() - app->console_last_frame >=
+           furi_ms_to_ticks(app->console_frame_ms);
+}
+
 void blackhat_console_output_handle_rx_data_cb(
     uint8_t* buf, size_t len, void* context
 )
@@ -7,55 +39,197 @@ void blackhat_console_output_handle_rx_data_cb(
     furi_assert(context);
     BlackhatApp* app = context;
 
-    // If text box store gets too big, then truncate it
-    app->text_box_store_strlen += len;
-    if (app->text_box_store_strlen >= BLACKHAT_TEXT_BOX_STORE_SIZE - 1) {
-        furi_string_right(app->text_box_store, app->text_box_store_strlen / 2);
-        app->text_box_store_strlen =
-            furi_string_size(app->text_box_store) + len;
-    }
+    BH_TRACE_BEGIN(BlackhatTraceConsoleRx, len);
 
     // We gotta parse the output
-    if (app->is_script_scan) {
-        memcpy(&app->script_text[app->script_text_ptr], buf, len);
-        app->script_text_ptr += len;
+    if (app->rx_lines) {
+        blackhat_line_list_feed(app->rx_lines, buf, len);
+    }
+
+    blackhat_response_feed(app->response, buf, len);
+    blackhat_cache_feed(app->cache, buf, len);
+
+    furi_mutex_acquire(app->console_mutex, FuriWaitForever);
+
+    blackhat_term_feed(app->term, buf, len);
+    app->console_pending += len;
+
+    // Wake the GUI early if a frame is due, otherwise the tick picks it up
+    bool refresh = !app->console_refresh_queued &&
+                   blackhat_console_output_frame_due(app);
+    if (refresh) {
+        app->console_refresh_queued = true;
+    }
+
+    furi_mutex_release(app->console_mutex);
+
+    if (refresh) {
+        view_dispatcher_send_custom_event(
+            app->view_dispatcher, BlackhatEventRefreshConsoleOutput
+        );
     }
 
-    // Null-terminate buf and append to text box store
-    buf[len] = '\0';
-    furi_string_cat_printf(app->text_box_store, "%s", buf);
-    text_box_set_text(app->text_box, furi_string_get_cstr(app->text_box_store));
+    BH_TRACE_END(BlackhatTraceConsoleRx, len);
 }
 
-void blackhat_scene_console_output_on_enter(void* context)
+// Device Summary fires its queries together when the link is framed
+static const char* const blackhat_summary_cmds[] = {
+    GET_CMD,
+    GET_IP_CMD,
+    DEV_CMD,
+};
+
+typedef struct {
+    BlackhatApp* app;
+    const char* cmd;
+    FuriString* out;
+    uint8_t id;
+} BlackhatSummaryRequest;
+
+static BlackhatSummaryRequest
+    blackhat_summary[COUNT_OF(blackhat_summary_cmds)];
+
+static void blackhat_console_output_summary_cb(
+    BlackhatRpcEvent event, const uint8_t* data, size_t len, void* context
+)
+{
+    BlackhatSummaryRequest* req = context;
+
+    if (event == BlackhatRpcEventData) {
+        furi_string_cat_printf(req->out, "%.*s", (int)len, (const char*)data);
+        return;
+    }
+
+    // Print each answer in one piece, in whatever order they complete
+    furi_string_cat_str(req->out, "\n");
+    blackhat_console_output_handle_rx_data_cb(
+        (uint8_t*)furi_string_get_cstr(req->out),
+        furi_string_size(req->out),
+        req->app
+    );
+    req->id = 0;
+}
+
+static bool blackhat_console_output_summary_start(BlackhatApp* app)
+{
+    if (!blackhat_rpc_is_framed(app->rpc)) return false;
+
+    for (size_t i = 0; i < COUNT_OF(blackhat_summary); i++) {
+        BlackhatSummaryRequest* req = &blackhat_summary[i];
+        req->app = app;
+        req->cmd = blackhat_summary_cmds[i];
+        req->out = furi_string_alloc_printf("== %s ==\n", req->cmd);
+        req->id = blackhat_rpc_request(
+            app->rpc, req->cmd, blackhat_console_output_summary_cb, req
+        );
+
+        // Every slot is taken, say so instead of leaving the entry out
+        if (!req->id) {
+            furi_string_cat_str(req->out, "Not sent, link busy\n\n");
+            blackhat_console_output_handle_rx_data_cb(
+                (uint8_t*)furi_string_get_cstr(req->out),
+                furi_string_size(req->out),
+                app
+            );
+        }
+    }
+
+    return true;
+}
+
+static void blackhat_console_output_summary_stop(BlackhatApp* app)
+{
+    for (size_t i = 0; i < COUNT_OF(blackhat_summary); i++) {
+        BlackhatSummaryRequest* req = &blackhat_summary[i];
+        if (!req->out) continue;
+        blackhat_rpc_cancel(app->rpc, req->id);
+        furi_string_free(req->out);
+        req->out = NULL;
+    }
+}
+
+// Repeated queries are answered from the cache unless a refresh is forced
+static void blackhat_console_output_send(BlackhatApp* app, bool refresh)
+{
+    const char* cmd = app->selected_tx_string;
+    FuriString* cached = furi_string_alloc();
+    uint32_t age_ms;
+
+    if (!refresh && blackhat_cache_get(app->cache, cmd, cached, &age_ms)) {
+        char header[32];
+        snprintf(
+            header,
+            sizeof(header),
+            "[cached %lus, hold OK]\n",
+            (unsigned long)(age_ms / 1000)
+        );
+        blackhat_console_output_handle_rx_data_cb(
+            (uint8_t*)header, strlen(header), app
+        );
+        blackhat_console_output_handle_rx_data_cb(
+            (uint8_t*)furi_string_get_cstr(cached),
+            furi_string_size(cached),
+            app
+        );
+        furi_string_free(cached);
+        return;
+    }
+    furi_string_free(cached);
+
+    blackhat_cache_invalidate(app->cache, app->text_store);
+    blackhat_cache_stop(app->cache);
+    if (blackhat_cache_start(app->cache, cmd)) {
+        blackhat_response_start(app->response);
+    }
+
+    blackhat_uart_tx(app->uart, app->text_store, strlen(app->text_store));
+
+    // Waits for the command to go out at the old rate
+    if (!strcmp(cmd, REBOOT_CMD)) blackhat_app_relink(app);
+}
+
+static bool blackhat_console_output_input_callback(
+    InputEvent* event, void* context
+)
 {
     BlackhatApp* app = context;
 
-    TextBox* text_box = app->text_box;
-    text_box_reset(app->text_box);
-    text_box_set_font(text_box, TextBoxFontText);
+    if (event->key == InputKeyOk && event->type == InputTypeLong) {
+        view_dispatcher_send_custom_event(
+            app->view_dispatcher, BlackhatEventCacheRefresh
+        );
+        return true;
+    }
 
-    text_box_set_focus(text_box, TextBoxFocusEnd);
+    return false;
+}
+
+void blackhat_scene_console_output_on_enter(void* context)
+{
+    BlackhatApp* app = context;
 
-    furi_string_reset(app->text_box_store);
-    app->text_box_store_strlen = 0;
+    furi_mutex_acquire(app->console_mutex, FuriWaitForever);
+    blackhat_term_reset(app->term);
+    app->console_pending = 0;
+    app->console_refresh_queued = false;
+    app->console_frame_ms = BLACKHAT_CONSOLE_FRAME_MS;
+    app->console_last_frame = furi_get_tick();
+    furi_mutex_release(app->console_mutex);
 
-    app->is_script_scan = false;
+    app->rx_lines = NULL;
     if (!strcmp(app->selected_tx_string, SCAN_CMD)) {
-        app->is_script_scan = true;
-        app->script_text_ptr = 0;
+        blackhat_line_list_reset(&app->script_list);
+        app->rx_lines = &app->script_list;
         app->scanned = true;
+        blackhat_response_start(app->response);
     }
     else if(!strncmp(app->selected_tx_string, "bh set", strlen("bh set"))) {
-        app->is_script_scan = true;
-        app->script_text_ptr = 0;
-        app->scanned = true;
+        blackhat_line_list_reset(&app->param_lines);
+        app->rx_lines = &app->param_lines;
         app->selected_tx_string[3] = 'g'; // bh get
     }
     if (!strcmp(app->selected_tx_string, CHG_RUN_CMD_SCREEN)) {
         if (app->scanned) {
-            app->script_text_ptr++;
-            app->script_text[app->script_text_ptr] = 0x00;
             scene_manager_next_scene(app->scene_manager, BlackhatSceneScripts);
         }
         return;
@@ -70,7 +244,7 @@ void blackhat_scene_console_output_on_enter(void* context)
     );
 
     FURI_LOG_I("tag/app name", "%s", app->text_store);
-    text_box_set_text(app->text_box, furi_string_get_cstr(app->text_box_store));
+    blackhat_term_commit(app->term);
 
     if (app->text_input_req) {
         app->selected_tx_string[3] = 's'; // bh set
@@ -83,7 +257,7 @@ void blackhat_scene_console_output_on_enter(void* context)
         );
 
         view_dispatcher_switch_to_view(
-            app->view_dispatcher, BlackhatAppViewConsoleOutput
+            app->view_dispatcher, BlackhatAppViewTerminal
         );
     }
 
@@ -91,20 +265,60 @@ void blackhat_scene_console_output_on_enter(void* context)
     blackhat_uart_set_handle_rx_data_cb(
         app->uart, blackhat_console_output_handle_rx_data_cb
     );
+    blackhat_term_set_input_callback(
+        app->term, blackhat_console_output_input_callback, app
+    );
 
-    blackhat_uart_tx(app->uart, app->text_store, strlen(app->text_store));
+    if (!strcmp(app->selected_tx_string, SUMMARY_CMD) &&
+        blackhat_console_output_summary_start(app)) {
+        return;
+    }
 
+    // Text protocol, Device Summary goes out as a single shell line
+    blackhat_console_output_send(app, false);
 }
 
 bool blackhat_scene_console_output_on_event(
     void* context, SceneManagerEvent event
 )
 {
-    UNUSED(context);
+    BlackhatApp* app = context;
 
     bool consumed = false;
 
-    if (event.type == SceneManagerEventTypeTick) {
+    if (event.type == SceneManagerEventTypeCustom &&
+        event.event == BlackhatEventRefreshConsoleOutput) {
+        blackhat_console_output_refresh(app);
+        consumed = true;
+    } else if (
+        event.type == SceneManagerEventTypeCustom &&
+        event.event == BlackhatEventResponseDone) {
+        // Script list is complete, Run Script can use it straight away
+        if (app->rx_lines == &app->script_list) {
+            blackhat_line_list_finish(app->rx_lines);
+            blackhat_store_save(&app->script_list, &app->params, &app->schema);
+            app->scripts_validated = true;
+            app->rx_lines = NULL;
+        }
+        blackhat_cache_done(app->cache);
+        consumed = true;
+    } else if (
+        event.type == SceneManagerEventTypeCustom &&
+        event.event == BlackhatEventCacheRefresh) {
+        if (blackhat_cache_is_query(app->selected_tx_string)) {
+            furi_mutex_acquire(app->console_mutex, FuriWaitForever);
+            blackhat_term_reset(app->term);
+            app->console_pending = 0;
+            furi_mutex_release(app->console_mutex);
+            blackhat_term_commit(app->term);
+            blackhat_console_output_send(app, true);
+        }
+        consumed = true;
+    } else if (event.type == SceneManagerEventTypeTick) {
+        if (app->console_pending &&
+            blackhat_console_output_frame_due(app)) {
+            blackhat_console_output_refresh(app);
+        }
         consumed = true;
     }
 
@@ -117,4 +331,12 @@ void blackhat_scene_console_output_on_exit(void* context)
 
     // Unregister rx callback
     blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+    blackhat_term_set_input_callback(app->term, NULL, NULL);
+    blackhat_response_cancel(app->response);
+    blackhat_cache_stop(app->cache);
+    if (app->rx_lines == &app->script_list) {
+        blackhat_line_list_finish(app->rx_lines);
+        app->rx_lines = NULL;
+    }
+    blackhat_console_output_summary_stop(app);
 }
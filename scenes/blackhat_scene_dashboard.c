@@ -0,0 +1,165 @@
+#include "../blackhat_app_i.h"
+#include <gui/canvas.h>
+
+#define DASH_LINE_HEIGHT (9)
+
+static const char* blackhat_scene_dashboard_value(const char* value)
+{
+    return value[0] ? value : "-";
+}
+
+static void blackhat_scene_dashboard_draw_callback(
+    Canvas* canvas, void* model
+)
+{
+    const BlackhatDashModel* m = model;
+    const BlackhatTelemetryFields* f = &m->fields;
+    char line[40];
+    uint8_t y = DASH_LINE_HEIGHT - 1;
+
+    canvas_clear(canvas);
+    canvas_set_font(canvas, FontSecondary);
+
+    if (m->state == BlackhatDashStateLive) {
+        snprintf(
+            line,
+            sizeof(line),
+            "IP %s",
+            blackhat_scene_dashboard_value(f->ip)
+        );
+    } else if (m->state == BlackhatDashStateWaiting) {
+        snprintf(line, sizeof(line), "Waiting for device...");
+    } else {
+        snprintf(line, sizeof(line), "Needs a framed link");
+    }
+    canvas_draw_str(canvas, 0, y, line);
+    y += DASH_LINE_HEIGHT;
+
+    for (uint8_t i = 0; i < BLACKHAT_TELEMETRY_WLANS; i++) {
+        const BlackhatTelemetryWlan* wlan = &f->wlan[i];
+        snprintf(
+            line,
+            sizeof(line),
+            "wlan%u %s %s ch %s",
+            i,
+            blackhat_scene_dashboard_value(wlan->mode),
+            blackhat_scene_dashboard_value(wlan->link),
+            blackhat_scene_dashboard_value(wlan->channel)
+        );
+        canvas_draw_str(canvas, 0, y, line);
+        y += DASH_LINE_HEIGHT;
+    }
+
+    snprintf(
+        line,
+        sizeof(line),
+        "AP clients %s",
+        blackhat_scene_dashboard_value(f->ap_clients)
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += DASH_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "SSH %s  Portal %s",
+        blackhat_scene_dashboard_value(f->ssh),
+        blackhat_scene_dashboard_value(f->portal)
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += DASH_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "Kismet %s",
+        blackhat_scene_dashboard_value(f->kismet)
+    );
+    canvas_draw_str(canvas, 0, y, line);
+}
+
+// Runs on the UART worker
+static void blackhat_scene_dashboard_on_event_frame(
+    uint8_t type, uint8_t id, const uint8_t* data, size_t len, void* context
+)
+{
+    BlackhatApp* app = context;
+
+    if (type == BlackhatProtoEvent && id == BLACKHAT_EVENT_TELEMETRY &&
+        blackhat_telemetry_apply(app->telemetry, data, len)) {
+        view_dispatcher_send_custom_event(
+            app->view_dispatcher, BlackhatEventTelemetry
+        );
+    }
+}
+
+void blackhat_scene_dashboard_on_enter(void* context)
+{
+    BlackhatApp* app = context;
+    View* view = app->dash_view;
+
+    view_set_context(view, app);
+    view_set_draw_callback(view, blackhat_scene_dashboard_draw_callback);
+
+    blackhat_telemetry_reset(app->telemetry);
+    blackhat_rpc_set_channel_callback(
+        app->rpc,
+        BlackhatChannelEvent,
+        blackhat_scene_dashboard_on_event_frame,
+        app
+    );
+
+    char cmd[32];
+    snprintf(
+        cmd,
+        sizeof(cmd),
+        BLACKHAT_TELEMETRY_CMD " start %u",
+        BLACKHAT_TELEMETRY_INTERVAL_MS
+    );
+    bool started = blackhat_rpc_send(app->rpc, cmd);
+
+    with_view_model(
+        view,
+        BlackhatDashModel * model,
+        {
+            memset(model, 0, sizeof(BlackhatDashModel));
+            model->state = started ? BlackhatDashStateWaiting :
+                                     BlackhatDashStateNoLink;
+        },
+        true
+    );
+
+    view_dispatcher_switch_to_view(
+        app->view_dispatcher, BlackhatAppViewDashboard
+    );
+}
+
+bool blackhat_scene_dashboard_on_event(void* context, SceneManagerEvent event)
+{
+    BlackhatApp* app = context;
+
+    if (event.type == SceneManagerEventTypeCustom &&
+        event.event == BlackhatEventTelemetry) {
+        // Only the fields that changed are copied, and nothing is redrawn
+        // when a frame repeated what is already on screen
+        BlackhatDashModel* model = view_get_model(app->dash_view);
+        uint32_t changed =
+            blackhat_telemetry_take(app->telemetry, &model->fields);
+        bool first = model->state != BlackhatDashStateLive;
+        model->state = BlackhatDashStateLive;
+        view_commit_model(app->dash_view, changed || first);
+        return true;
+    }
+
+    return false;
+}
+
+void blackhat_scene_dashboard_on_exit(void* context)
+{
+    BlackhatApp* app = context;
+
+    blackhat_rpc_set_channel_callback(
+        app->rpc, BlackhatChannelEvent, NULL, NULL
+    );
+    blackhat_rpc_send(app->rpc, BLACKHAT_TELEMETRY_CMD " stop");
+}
@@ -0,0 +1,164 @@
+#include "../blackhat_app_i.h"
+#include <gui/canvas.h>
+
+#define DIAG_LINE_HEIGHT (9)
+
+static void blackhat_scene_diagnostics_draw_callback(
+    Canvas* canvas, void* model
+)
+{
+    const BlackhatDiagModel* m = model;
+    const BlackhatUartStats* s = &m->uart;
+    char line[64];
+    uint8_t y = DIAG_LINE_HEIGHT - 1;
+
+    canvas_clear(canvas);
+    canvas_set_font(canvas, FontSecondary);
+
+    snprintf(
+        line,
+        sizeof(line),
+        "%lu baud %s",
+        (unsigned long)m->baud,
+        m->framed ? "framed" : "text"
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += DIAG_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "RX %lu  drop %lu",
+        (unsigned long)s->rx_bytes,
+        (unsigned long)s->rx_dropped
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += DIAG_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "Ovr %lu  Frm %lu  Nse %lu",
+        (unsigned long)s->overrun_errors,
+        (unsigned long)s->framing_errors,
+        (unsigned long)s->noise_errors
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += DIAG_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "Stream peak %lu/%u",
+        (unsigned long)s->stream_peak,
+        RX_STREAM_SIZE
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += DIAG_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "Worker chunks %lu",
+        (unsigned long)s->rx_chunks
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += DIAG_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "CB max %luus avg %luus",
+        (unsigned long)s->cb_max_us,
+        (unsigned long)(s->rx_chunks ? s->cb_total_us / s->rx_chunks : 0)
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += DIAG_LINE_HEIGHT;
+
+    if (m->logging) {
+        snprintf(
+            line,
+            sizeof(line),
+            "Log %lu  drop %lu",
+            (unsigned long)m->log_written,
+            (unsigned long)m->log_dropped
+        );
+    } else {
+        snprintf(line, sizeof(line), "OK: reset counters");
+    }
+    canvas_draw_str(canvas, 0, y, line);
+}
+
+static void blackhat_scene_diagnostics_update(BlackhatApp* app)
+{
+    with_view_model(
+        app->diag_view,
+        BlackhatDiagModel * model,
+        {
+            blackhat_uart_get_stats(app->uart, &model->uart);
+            model->baud = blackhat_uart_get_baud(app->uart);
+            model->framed = blackhat_rpc_is_framed(app->rpc);
+            model->logging = blackhat_log_is_running(app->log);
+            model->log_written = blackhat_log_get_written(app->log);
+            model->log_dropped = blackhat_log_get_dropped(app->log);
+        },
+        true
+    );
+}
+
+static bool blackhat_scene_diagnostics_input_callback(
+    InputEvent* event, void* context
+)
+{
+    BlackhatApp* app = context;
+
+    if (event->key == InputKeyOk && event->type == InputTypeShort) {
+        blackhat_uart_reset_stats(app->uart);
+        blackhat_scene_diagnostics_update(app);
+        return true;
+    }
+
+#if BLACKHAT_TRACE
+    if (event->key == InputKeyRight && event->type == InputTypeShort) {
+        blackhat_trace_dump(BLACKHAT_TRACE_PATH);
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+void blackhat_scene_diagnostics_on_enter(void* context)
+{
+    BlackhatApp* app = context;
+    View* view = app->diag_view;
+
+    view_set_context(view, app);
+    view_set_draw_callback(view, blackhat_scene_diagnostics_draw_callback);
+    view_set_input_callback(view, blackhat_scene_diagnostics_input_callback);
+
+    blackhat_scene_diagnostics_update(app);
+
+    view_dispatcher_switch_to_view(
+        app->view_dispatcher, BlackhatAppViewDiagnostics
+    );
+}
+
+bool blackhat_scene_diagnostics_on_event(
+    void* context, SceneManagerEvent event
+)
+{
+    BlackhatApp* app = context;
+
+    if (event.type == SceneManagerEventTypeTick) {
+        blackhat_scene_diagnostics_update(app);
+        return true;
+    }
+
+    return false;
+}
+
+void blackhat_scene_diagnostics_on_exit(void* context)
+{
+    UNUSED(context);
+}
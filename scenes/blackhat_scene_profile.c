@@ -0,0 +1,222 @@
+#include "../blackhat_app_i.h"
+#include <gui/canvas.h>
+
+#define PROFILE_LINE_HEIGHT (9)
+#define PROFILE_LINES (7)
+#define PROFILE_GRAPH_TOP (PROFILE_LINE_HEIGHT + 2)
+#define PROFILE_GRAPH_HEIGHT (64 - PROFILE_GRAPH_TOP)
+
+static void blackhat_scene_profile_draw_heap(
+    Canvas* canvas, const BlackhatProfileStats* s
+)
+{
+    char line[40];
+    uint8_t y = PROFILE_LINE_HEIGHT - 1;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "Heap %lu min %lu",
+        (unsigned long)s->heap_free,
+        (unsigned long)s->heap_free_min
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += PROFILE_LINE_HEIGHT;
+
+    // How much of the free heap can't be had in one piece
+    snprintf(
+        line,
+        sizeof(line),
+        "Block %lu min %lu %lu%%",
+        (unsigned long)s->max_block,
+        (unsigned long)s->max_block_min,
+        (unsigned long)(s->heap_free ?
+                            100 - s->max_block * 100 / s->heap_free :
+                            0)
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += PROFILE_LINE_HEIGHT;
+
+    canvas_draw_str(canvas, 0, y, "Stack free/size:");
+    y += PROFILE_LINE_HEIGHT;
+
+    for (size_t i = 0; i < s->num_threads; i++) {
+        const BlackhatProfileThread* t = &s->threads[i];
+        snprintf(
+            line,
+            sizeof(line),
+            " %s %lu/%lu",
+            t->name,
+            (unsigned long)t->stack_free,
+            (unsigned long)t->stack_size
+        );
+        canvas_draw_str(canvas, 0, y, line);
+        y += PROFILE_LINE_HEIGHT;
+    }
+
+    canvas_draw_str(canvas, 0, 63, "<> page  OK: reset");
+}
+
+static void blackhat_scene_profile_draw_scenes(
+    Canvas* canvas, const BlackhatProfileStats* s
+)
+{
+    char line[40];
+    uint8_t y = PROFILE_LINE_HEIGHT - 1;
+    bool shown[BlackhatSceneNum] = {false};
+
+    canvas_draw_str(canvas, 0, y, "Peak heap use by scene");
+    y += PROFILE_LINE_HEIGHT;
+
+    // Highest first, as many as fit
+    for (size_t n = 1; n < PROFILE_LINES; n++) {
+        size_t top = BlackhatSceneNum;
+        for (size_t i = 0; i < BlackhatSceneNum; i++) {
+            if (shown[i] || !s->scene_peak[i]) continue;
+            if (top == BlackhatSceneNum ||
+                s->scene_peak[i] > s->scene_peak[top]) {
+                top = i;
+            }
+        }
+        if (top == BlackhatSceneNum) break;
+        shown[top] = true;
+
+        snprintf(
+            line,
+            sizeof(line),
+            "%s %lu",
+            blackhat_scene_get_name(top),
+            (unsigned long)s->scene_peak[top]
+        );
+        canvas_draw_str(canvas, 0, y, line);
+        y += PROFILE_LINE_HEIGHT;
+    }
+}
+
+static void blackhat_scene_profile_draw_history(
+    Canvas* canvas, const BlackhatProfileStats* s
+)
+{
+    char line[40];
+    uint32_t low = UINT32_MAX;
+    uint32_t high = 0;
+
+    for (size_t i = 0; i < s->history_count; i++) {
+        low = MIN(low, s->history[i]);
+        high = MAX(high, s->history[i]);
+    }
+    if (!s->history_count) low = high = 0;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "Free %lu..%lu",
+        (unsigned long)low,
+        (unsigned long)high
+    );
+    canvas_draw_str(canvas, 0, PROFILE_LINE_HEIGHT - 1, line);
+    canvas_draw_frame(canvas, 0, PROFILE_GRAPH_TOP, 128, PROFILE_GRAPH_HEIGHT);
+
+    // Two pixels per period, the newest sample on the right
+    uint8_t x = 128 - s->history_count * 2;
+    uint32_t range = MAX(high - low, 1U);
+    for (size_t i = 0; i < s->history_count; i++, x += 2) {
+        uint32_t h = (s->history[i] - low) * (PROFILE_GRAPH_HEIGHT - 3) / range;
+        uint8_t y = PROFILE_GRAPH_TOP + PROFILE_GRAPH_HEIGHT - 2 - h;
+        canvas_draw_line(canvas, x, y, x + 1, y);
+    }
+}
+
+static void blackhat_scene_profile_draw_callback(Canvas* canvas, void* model)
+{
+    const BlackhatProfileModel* m = model;
+
+    canvas_clear(canvas);
+    canvas_set_font(canvas, FontSecondary);
+
+    switch (m->page) {
+    case BlackhatProfilePageHeap:
+        blackhat_scene_profile_draw_heap(canvas, &m->stats);
+        break;
+    case BlackhatProfilePageScenes:
+        blackhat_scene_profile_draw_scenes(canvas, &m->stats);
+        break;
+    default:
+        blackhat_scene_profile_draw_history(canvas, &m->stats);
+        break;
+    }
+}
+
+static void blackhat_scene_profile_update(BlackhatApp* app)
+{
+    with_view_model(
+        app->profile_view,
+        BlackhatProfileModel * model,
+        { blackhat_profile_get_stats(app->profile, &model->stats); },
+        true
+    );
+}
+
+static bool blackhat_scene_profile_input_callback(
+    InputEvent* event, void* context
+)
+{
+    BlackhatApp* app = context;
+
+    if (event->type != InputTypeShort) return false;
+
+    if (event->key == InputKeyOk) {
+        blackhat_profile_reset(app->profile);
+        blackhat_scene_profile_update(app);
+        return true;
+    }
+
+    if (event->key == InputKeyLeft || event->key == InputKeyRight) {
+        int8_t step = event->key == InputKeyRight ? 1 : -1;
+        with_view_model(
+            app->profile_view,
+            BlackhatProfileModel * model,
+            {
+                model->page = (model->page + BlackhatProfilePageCount + step) %
+                              BlackhatProfilePageCount;
+            },
+            true
+        );
+        return true;
+    }
+
+    return false;
+}
+
+void blackhat_scene_profile_on_enter(void* context)
+{
+    BlackhatApp* app = context;
+    View* view = app->profile_view;
+
+    view_set_context(view, app);
+    view_set_draw_callback(view, blackhat_scene_profile_draw_callback);
+    view_set_input_callback(view, blackhat_scene_profile_input_callback);
+
+    blackhat_scene_profile_update(app);
+
+    view_dispatcher_switch_to_view(
+        app->view_dispatcher, BlackhatAppViewProfile
+    );
+}
+
+bool blackhat_scene_profile_on_event(void* context, SceneManagerEvent event)
+{
+    BlackhatApp* app = context;
+
+    if (event.type == SceneManagerEventTypeTick) {
+        blackhat_scene_profile_update(app);
+        return true;
+    }
+
+    return false;
+}
+
+void blackhat_scene_profile_on_exit(void* context)
+{
+    UNUSED(context);
+}
@@ -13,62 +13,87 @@ void blackhat_text_input_callback(void* context)
     );
 }
 
+static const char* blackhat_scene_rename_param_key(BlackhatApp* app)
+{
+    return &app->selected_tx_string[strlen(SET_CMD_PREFIX)];
+}
+
+static void blackhat_scene_rename_show_input(BlackhatApp* app)
+{
+    text_input_set_result_callback(
+        app->text_input,
+        blackhat_text_input_callback,
+        app,
+        app->text_input_ch,
+        ENTER_NAME_LENGTH,
+        false
+    );
+
+    view_dispatcher_switch_to_view(
+        app->view_dispatcher, BlackhatAppViewTextInput
+    );
+    scene_manager_set_scene_state(app->scene_manager, BlackhatSceneRename, 1);
+}
+
 void blackhat_scene_rename_on_enter(void* context)
 {
     BlackhatApp* app = context;
-    TextInput* text_input = app->text_input;
 
-    size_t i = 0;
-    size_t str_start = 0;
+    memset(app->text_input_ch,0x00, ENTER_NAME_LENGTH);
+    scene_manager_set_scene_state(app->scene_manager, BlackhatSceneRename, 0);
 
     // Register callback to receive data
     blackhat_uart_set_handle_rx_data_cb(
         app->uart, blackhat_console_output_handle_rx_data_cb
     );
 
+    blackhat_response_start(app->response);
     blackhat_uart_tx(app->uart, app->text_store, strlen(app->text_store));
 
-    // Wait for all of the uart
-    memset(app->text_input_ch,0x00, ENTER_NAME_LENGTH);
-    furi_delay_ms(500);
-    app->script_text_ptr++;
-    app->script_text[app->script_text_ptr] = 0x00;
-
-    while (app->script_text[i++]) {
-        if (app->script_text[i] == '\n') {
-            if(!str_start)
-                str_start = i+1;
-            else {
-                app->script_text[i] = '\0';
-                memcpy(
-                    app->text_input_ch,
-                    &app->script_text[str_start],
-                    i - str_start - 1
-                );
-                break;
-            }
-        }
-    }
-
-    text_input_set_result_callback(
-        text_input,
-        blackhat_text_input_callback,
-        context,
-        app->text_input_ch,
-        ENTER_NAME_LENGTH,
-        false
-    );
-
-    view_dispatcher_switch_to_view(
-        app->view_dispatcher, BlackhatAppViewTextInput
+    // A cached value opens the input right away, the device answer only
+    // refreshes the cache. Otherwise wait for the response to complete.
+    const char* cached = blackhat_store_param_get(
+        &app->params, blackhat_scene_rename_param_key(app)
     );
+    if (cached) {
+        strlcpy(app->text_input_ch, cached, ENTER_NAME_LENGTH);
+        blackhat_scene_rename_show_input(app);
+    } else {
+        view_dispatcher_switch_to_view(
+            app->view_dispatcher, BlackhatAppViewLoading
+        );
+    }
 }
 
 bool blackhat_scene_rename_on_event(void* context, SceneManagerEvent event)
 {
     BlackhatApp* app = context;
     bool consumed = false;
-    if (event.type == SceneManagerEventTypeCustom) {
+    if (event.type == SceneManagerEventTypeCustom &&
+        event.event == BlackhatEventResponseDone) {
+        blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+
+        // The first line echoes the command, the second one holds the value
+        blackhat_line_list_finish(&app->param_lines);
+        app->rx_lines = NULL;
+
+        const char* value = blackhat_line_list_get(&app->param_lines, 1);
+        if (value) {
+            blackhat_store_param_set(
+                &app->params, blackhat_scene_rename_param_key(app), value
+            );
+            blackhat_store_save(&app->script_list, &app->params, &app->schema);
+        }
+
+        if (!scene_manager_get_scene_state(
+                app->scene_manager, BlackhatSceneRename
+            )) {
+            if (value) strlcpy(app->text_input_ch, value, ENTER_NAME_LENGTH);
+            blackhat_scene_rename_show_input(app);
+        }
+        consumed = true;
+    } else if (event.type == SceneManagerEventTypeCustom &&
+        event.event == BlackhatEventTextInput) {
         snprintf(
             app->text_store,
             sizeof(app->text_store),
@@ -77,8 +102,16 @@ bool blackhat_scene_rename_on_event(void* context, SceneManagerEvent event)
             app->text_input_ch
         );
 
+        blackhat_cache_invalidate(app->cache, app->text_store);
         blackhat_uart_tx(app->uart, app->text_store, strlen(app->text_store));
 
+        blackhat_store_param_set(
+            &app->params,
+            blackhat_scene_rename_param_key(app),
+            app->text_input_ch
+        );
+        blackhat_store_save(&app->script_list, &app->params, &app->schema);
+
         scene_manager_search_and_switch_to_previous_scene(
             app->scene_manager, BlackhatSceneStart
         );
@@ -91,5 +124,8 @@ bool blackhat_scene_rename_on_event(void* context, SceneManagerEvent event)
 void blackhat_scene_rename_on_exit(void* context)
 {
     BlackhatApp* app = context;
+    blackhat_response_cancel(app->response);
+    blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+    app->rx_lines = NULL;
     variable_item_list_reset(app->var_item_list);
 }
@@ -11,7 +11,9 @@ static void blackhat_scene_script_list_enter_callback(
 
     console = true;
     app->selected_tx_string = RUN_CMD;
-    app->selected_option_item_text = app->cmd[index + 1];
+    // Line 0 is the echoed scan command
+    app->selected_option_item_text =
+        blackhat_line_list_get(&app->script_list, index + 1);
     app->text_input_req = false;
     app->selected_menu_index = index;
 
@@ -27,59 +29,96 @@ static void blackhat_scene_script_list_change_callback(VariableItem* item)
     UNUSED(item);
 }
 
-void blackhat_scene_scripts_on_enter(void* context)
+void blackhat_console_output_handle_rx_data_cb(
+    uint8_t* buf, size_t len, void* context
+);
+
+static void blackhat_scene_scripts_build(BlackhatApp* app)
 {
-    BlackhatApp* app = context;
     VariableItemList* var_item_list = app->script_item_list;
-    size_t i = 0;
-    int start = 0;
-    app->num_scripts = 0;
-
-    console = false;
-
-    while (app->script_text[i++]) {
-        if (app->script_text[i] == '\n') {
-            i++;
-
-            if(app->cmd[app->num_scripts]) {
-                free(app->cmd[app->num_scripts]);
-            }
-
-            app->cmd[app->num_scripts] = malloc(i - start);
-
-            memcpy(
-                app->cmd[app->num_scripts], &app->script_text[start], i - start
-            );
-            start = i;
-            app->num_scripts++;
-        }
-    }
+    size_t num_lines = blackhat_line_list_count(&app->script_list);
 
+    variable_item_list_reset(var_item_list);
     variable_item_list_set_enter_callback(
         var_item_list, blackhat_scene_script_list_enter_callback, app
     );
 
-    for (int i = 1; i < app->num_scripts; i++) {
+    for (size_t i = 1; i < num_lines; i++) {
         variable_item_list_add(
             var_item_list,
-            app->cmd[i],
+            blackhat_line_list_get(&app->script_list, i),
             1,
             blackhat_scene_script_list_change_callback,
             app
         );
     }
+}
+
+// The list shown may come from the SD cache, rescan quietly behind it
+static void blackhat_scene_scripts_revalidate(BlackhatApp* app)
+{
+    static const char scan_cmd[] = SCAN_CMD "\n";
+
+    blackhat_line_list_reset(&app->script_update);
+    app->rx_lines = &app->script_update;
+    blackhat_uart_set_handle_rx_data_cb(
+        app->uart, blackhat_console_output_handle_rx_data_cb
+    );
+    blackhat_response_start(app->response);
+    blackhat_uart_tx(app->uart, (char*)scan_cmd, sizeof(scan_cmd) - 1);
+}
+
+void blackhat_scene_scripts_on_enter(void* context)
+{
+    BlackhatApp* app = context;
+
+    console = false;
+
+    blackhat_scene_scripts_build(app);
 
     view_dispatcher_switch_to_view(
         app->view_dispatcher, BlackhatAppViewScriptItemList
     );
+
+    if (!app->scripts_validated) {
+        blackhat_scene_scripts_revalidate(app);
+    }
 }
 
 bool blackhat_scene_scripts_on_event(void* context, SceneManagerEvent event)
 {
-    UNUSED(context);
-    UNUSED(event);
+    BlackhatApp* app = context;
+
+    if (event.type != SceneManagerEventTypeCustom ||
+        event.event != BlackhatEventResponseDone ||
+        app->rx_lines != &app->script_update) {
+        return false;
+    }
+
+    // The worker may still be appending, the lists swap below
+    blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+    blackhat_uart_rx_sync(app->uart);
+    app->rx_lines = NULL;
+    blackhat_line_list_finish(&app->script_update);
+
+    // No echo of the scan means the device never answered, keep the cache
+    const char* echo = blackhat_line_list_get(&app->script_update, 0);
+    if (!echo || !strstr(echo, SCAN_CMD)) {
+        return true;
+    }
+    app->scripts_validated = true;
+
+    if (blackhat_store_list_hash(&app->script_update) !=
+        blackhat_store_list_hash(&app->script_list)) {
+        BlackhatLineList scripts = app->script_list;
+        app->script_list = app->script_update;
+        app->script_update = scripts;
 
-    return false;
+        blackhat_scene_scripts_build(app);
+        blackhat_store_save(&app->script_list, &app->params, &app->schema);
+    }
+
+    return true;
 }
 
 void blackhat_scene_scripts_on_exit(void* context)
@@ -87,6 +126,13 @@ void blackhat_scene_scripts_on_exit(void* context)
     BlackhatApp* app = context;
     variable_item_list_reset(app->script_item_list);
 
+    if (app->rx_lines == &app->script_update) {
+        blackhat_response_cancel(app->response);
+        blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+        blackhat_uart_rx_sync(app->uart);
+        app->rx_lines = NULL;
+    }
+
     if(!console) {
         scene_manager_search_and_switch_to_previous_scene(
             app->scene_manager, BlackhatSceneStart
@@ -1,52 +1,8 @@
 #include "../blackhat_app_i.h"
 
-BlackhatItem items[] = {
-    {"Shell", {""}, 1, NULL, SHELL_CMD, false},
-    {"Scan for Scripts", {""}, 1, NULL, SCAN_CMD, false},
-    {"Run Script", {""}, 1, NULL, CHG_RUN_CMD_SCREEN, false},
-    {"BHtui (Screen Only)", {""}, 1, NULL, BHTUI_CMD, false},
-    {"Connect WiFi",
-     {"wlan0", "wlan1", "wlan2", "stop"},
-     4,
-     NULL,
-     WIFI_CON_CMD,
-     FOCUS_CONSOLE_END},
-    {"Set inet SSID", {""}, 1, NULL, SET_INET_SSID_CMD, true},
-    {"Set inet Password", {""}, 1, NULL, SET_INET_PWD_CMD, true},
-    {"Set AP SSID", {""}, 1, NULL, SET_AP_SSID_CMD, true},
-    {"List Networks",
-     {"wlan0", "wlan1", "wlan2"},
-     3,
-     NULL,
-     LIST_AP_CMD,
-     FOCUS_CONSOLE_END},
-    {"Wifi Device Info", {""}, 1, NULL, DEV_CMD, false},
-    {"Deauth Broadcast",
-     {"wlan0", "wlan1", "wlan2"},
-     3,
-     NULL,
-     DEAUTH_CMD,
-     FOCUS_CONSOLE_END},
-    {"Enable AP",
-     {"wlan0", "wlan1", "wlan2", "stop"},
-     4,
-     NULL,
-     START_AP_CMD,
-     FOCUS_CONSOLE_END},
-    {"Start Kismet",
-     {"wlan0", "wlan1", "wlan2", "stop"},
-     4,
-     NULL,
-     START_KISMET_CMD,
-     FOCUS_CONSOLE_END},
-    {"Get IP", {""}, 1, NULL, GET_IP_CMD, false},
-    {"SSH", {"start", "stop"}, 2, NULL, START_SSH_CMD, false},
-    {"Start Evil Twin", {""}, 1, NULL, ST_EVIL_TWIN_CMD, false},
-    {"Evil Portal", {"start", "stop"}, 2, NULL, ST_EVIL_PORT_CMD, false},
-    {"Test Internet (ping)", {""}, 1, NULL, TEST_INET, false},
-    {"Get Params", {""}, 1, NULL, GET_CMD, false},
-    {"Reboot", {""}, 1, NULL, REBOOT_CMD, false},
-};
+void blackhat_console_output_handle_rx_data_cb(
+    uint8_t* buf, size_t len, void* context
+);
 
 static void blackhat_scene_start_var_list_enter_callback(
     void* context, uint32_t index
@@ -55,8 +11,8 @@ static void blackhat_scene_start_var_list_enter_callback(
     furi_assert(context);
     BlackhatApp* app = context;
 
-    furi_assert(index < NUM_MENU_ITEMS);
-    const BlackhatItem* item = &items[index];
+    furi_assert(index < app->menu.count);
+    const BlackhatItem* item = &app->menu.items[index];
 
     const int selected_option_index = app->selected_option_index[index];
     furi_assert(selected_option_index < item->num_options_menu);
@@ -66,8 +22,22 @@ static void blackhat_scene_start_var_list_enter_callback(
 
     app->selected_option_item_text = item->selected_option;
 
-    if (!strcmp(item->actual_command, BHTUI_CMD)) {
+    if (!strcmp(item->actual_command, LOG_TOGGLE_CMD)) {
+        // Toggled from the option itself, nothing to send
+        return;
+    } else if (!strcmp(item->actual_command, BHTUI_CMD) ||
+               !strcmp(item->actual_command, BHTUI_MIRROR_CMD)) {
         scene_manager_next_scene(app->scene_manager, BlackhatSceneTui);
+    } else if (!strcmp(item->actual_command, BLACKHAT_BENCH_CMD)) {
+        scene_manager_next_scene(app->scene_manager, BlackhatSceneBench);
+    } else if (!strcmp(item->actual_command, DIAG_CMD)) {
+        scene_manager_next_scene(app->scene_manager, BlackhatSceneDiagnostics);
+    } else if (!strcmp(item->actual_command, DASH_CMD)) {
+        scene_manager_next_scene(app->scene_manager, BlackhatSceneDashboard);
+    } else if (!strcmp(item->actual_command, PROFILE_CMD)) {
+        scene_manager_next_scene(app->scene_manager, BlackhatSceneProfile);
+    } else if (!strcmp(item->actual_command, XFER_CMD)) {
+        scene_manager_next_scene(app->scene_manager, BlackhatSceneXfer);
     } else {
         scene_manager_next_scene(
             app->scene_manager, BlackhatAppViewConsoleOutput
@@ -84,7 +54,7 @@ static void blackhat_scene_start_var_list_change_callback(VariableItem* item)
 
     app->selected_menu_index = variable_item_list_get_selected_item_index(app->var_item_list);
 
-    const BlackhatItem* menu_item = &items[app->selected_menu_index];
+    BlackhatItem* menu_item = &app->menu.items[app->selected_menu_index];
 
     uint8_t item_index = variable_item_get_current_value_index(item);
     furi_assert(item_index < menu_item->num_options_menu);
@@ -92,55 +62,150 @@ static void blackhat_scene_start_var_list_change_callback(VariableItem* item)
     variable_item_set_current_value_text(
         item, menu_item->options_menu[item_index]
     );
-    items[app->selected_menu_index].selected_option =
-        menu_item->options_menu[item_index];
+    menu_item->selected_option = menu_item->options_menu[item_index];
 
     app->selected_option_index[app->selected_menu_index] = item_index;
+
+    if (!strcmp(menu_item->actual_command, LOG_TOGGLE_CMD)) {
+        if (item_index) {
+            if (!blackhat_log_start(app->log)) {
+                variable_item_set_current_value_index(item, 0);
+                variable_item_set_current_value_text(
+                    item, menu_item->options_menu[0]
+                );
+                app->selected_option_index[app->selected_menu_index] = 0;
+            }
+        } else {
+            blackhat_log_stop(app->log);
+        }
+    }
 }
 
-void blackhat_scene_start_on_enter(void* context)
+static void blackhat_scene_start_build(BlackhatApp* app)
 {
-    BlackhatApp* app = context;
     VariableItemList* var_item_list = app->var_item_list;
 
+    variable_item_list_reset(var_item_list);
     variable_item_list_set_enter_callback(
         var_item_list, blackhat_scene_start_var_list_enter_callback, app
     );
 
     VariableItem* item;
-    for (int i = 0; i < NUM_MENU_ITEMS; ++i) {
+    for (size_t i = 0; i < app->menu.count; ++i) {
+        BlackhatItem* menu_item = &app->menu.items[i];
+        int option = app->selected_option_index[i];
+
         item = variable_item_list_add(
             var_item_list,
-            items[i].item_string,
-            items[i].num_options_menu,
+            menu_item->item_string,
+            menu_item->num_options_menu,
             blackhat_scene_start_var_list_change_callback,
             app
         );
 
-        items[i].selected_option = items[i].options_menu[0];
+        menu_item->selected_option = menu_item->options_menu[option];
 
-        variable_item_set_current_value_index(
-            item, app->selected_option_index[i]
-        );
+        variable_item_set_current_value_index(item, option);
         variable_item_set_current_value_text(
-            item, items[i].options_menu[app->selected_option_index[i]]
+            item, menu_item->options_menu[option]
         );
     }
+}
+
+// The menu shown may come from the SD cache, ask whether it is still current
+static void blackhat_scene_start_revalidate(BlackhatApp* app)
+{
+    char cmd[sizeof(BLACKHAT_MENU_CMD) + BLACKHAT_MENU_HASH_MAX + 2];
+    snprintf(
+        cmd,
+        sizeof(cmd),
+        BLACKHAT_MENU_CMD " %s\n",
+        blackhat_menu_schema_hash(&app->schema)
+    );
+
+    blackhat_line_list_reset(&app->schema_update);
+    app->rx_lines = &app->schema_update;
+    blackhat_uart_set_handle_rx_data_cb(
+        app->uart, blackhat_console_output_handle_rx_data_cb
+    );
+    blackhat_response_start(app->response);
+    blackhat_uart_tx(app->uart, cmd, strlen(cmd));
+}
+
+void blackhat_scene_start_on_enter(void* context)
+{
+    BlackhatApp* app = context;
+
+    blackhat_scene_start_build(app);
 
     view_dispatcher_switch_to_view(
         app->view_dispatcher, BlackhatAppViewVarItemList
     );
+
+    if (app->link_ready && !app->schema_validated) {
+        blackhat_scene_start_revalidate(app);
+    }
 }
 
 bool blackhat_scene_start_on_event(void* context, SceneManagerEvent event)
 {
-    UNUSED(context);
-    UNUSED(event);
-    return false;
+    BlackhatApp* app = context;
+
+    // The first menu is up before the device, ask once it answers
+    if (event.type == SceneManagerEventTypeCustom &&
+        event.event == BlackhatEventLinkReady) {
+        if (!app->schema_validated && !app->rx_lines) {
+            blackhat_scene_start_revalidate(app);
+        }
+        return true;
+    }
+
+    if (event.type != SceneManagerEventTypeCustom ||
+        event.event != BlackhatEventResponseDone ||
+        app->rx_lines != &app->schema_update) {
+        return false;
+    }
+
+    blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+    app->rx_lines = NULL;
+    blackhat_line_list_finish(&app->schema_update);
+
+    // No echo means the device never answered, keep what we have
+    const char* echo = blackhat_line_list_get(&app->schema_update, 0);
+    if (!echo || !strstr(echo, BLACKHAT_MENU_CMD)) {
+        return true;
+    }
+    app->schema_validated = true;
+
+    // "= <hash>" when unchanged, older firmware doesn't know the command
+    if (blackhat_menu_schema_update(&app->schema, &app->schema_update)) {
+        uint32_t selected =
+            variable_item_list_get_selected_item_index(app->var_item_list);
+
+        blackhat_menu_build(&app->menu, &app->schema);
+        memset(
+            app->selected_option_index,
+            0,
+            sizeof(app->selected_option_index)
+        );
+        blackhat_scene_start_build(app);
+        variable_item_list_set_selected_item(
+            app->var_item_list, MIN(selected, app->menu.count - 1)
+        );
+        blackhat_store_save(&app->script_list, &app->params, &app->schema);
+    }
+
+    return true;
 }
 
 void blackhat_scene_start_on_exit(void* context)
 {
     BlackhatApp* app = context;
     variable_item_list_reset(app->var_item_list);
+
+    if (app->rx_lines == &app->schema_update) {
+        blackhat_response_cancel(app->response);
+        blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+        app->rx_lines = NULL;
+    }
 }
@@ -1,6 +1,8 @@
 #include "../blackhat_app_i.h"
 #include <gui/canvas.h>
 
+#define TAG "BlackhatTui"
+
 #define GAME_EXIT_HOLD_MS (5000)
 #define A_HOLD_DELAY_MS   (100)
 
@@ -25,17 +27,77 @@
 #define GAME_MODE_STARTED      (0x91)
 #define GAME_MODE_STOPPED      (0x92)
 
+// Newer bhtui announces game mode with GAME_MODE_FRAMES instead, and then
+// takes the whole controller state in one frame per change:
+//   STATE_FRAME, seq, buttons 0-6, button 7, seq ^ buttons 0-6 ^ button 7
+// Everything after the header stays below 0x80 so a receiver resyncs on
+// the next header. The last frame is repeated while idle, so a lost frame
+// can't leave a button stuck.
+#define GAME_MODE_FRAMES       (0x93)
+#define STATE_FRAME            (0x94)
+#define STATE_FRAME_SIZE       (5)
+#define STATE_KEEPALIVE_MS     (500)
+
+// Bit positions in the state frame, in the order of the edge bytes
+typedef enum {
+    GameButtonUp,
+    GameButtonDown,
+    GameButtonLeft,
+    GameButtonRight,
+    GameButtonA,
+    GameButtonB,
+    GameButtonSelect,
+    GameButtonStart,
+} GameButton;
+
 static void blackhat_scene_tui_send_byte(BlackhatApp* app, uint8_t byte)
 {
-    blackhat_uart_tx(app->uart, (char*)&byte, 1);
+    blackhat_uart_tx_urgent(app->uart, (char*)&byte, 1);
+}
+
+static void blackhat_scene_tui_send_frame(BlackhatApp* app)
+{
+    uint8_t lo = app->tui_buttons & 0x7f;
+    uint8_t hi = app->tui_buttons >> 7;
+    uint8_t frame[STATE_FRAME_SIZE] = {
+        STATE_FRAME, app->tui_seq, lo, hi, app->tui_seq ^ lo ^ hi
+    };
+
+    blackhat_uart_tx_urgent(app->uart, (char*)frame, sizeof(frame));
+    app->tui_buttons_sent = app->tui_buttons;
+    app->tui_frame_at = furi_get_tick();
 }
 
-static void blackhat_scene_tui_send_tap(
-    BlackhatApp* app, uint8_t pressed, uint8_t released
+// Edge mode sends the change straight away, state frames wait for a flush
+static void blackhat_scene_tui_set_button(
+    BlackhatApp* app, GameButton button, bool pressed
 )
 {
-    blackhat_scene_tui_send_byte(app, pressed);
-    blackhat_scene_tui_send_byte(app, released);
+    if(!app->tui_state_frames) {
+        blackhat_scene_tui_send_byte(
+            app, BUTTON_UP_PRESSED + button * 2 + (pressed ? 0 : 1)
+        );
+    } else if(pressed) {
+        app->tui_buttons |= 1 << button;
+    } else {
+        app->tui_buttons &= ~(1 << button);
+    }
+}
+
+// One frame for everything an input event changed, so chords go together
+static void blackhat_scene_tui_flush(BlackhatApp* app)
+{
+    if(app->tui_state_frames && app->tui_buttons != app->tui_buttons_sent) {
+        app->tui_seq = (app->tui_seq + 1) & 0x7f;
+        blackhat_scene_tui_send_frame(app);
+    }
+}
+
+static void blackhat_scene_tui_send_tap(BlackhatApp* app, GameButton button)
+{
+    blackhat_scene_tui_set_button(app, button, true);
+    blackhat_scene_tui_flush(app);
+    blackhat_scene_tui_set_button(app, button, false);
 }
 
 static void blackhat_scene_tui_reset_game_input(BlackhatApp* app)
@@ -47,11 +109,33 @@ static void blackhat_scene_tui_reset_game_input(BlackhatApp* app)
     app->tui_right_chord = false;
     app->tui_back_held = false;
     app->tui_back_exit_sent = false;
-    app->tui_ok_pressed_at = 0;
-    app->tui_back_pressed_at = 0;
+    app->tui_buttons = 0;
+    app->tui_buttons_sent = 0;
+    app->tui_seq = 0;
+    blackhat_deadline_cancel(app->tui_a_hold);
+    blackhat_deadline_cancel(app->tui_back_hold);
+}
+
+static void blackhat_scene_tui_log_deadline(
+    const char* name, BlackhatDeadline* deadline
+)
+{
+    BlackhatDeadlineStats stats;
+    blackhat_deadline_get_stats(deadline, &stats);
+    if (!stats.fired) return;
+
+    FURI_LOG_I(
+        TAG,
+        "%s hold: %lu fired, late avg %lu us max %lu us",
+        name,
+        (unsigned long)stats.fired,
+        (unsigned long)(stats.late_total_us / stats.fired),
+        (unsigned long)stats.late_max_us
+    );
+    blackhat_deadline_reset_stats(deadline);
 }
 
-static void blackhat_scene_tui_handle_rx_data(
+void blackhat_scene_tui_handle_rx_data(
     uint8_t* buf, size_t len, void* context
 )
 {
@@ -63,12 +147,37 @@ static void blackhat_scene_tui_handle_rx_data(
             view_dispatcher_send_custom_event(
                 app->view_dispatcher, BlackhatEventTuiGameModeStarted
             );
+        } else if(buf[i] == GAME_MODE_FRAMES) {
+            view_dispatcher_send_custom_event(
+                app->view_dispatcher, BlackhatEventTuiGameModeFrames
+            );
         } else if(buf[i] == GAME_MODE_STOPPED) {
             view_dispatcher_send_custom_event(
                 app->view_dispatcher, BlackhatEventTuiGameModeStopped
             );
         }
     }
+
+    // Mirror records stop at game mode bytes, so both can share a chunk
+    if(app->tui_mirror && blackhat_mirror_feed(app->mirror, buf, len)) {
+        view_dispatcher_send_custom_event(
+            app->view_dispatcher, BlackhatEventTuiMirrorSync
+        );
+    }
+}
+
+static void blackhat_scene_tui_on_fb_frame(
+    uint8_t type, uint8_t id, const uint8_t* data, size_t len, void* context
+)
+{
+    BlackhatApp* app = context;
+
+    if(type == BlackhatProtoFramebuffer &&
+       blackhat_fb_feed(app->fb, id, data, len)) {
+        view_dispatcher_send_custom_event(
+            app->view_dispatcher, BlackhatEventTuiFrame
+        );
+    }
 }
 
 static void blackhat_scene_tui_draw_callback(Canvas* canvas, void* model)
@@ -94,17 +203,17 @@ static bool blackhat_scene_tui_game_input(
     switch(event->key) {
     case InputKeyUp:
         if(event->type == InputTypePress) {
-            blackhat_scene_tui_send_byte(app, BUTTON_UP_PRESSED);
+            blackhat_scene_tui_set_button(app, GameButtonUp, true);
         } else if(event->type == InputTypeRelease) {
-            blackhat_scene_tui_send_byte(app, BUTTON_UP_RELEASED);
+            blackhat_scene_tui_set_button(app, GameButtonUp, false);
         }
         return true;
 
     case InputKeyDown:
         if(event->type == InputTypePress) {
-            blackhat_scene_tui_send_byte(app, BUTTON_DOWN_PRESSED);
+            blackhat_scene_tui_set_button(app, GameButtonDown, true);
         } else if(event->type == InputTypeRelease) {
-            blackhat_scene_tui_send_byte(app, BUTTON_DOWN_RELEASED);
+            blackhat_scene_tui_set_button(app, GameButtonDown, false);
         }
         return true;
 
@@ -112,21 +221,22 @@ static bool blackhat_scene_tui_game_input(
         if(event->type == InputTypePress) {
             if(app->tui_ok_held) {
                 if(app->tui_a_pressed) {
-                    blackhat_scene_tui_send_byte(app, BUTTON_A_RELEASED);
+                    blackhat_scene_tui_set_button(app, GameButtonA, false);
                     app->tui_a_pressed = false;
                 }
+                blackhat_deadline_cancel(app->tui_a_hold);
                 app->tui_ok_chord_used = true;
                 app->tui_left_chord = true;
-                blackhat_scene_tui_send_byte(app, BUTTON_SELECT_PRESSED);
+                blackhat_scene_tui_set_button(app, GameButtonSelect, true);
             } else {
-                blackhat_scene_tui_send_byte(app, BUTTON_LEFT_PRESSED);
+                blackhat_scene_tui_set_button(app, GameButtonLeft, true);
             }
         } else if(event->type == InputTypeRelease) {
             if(app->tui_left_chord) {
-                blackhat_scene_tui_send_byte(app, BUTTON_SELECT_RELEASED);
+                blackhat_scene_tui_set_button(app, GameButtonSelect, false);
                 app->tui_left_chord = false;
             } else {
-                blackhat_scene_tui_send_byte(app, BUTTON_LEFT_RELEASED);
+                blackhat_scene_tui_set_button(app, GameButtonLeft, false);
             }
         }
         return true;
@@ -135,21 +245,22 @@ static bool blackhat_scene_tui_game_input(
         if(event->type == InputTypePress) {
             if(app->tui_ok_held) {
                 if(app->tui_a_pressed) {
-                    blackhat_scene_tui_send_byte(app, BUTTON_A_RELEASED);
+                    blackhat_scene_tui_set_button(app, GameButtonA, false);
                     app->tui_a_pressed = false;
                 }
+                blackhat_deadline_cancel(app->tui_a_hold);
                 app->tui_ok_chord_used = true;
                 app->tui_right_chord = true;
-                blackhat_scene_tui_send_byte(app, BUTTON_START_PRESSED);
+                blackhat_scene_tui_set_button(app, GameButtonStart, true);
             } else {
-                blackhat_scene_tui_send_byte(app, BUTTON_RIGHT_PRESSED);
+                blackhat_scene_tui_set_button(app, GameButtonRight, true);
             }
         } else if(event->type == InputTypeRelease) {
             if(app->tui_right_chord) {
-                blackhat_scene_tui_send_byte(app, BUTTON_START_RELEASED);
+                blackhat_scene_tui_set_button(app, GameButtonStart, false);
                 app->tui_right_chord = false;
             } else {
-                blackhat_scene_tui_send_byte(app, BUTTON_RIGHT_RELEASED);
+                blackhat_scene_tui_set_button(app, GameButtonRight, false);
             }
         }
         return true;
@@ -159,14 +270,13 @@ static bool blackhat_scene_tui_game_input(
             app->tui_ok_held = true;
             app->tui_a_pressed = false;
             app->tui_ok_chord_used = false;
-            app->tui_ok_pressed_at = furi_get_tick();
+            blackhat_deadline_start(app->tui_a_hold, A_HOLD_DELAY_MS);
         } else if(event->type == InputTypeRelease) {
+            blackhat_deadline_cancel(app->tui_a_hold);
             if(app->tui_a_pressed) {
-                blackhat_scene_tui_send_byte(app, BUTTON_A_RELEASED);
+                blackhat_scene_tui_set_button(app, GameButtonA, false);
             } else if(!app->tui_ok_chord_used) {
-                blackhat_scene_tui_send_tap(
-                    app, BUTTON_A_PRESSED, BUTTON_A_RELEASED
-                );
+                blackhat_scene_tui_send_tap(app, GameButtonA);
             }
             app->tui_ok_held = false;
             app->tui_a_pressed = false;
@@ -178,11 +288,12 @@ static bool blackhat_scene_tui_game_input(
         if(event->type == InputTypePress) {
             app->tui_back_held = true;
             app->tui_back_exit_sent = false;
-            app->tui_back_pressed_at = furi_get_tick();
-            blackhat_scene_tui_send_byte(app, BUTTON_B_PRESSED);
+            blackhat_deadline_start(app->tui_back_hold, GAME_EXIT_HOLD_MS);
+            blackhat_scene_tui_set_button(app, GameButtonB, true);
         } else if(event->type == InputTypeRelease) {
+            blackhat_deadline_cancel(app->tui_back_hold);
             if(app->tui_back_held && !app->tui_back_exit_sent) {
-                blackhat_scene_tui_send_byte(app, BUTTON_B_RELEASED);
+                blackhat_scene_tui_set_button(app, GameButtonB, false);
             }
             app->tui_back_held = false;
         }
@@ -193,15 +304,14 @@ static bool blackhat_scene_tui_game_input(
     }
 }
 
-static bool blackhat_scene_tui_input_callback(
-    InputEvent* event, void* context
+static bool blackhat_scene_tui_handle_input(
+    InputEvent* event, BlackhatApp* app
 )
 {
-    BlackhatApp* app = context;
-    furi_assert(app);
-
     if(app->tui_game_mode) {
-        return blackhat_scene_tui_game_input(event, app);
+        bool consumed = blackhat_scene_tui_game_input(event, app);
+        blackhat_scene_tui_flush(app);
+        return consumed;
     }
 
     if(event->type != InputTypeShort && event->type != InputTypeRepeat) {
@@ -211,32 +321,32 @@ static bool blackhat_scene_tui_input_callback(
     switch(event->key) {
     case InputKeyUp: {
         static const char seq[] = "\x1b[A";
-        blackhat_uart_tx(app->uart, (char*)seq, sizeof(seq) - 1);
+        blackhat_uart_tx_urgent(app->uart, (char*)seq, sizeof(seq) - 1);
         return true;
     }
     case InputKeyDown: {
         static const char seq[] = "\x1b[B";
-        blackhat_uart_tx(app->uart, (char*)seq, sizeof(seq) - 1);
+        blackhat_uart_tx_urgent(app->uart, (char*)seq, sizeof(seq) - 1);
         return true;
     }
     case InputKeyLeft: {
         static const char seq[] = "\x1b[D";
-        blackhat_uart_tx(app->uart, (char*)seq, sizeof(seq) - 1);
+        blackhat_uart_tx_urgent(app->uart, (char*)seq, sizeof(seq) - 1);
         return true;
     }
     case InputKeyRight: {
         static const char seq[] = "\x1b[C";
-        blackhat_uart_tx(app->uart, (char*)seq, sizeof(seq) - 1);
+        blackhat_uart_tx_urgent(app->uart, (char*)seq, sizeof(seq) - 1);
         return true;
     }
     case InputKeyOk: {
         static const char seq[] = "\r";
-        blackhat_uart_tx(app->uart, (char*)seq, sizeof(seq) - 1);
+        blackhat_uart_tx_urgent(app->uart, (char*)seq, sizeof(seq) - 1);
         return true;
     }
     case InputKeyBack: {
         static const char seq[] = "\x03";
-        blackhat_uart_tx(app->uart, (char*)seq, sizeof(seq) - 1);
+        blackhat_uart_tx_urgent(app->uart, (char*)seq, sizeof(seq) - 1);
         scene_manager_search_and_switch_to_previous_scene(
             app->scene_manager, BlackhatSceneStart
         );
@@ -247,12 +357,28 @@ static bool blackhat_scene_tui_input_callback(
     }
 }
 
+static bool blackhat_scene_tui_input_callback(
+    InputEvent* event, void* context
+)
+{
+    BlackhatApp* app = context;
+    furi_assert(app);
+
+    // Key in the high byte, input type in the low one
+    BH_TRACE_BEGIN(BlackhatTraceTuiInput, event->key << 8 | event->type);
+    bool consumed = blackhat_scene_tui_handle_input(event, app);
+    BH_TRACE_END(BlackhatTraceTuiInput, event->key << 8 | event->type);
+
+    return consumed;
+}
+
 void blackhat_scene_tui_on_enter(void* context)
 {
     BlackhatApp* app = context;
     View* view = app->tui_view;
 
     app->tui_game_mode = false;
+    app->tui_state_frames = false;
     blackhat_scene_tui_reset_game_input(app);
     with_view_model(
         view,
@@ -265,14 +391,34 @@ void blackhat_scene_tui_on_enter(void* context)
     view_set_draw_callback(view, blackhat_scene_tui_draw_callback);
     view_set_input_callback(view, blackhat_scene_tui_input_callback);
 
+    // The mirror shows the tty until a game takes over the screen
+    app->tui_mirror = !strcmp(app->selected_tx_string, BHTUI_MIRROR_CMD);
+    View* mirror_view = blackhat_mirror_get_view(app->mirror);
+    view_set_context(mirror_view, app);
+    view_set_input_callback(mirror_view, blackhat_scene_tui_input_callback);
+    blackhat_mirror_reset(app->mirror);
+
+    View* fb_view = blackhat_fb_get_view(app->fb);
+    view_set_context(fb_view, app);
+    view_set_input_callback(fb_view, blackhat_scene_tui_input_callback);
+    blackhat_rpc_set_channel_callback(
+        app->rpc, BlackhatChannelBulk, blackhat_scene_tui_on_fb_frame, app
+    );
+
     blackhat_uart_set_handle_rx_data_cb(
         app->uart, blackhat_scene_tui_handle_rx_data
     );
 
-    view_dispatcher_switch_to_view(app->view_dispatcher, BlackhatAppViewTui);
+    view_dispatcher_switch_to_view(
+        app->view_dispatcher,
+        app->tui_mirror ? BlackhatAppViewMirror : BlackhatAppViewTui
+    );
 
     static const char start_cmd[] = BHTUI_CMD "\n";
-    blackhat_uart_tx(app->uart, (char*)start_cmd, sizeof(start_cmd) - 1);
+    static const char mirror_cmd[] = BHTUI_MIRROR_CMD "\n";
+    const char* cmd = app->tui_mirror ? mirror_cmd : start_cmd;
+    // Keys go on the urgent lane, the command must not fall behind them
+    blackhat_uart_tx_urgent(app->uart, (char*)cmd, strlen(cmd));
 }
 
 bool blackhat_scene_tui_on_event(void* context, SceneManagerEvent event)
@@ -280,19 +426,33 @@ bool blackhat_scene_tui_on_event(void* context, SceneManagerEvent event)
     BlackhatApp* app = context;
 
     if(event.type == SceneManagerEventTypeCustom) {
-        if(event.event == BlackhatEventTuiGameModeStarted) {
+        if(event.event == BlackhatEventTuiGameModeStarted ||
+           event.event == BlackhatEventTuiGameModeFrames) {
             app->tui_game_mode = true;
+            app->tui_state_frames =
+                event.event == BlackhatEventTuiGameModeFrames;
             blackhat_scene_tui_reset_game_input(app);
+            if(app->tui_state_frames) {
+                blackhat_scene_tui_send_frame(app);
+            }
             with_view_model(
                 app->tui_view,
                 bool * game_mode,
                 { *game_mode = true; },
                 true
             );
+            view_dispatcher_switch_to_view(
+                app->view_dispatcher, BlackhatAppViewTui
+            );
+            // The hints stay up until the first frame, or for good when
+            // the link isn't framed
+            blackhat_fb_start(app->fb);
             return true;
         }
         if(event.event == BlackhatEventTuiGameModeStopped) {
+            blackhat_fb_stop(app->fb);
             app->tui_game_mode = false;
+            app->tui_state_frames = false;
             blackhat_scene_tui_reset_game_input(app);
             with_view_model(
                 app->tui_view,
@@ -300,26 +460,58 @@ bool blackhat_scene_tui_on_event(void* context, SceneManagerEvent event)
                 { *game_mode = false; },
                 true
             );
+            view_dispatcher_switch_to_view(
+                app->view_dispatcher,
+                app->tui_mirror ? BlackhatAppViewMirror : BlackhatAppViewTui
+            );
+            return true;
+        }
+        if(event.event == BlackhatEventTuiFrame) {
+            if(app->tui_game_mode) {
+                view_dispatcher_switch_to_view(
+                    app->view_dispatcher, BlackhatAppViewFramebuffer
+                );
+            }
+            return true;
+        }
+        if(event.event == BlackhatEventTuiMirrorSync) {
+            blackhat_mirror_commit(app->mirror);
+            return true;
+        }
+        // Holds fire at their deadline rather than on the next tick
+        if(event.event == BlackhatEventTuiAHold) {
+            if(blackhat_deadline_expired(app->tui_a_hold) &&
+               app->tui_game_mode && app->tui_ok_held &&
+               !app->tui_ok_chord_used && !app->tui_a_pressed) {
+                blackhat_scene_tui_set_button(app, GameButtonA, true);
+                blackhat_scene_tui_flush(app);
+                app->tui_a_pressed = true;
+            }
+            return true;
+        }
+        if(event.event == BlackhatEventTuiBackHold) {
+            if(blackhat_deadline_expired(app->tui_back_hold) &&
+               app->tui_game_mode && app->tui_back_held &&
+               !app->tui_back_exit_sent) {
+                blackhat_scene_tui_set_button(app, GameButtonB, false);
+                blackhat_scene_tui_flush(app);
+                blackhat_scene_tui_send_byte(app, QUIT_GAME);
+                app->tui_back_exit_sent = true;
+            }
             return true;
         }
     }
 
-    if(event.type == SceneManagerEventTypeTick && app->tui_game_mode &&
-       app->tui_ok_held && !app->tui_ok_chord_used && !app->tui_a_pressed &&
-       furi_get_tick() - app->tui_ok_pressed_at >=
-           furi_ms_to_ticks(A_HOLD_DELAY_MS)) {
-        blackhat_scene_tui_send_byte(app, BUTTON_A_PRESSED);
-        app->tui_a_pressed = true;
-        return true;
+    if(event.type == SceneManagerEventTypeTick && app->tui_game_mode) {
+        blackhat_fb_update(app->fb);
     }
 
+    // Idle keepalive, repeats the last frame with the same sequence number
     if(event.type == SceneManagerEventTypeTick && app->tui_game_mode &&
-       app->tui_back_held && !app->tui_back_exit_sent &&
-       furi_get_tick() - app->tui_back_pressed_at >=
-           furi_ms_to_ticks(GAME_EXIT_HOLD_MS)) {
-        blackhat_scene_tui_send_byte(app, BUTTON_B_RELEASED);
-        blackhat_scene_tui_send_byte(app, QUIT_GAME);
-        app->tui_back_exit_sent = true;
+       app->tui_state_frames &&
+       furi_get_tick() - app->tui_frame_at >=
+           furi_ms_to_ticks(STATE_KEEPALIVE_MS)) {
+        blackhat_scene_tui_send_frame(app);
         return true;
     }
 
@@ -330,6 +522,13 @@ void blackhat_scene_tui_on_exit(void* context)
 {
     BlackhatApp* app = context;
     blackhat_uart_set_handle_rx_data_cb(app->uart, NULL);
+    blackhat_rpc_set_channel_callback(
+        app->rpc, BlackhatChannelBulk, NULL, NULL
+    );
+    blackhat_fb_stop(app->fb);
     app->tui_game_mode = false;
+    app->tui_mirror = false;
     blackhat_scene_tui_reset_game_input(app);
+    blackhat_scene_tui_log_deadline("A", app->tui_a_hold);
+    blackhat_scene_tui_log_deadline("Back", app->tui_back_hold);
 }
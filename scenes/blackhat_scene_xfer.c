@@ -0,0 +1,326 @@
+#include "../blackhat_app_i.h"
+#include <gui/canvas.h>
+#include <gui/elements.h>
+#include <toolbox/path.h>
+
+#define XFER_LINE_HEIGHT (9)
+
+typedef enum {
+    BlackhatXferSceneList,
+    BlackhatXferSceneRunning,
+} BlackhatXferSceneState;
+
+// Device files offered for pulling
+static BlackhatLineList blackhat_xfer_files;
+static uint8_t blackhat_xfer_list_id;
+
+static const char* blackhat_scene_xfer_state_text(
+    const BlackhatXferStatus* s
+)
+{
+    switch (s->state) {
+    case BlackhatXferOpening:
+        return "Opening...";
+    case BlackhatXferRunning:
+        return s->push ? "Sending, Back stops" : "Receiving, Back stops";
+    case BlackhatXferVerifying:
+        return "Checking CRC...";
+    case BlackhatXferDone:
+        return "Done";
+    case BlackhatXferFailed:
+        return s->error;
+    default:
+        return "";
+    }
+}
+
+static void blackhat_scene_xfer_draw_callback(Canvas* canvas, void* model)
+{
+    const BlackhatXferModel* m = model;
+    const BlackhatXferStatus* s = &m->status;
+    char line[40];
+    uint8_t y = XFER_LINE_HEIGHT - 1;
+
+    canvas_clear(canvas);
+    canvas_set_font(canvas, FontSecondary);
+
+    snprintf(line, sizeof(line), "%s %s", s->push ? "Push" : "Pull", m->name);
+    canvas_draw_str(canvas, 0, y, line);
+    y += 4;
+
+    uint32_t percent = s->size ? (uint64_t)s->done * 100 / s->size : 0;
+    snprintf(line, sizeof(line), "%lu%%", (unsigned long)percent);
+    elements_progress_bar_with_text(
+        canvas, 0, y, 128, s->size ? (float)s->done / s->size : 0, line
+    );
+    y += 11 + XFER_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "%lu / %lu kB",
+        (unsigned long)(s->done / 1024),
+        (unsigned long)(s->size / 1024)
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += XFER_LINE_HEIGHT;
+
+    snprintf(
+        line,
+        sizeof(line),
+        "%lu.%lu kB/s  resent %lu",
+        (unsigned long)(s->bytes_per_s / 1000),
+        (unsigned long)(s->bytes_per_s % 1000 / 100),
+        (unsigned long)s->resent
+    );
+    canvas_draw_str(canvas, 0, y, line);
+    y += XFER_LINE_HEIGHT;
+
+    if (s->offset) {
+        snprintf(
+            line,
+            sizeof(line),
+            "Resumed at %lu kB",
+            (unsigned long)(s->offset / 1024)
+        );
+        canvas_draw_str(canvas, 0, y, line);
+    }
+
+    canvas_draw_str(canvas, 0, 63, blackhat_scene_xfer_state_text(s));
+}
+
+static void blackhat_scene_xfer_update(BlackhatApp* app)
+{
+    BlackhatXferModel* model = view_get_model(app->xfer_view);
+    BlackhatXferStatus status;
+    blackhat_xfer_get_status(app->xfer, &status);
+    bool changed = memcmp(&status, &model->status, sizeof(status));
+    model->status = status;
+    view_commit_model(app->xfer_view, changed);
+}
+
+// Runs on the UART worker
+static void blackhat_scene_xfer_on_bulk_frame(
+    uint8_t type, uint8_t id, const uint8_t* data, size_t len, void* context
+)
+{
+    BlackhatApp* app = context;
+
+    if (type == BlackhatProtoBulk) blackhat_xfer_feed(app->xfer, id, data, len);
+}
+
+static void blackhat_scene_xfer_start(
+    BlackhatApp* app, bool push, const char* local, const char* name
+)
+{
+    char remote[BLACKHAT_XFER_PATH_SIZE];
+    snprintf(remote, sizeof(remote), BLACKHAT_XFER_REMOTE_DIR "/%s", name);
+
+    with_view_model(
+        app->xfer_view,
+        BlackhatXferModel * model,
+        {
+            memset(model, 0, sizeof(BlackhatXferModel));
+            strlcpy(model->name, name, sizeof(model->name));
+            model->status.push = push;
+        },
+        true
+    );
+
+    blackhat_rpc_set_channel_callback(
+        app->rpc, BlackhatChannelBulk, blackhat_scene_xfer_on_bulk_frame, app
+    );
+    blackhat_xfer_start(app->xfer, push, local, remote);
+
+    scene_manager_set_scene_state(
+        app->scene_manager, BlackhatSceneXfer, BlackhatXferSceneRunning
+    );
+    view_dispatcher_switch_to_view(app->view_dispatcher, BlackhatAppViewXfer);
+}
+
+static void blackhat_scene_xfer_failed(BlackhatApp* app, const char* error)
+{
+    with_view_model(
+        app->xfer_view,
+        BlackhatXferModel * model,
+        {
+            memset(model, 0, sizeof(BlackhatXferModel));
+            model->status.state = BlackhatXferFailed;
+            model->status.error = error;
+        },
+        true
+    );
+    view_dispatcher_switch_to_view(app->view_dispatcher, BlackhatAppViewXfer);
+}
+
+static bool blackhat_scene_xfer_push(BlackhatApp* app)
+{
+    DialogsFileBrowserOptions options;
+    dialog_file_browser_set_basic_options(&options, "*", NULL);
+    options.base_path = STORAGE_EXT_PATH_PREFIX;
+
+    FuriString* path = furi_string_alloc_set(STORAGE_EXT_PATH_PREFIX);
+    bool picked = dialog_file_browser_show(app->dialogs, path, path, &options);
+
+    if (picked) {
+        FuriString* name = furi_string_alloc();
+        path_extract_filename(path, name, false);
+        blackhat_scene_xfer_start(
+            app, true, furi_string_get_cstr(path), furi_string_get_cstr(name)
+        );
+        furi_string_free(name);
+    }
+
+    furi_string_free(path);
+    return picked;
+}
+
+// Names come from the device and must stay inside BLACKHAT_XFER_DIR
+static bool blackhat_scene_xfer_name_ok(const char* name)
+{
+    return *name && !strchr(name, '/') && !strstr(name, "..");
+}
+
+static void blackhat_scene_xfer_list_enter_callback(
+    void* context, uint32_t index
+)
+{
+    BlackhatApp* app = context;
+    const char* name = blackhat_line_list_get(&blackhat_xfer_files, index);
+    if (!name) return;
+
+    if (!blackhat_scene_xfer_name_ok(name)) {
+        blackhat_scene_xfer_failed(app, "Bad file name");
+        return;
+    }
+
+    char local[BLACKHAT_XFER_PATH_SIZE];
+    snprintf(local, sizeof(local), BLACKHAT_XFER_DIR "/%s", name);
+    blackhat_scene_xfer_start(app, false, local, name);
+}
+
+static void blackhat_scene_xfer_list_rpc_callback(
+    BlackhatRpcEvent event, const uint8_t* data, size_t len, void* context
+)
+{
+    BlackhatApp* app = context;
+
+    if (event == BlackhatRpcEventData) {
+        blackhat_line_list_feed(&blackhat_xfer_files, data, len);
+    } else {
+        view_dispatcher_send_custom_event(
+            app->view_dispatcher, BlackhatEventXferList
+        );
+    }
+}
+
+static void blackhat_scene_xfer_list_show(BlackhatApp* app)
+{
+    VariableItemList* var_item_list = app->var_item_list;
+
+    blackhat_xfer_list_id = 0;
+    blackhat_line_list_finish(&blackhat_xfer_files);
+
+    size_t count = blackhat_line_list_count(&blackhat_xfer_files);
+    if (!count) {
+        blackhat_scene_xfer_failed(app, "No files on the device");
+        return;
+    }
+
+    variable_item_list_reset(var_item_list);
+    variable_item_list_set_enter_callback(
+        var_item_list, blackhat_scene_xfer_list_enter_callback, app
+    );
+    for (size_t i = 0; i < count; i++) {
+        variable_item_list_add(
+            var_item_list,
+            blackhat_line_list_get(&blackhat_xfer_files, i),
+            1,
+            NULL,
+            app
+        );
+    }
+
+    view_dispatcher_switch_to_view(
+        app->view_dispatcher, BlackhatAppViewVarItemList
+    );
+}
+
+void blackhat_scene_xfer_on_enter(void* context)
+{
+    BlackhatApp* app = context;
+    View* view = app->xfer_view;
+
+    view_set_context(view, app);
+    view_set_draw_callback(view, blackhat_scene_xfer_draw_callback);
+
+    blackhat_line_list_init(&blackhat_xfer_files);
+    blackhat_xfer_list_id = 0;
+    scene_manager_set_scene_state(
+        app->scene_manager, BlackhatSceneXfer, BlackhatXferSceneList
+    );
+
+    // Blocks share the link with the console only when it is framed
+    if (!blackhat_rpc_is_framed(app->rpc)) {
+        blackhat_scene_xfer_failed(app, "Needs a framed link");
+        return;
+    }
+
+    if (!strcmp(app->selected_option_item_text, "push")) {
+        if (!blackhat_scene_xfer_push(app)) {
+            scene_manager_previous_scene(app->scene_manager);
+        }
+        return;
+    }
+
+    blackhat_xfer_list_id = blackhat_rpc_request(
+        app->rpc,
+        BLACKHAT_XFER_CMD " ls",
+        blackhat_scene_xfer_list_rpc_callback,
+        app
+    );
+    if (!blackhat_xfer_list_id) {
+        blackhat_scene_xfer_failed(app, "Link is busy");
+        return;
+    }
+
+    view_dispatcher_switch_to_view(
+        app->view_dispatcher, BlackhatAppViewLoading
+    );
+}
+
+bool blackhat_scene_xfer_on_event(void* context, SceneManagerEvent event)
+{
+    BlackhatApp* app = context;
+    bool consumed = false;
+
+    if (event.type == SceneManagerEventTypeCustom &&
+        event.event == BlackhatEventXferList) {
+        blackhat_scene_xfer_list_show(app);
+        consumed = true;
+    } else if (event.type == SceneManagerEventTypeTick &&
+               scene_manager_get_scene_state(
+                   app->scene_manager, BlackhatSceneXfer
+               ) == BlackhatXferSceneRunning) {
+        blackhat_scene_xfer_update(app);
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+void blackhat_scene_xfer_on_exit(void* context)
+{
+    BlackhatApp* app = context;
+
+    // A stopped transfer keeps what it has, picking it again resumes
+    blackhat_xfer_stop(app->xfer);
+    blackhat_rpc_set_channel_callback(
+        app->rpc, BlackhatChannelBulk, NULL, NULL
+    );
+    if (blackhat_xfer_list_id) {
+        blackhat_rpc_cancel(app->rpc, blackhat_xfer_list_id);
+    }
+    blackhat_line_list_free(&blackhat_xfer_files);
+    variable_item_list_reset(app->var_item_list);
+}